@@ -0,0 +1,128 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "iodevice.h"
+#include "../System/databuffer.h"
+#include "../System/task.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	class AsyncFileReader_Impl;
+
+	/// \brief A file region to read with AsyncFileReader.
+	class AsyncFileRead
+	{
+	public:
+		/// \param filename = File to read
+		/// \param offset = Byte offset of the first byte to read
+		/// \param size = Number of bytes to read, or -1 to read until the end of the file
+		AsyncFileRead(const std::string &filename = std::string(), int64_t offset = 0, int64_t size = -1)
+			: filename(filename), offset(offset), size(size)
+		{
+		}
+
+		std::string filename;
+		int64_t offset;
+		int64_t size;
+	};
+
+	/// \brief Reads files without blocking the calling thread.
+	///
+	/// On Linux the reads are queued to the kernel with io_uring when it is available, so many reads
+	/// can be outstanding without a thread blocking for each of them. Other platforms, and kernels
+	/// without io_uring, read on a pool of worker threads.
+	///
+	/// The returned tasks usually complete on an internal thread. Continue them with a TaskExecutor
+	/// to move the work elsewhere. A task completes with fewer bytes than requested if the file ended first,
+	/// and fails with an Exception if the file could not be opened or read.
+	class AsyncFileReader
+	{
+	public:
+		enum Backend
+		{
+			/// \brief Use io_uring if the kernel supports it, otherwise the thread pool
+			backend_auto,
+
+			/// \brief Linux io_uring. The constructor throws if it is not available.
+			backend_io_uring,
+
+			/// \brief Blocking reads on worker threads
+			backend_thread_pool
+		};
+
+		/// \brief Constructs a null instance.
+		AsyncFileReader();
+
+		/// \brief Constructs an async file reader.
+		///
+		/// \param backend = Backend to use
+		/// \param queue_depth = Maximum number of reads in flight at the same time
+		AsyncFileReader(Backend backend, int queue_depth = 64);
+
+		bool is_null() const { return !impl; }
+		void throw_if_null() const;
+
+		/// \brief Returns the backend in use. Never returns backend_auto.
+		Backend get_backend() const;
+
+		/// \brief Returns the maximum number of reads in flight at the same time.
+		int get_queue_depth() const;
+
+		/// \brief Returns the number of reads not completed yet.
+		int get_pending_count() const;
+
+		/// \brief Reads a region of a file.
+		Task<DataBuffer> read(const std::string &filename, int64_t offset = 0, int64_t size = -1);
+
+		/// \brief Queues many reads with a single submission.
+		///
+		/// Reads beyond the queue depth are held back and submitted as earlier reads complete.
+		/// \return One task per request, in the same order
+		std::vector<Task<DataBuffer>> read(const std::vector<AsyncFileRead> &requests);
+
+		/// \brief Reads a region of a device opened on a worker thread.
+		///
+		/// Used for files that are not stored directly on disk, such as zip archive entries.
+		/// \param open_device = Called on a worker thread to open the device
+		Task<DataBuffer> read(const std::function<IODevice()> &open_device, int64_t offset = 0, int64_t size = -1);
+
+	private:
+		std::shared_ptr<AsyncFileReader_Impl> impl;
+	};
+
+	/// \}
+}
@@ -0,0 +1,70 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "iodevice.h"
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	/// \brief I/O device buffering reads and writes of another device.
+	///
+	/// Reads fetch a whole buffer from the device at a time, and small writes are collected
+	/// until the buffer is full. This turns the many small reads of file format parsers into
+	/// a few large reads. Seeks inside the current read buffer do not touch the device.
+	///
+	/// Reads larger than the buffer go straight to the device. When the last copy of the device
+	/// is destroyed, or flush() is called, pending writes are written and the position of the
+	/// device is moved back to the position of this device.
+	class BufferedIODevice : public IODevice
+	{
+	public:
+		/// \brief Constructs a null instance.
+		BufferedIODevice();
+
+		/// \brief Constructs a buffered device.
+		///
+		/// \param device = Device to buffer
+		/// \param buffer_size = Size of the read and write buffer in bytes
+		BufferedIODevice(IODevice device, int buffer_size = 64 * 1024);
+
+		/// \brief Returns the device being buffered.
+		IODevice get_device() const;
+
+		/// \brief Returns the size of the buffer.
+		int get_buffer_size() const;
+
+		/// \brief Writes pending data and moves the device position to the position of this device.
+		void flush();
+	};
+
+	/// \}
+}
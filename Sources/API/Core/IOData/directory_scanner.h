@@ -29,6 +29,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace clan
 {
@@ -36,6 +38,20 @@ namespace clan
 	/// \{
 
 	class DirectoryScanner_Impl;
+	class WorkQueue;
+
+	/// \brief File or directory found by DirectoryScanner::scan_tree.
+	class DirectoryScanEntry
+	{
+	public:
+		DirectoryScanEntry(const std::string &pathname = std::string(), bool is_directory = false) : pathname(pathname), is_directory(is_directory) { }
+
+		/// \brief Path relative to the scanned directory, with '/' separating directories
+		std::string pathname;
+
+		/// \brief True if the entry is a directory, or a symbolic link to one
+		bool is_directory;
+	};
 
 	/// \brief Directory scanning class.
 	///
@@ -112,6 +128,19 @@ namespace clan
 		/** \return false if no more files was found.*/
 		bool next();
 
+		/// \brief Scans a directory and all its subdirectories.
+		/** <p>Subdirectories are read in parallel on the work queue, with the calling thread helping out.
+			The type of an entry is taken from the directory itself where the file system stores it,
+			so no file is opened or stat'ed for it. Symbolic links to directories are returned, but not followed.</p>
+			\param pathname Path to the directory to scan (without trailing slash)
+			\param queue Work queue to read subdirectories on
+			\return All files and directories found, in no particular order. Subdirectories that cannot be read are skipped.
+			Throws an exception if pathname cannot be read.*/
+		static std::vector<DirectoryScanEntry> scan_tree(const std::string &pathname, const WorkQueue &queue);
+
+		/// \brief Scans a directory and all its subdirectories, on a work queue created for the scan.
+		static std::vector<DirectoryScanEntry> scan_tree(const std::string &pathname);
+
 	private:
 		std::shared_ptr<DirectoryScanner_Impl> impl;
 	};
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "iodevice.h"
+#include "file_mapping.h"
 #include "../System/databuffer.h"
 
 namespace clan
@@ -36,6 +37,9 @@ namespace clan
 	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
 	/// \{
 
+	class WorkQueue;
+	template<typename T> class Task;
+
 	/// \brief File I/O device.
 	class File : public IODevice
 	{
@@ -46,6 +50,16 @@ namespace clan
 		/// \brief Loads an file into a byte buffer.
 		static DataBuffer read_bytes(const std::string &filename);
 
+		/// \brief Loads a file into a byte buffer on a worker thread.
+		///
+		/// The returned task can be continued with Task::then or awaited in a coroutine.
+		static Task<DataBuffer> read_bytes_async(const WorkQueue &queue, const std::string &filename);
+
+		/// \brief Maps a file read-only into memory.
+		///
+		/// PathHelp::normalize(filename, PathHelp::path_type_file) is called
+		static FileMapping map(const std::string &filename, FileMapping::AccessPattern pattern = FileMapping::access_sequential);
+
 		/// \brief Saves an UTF-8 text string to file.
 		static void write_text(const std::string &filename, const std::string &text, bool write_bom = false);
 
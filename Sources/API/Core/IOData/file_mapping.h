@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "iodevice.h"
+#include <memory>
+#include <string>
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	class FileMapping_Impl;
+
+	/// \brief Read-only view of a file mapped into memory.
+	///
+	/// The bytes are read directly from the operating system page cache, without copying the
+	/// file into a buffer. The mapping stays valid as long as a copy of the object, or a device
+	/// created by it, exists. Use File::map to create a mapping.
+	class FileMapping
+	{
+	public:
+		/// \brief Expected access pattern, used to tune read-ahead.
+		enum AccessPattern
+		{
+			access_normal,
+			access_sequential,
+			access_random,
+			access_will_need
+		};
+
+		/// \brief Constructs a null instance.
+		FileMapping();
+
+		/// \brief Maps a file read-only.
+		FileMapping(const std::string &filename, AccessPattern pattern = access_sequential);
+
+		bool is_null() const { return !impl; }
+		void throw_if_null() const;
+
+		/// \brief Returns the mapped bytes, or null for an empty file.
+		const char *get_data() const;
+
+		template<typename Type>
+		const Type *get_data() const { return reinterpret_cast<const Type*>(get_data()); }
+
+		/// \brief Returns the size of the file.
+		size_t get_size() const;
+
+		/// \brief Tells the operating system how a range of the file will be accessed.
+		///
+		/// \param offset = Start of the range
+		/// \param length = Length of the range, 0 for the rest of the file
+		void advise(AccessPattern pattern, size_t offset = 0, size_t length = 0) const;
+
+		/// \brief Creates a read-only I/O device reading from the mapping.
+		IODevice create_device() const;
+
+	private:
+		std::shared_ptr<FileMapping_Impl> impl;
+	};
+
+	/// \}
+}
@@ -30,7 +30,9 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "file.h"
+#include "async_file_reader.h"
 
 namespace clan
 {
@@ -101,6 +103,26 @@ namespace clan
 			unsigned int share = File::share_all,
 			unsigned int flags = 0) const;
 
+		/// \brief Reads a file, or part of it, without blocking.
+		/** Files stored on disk are read with the async file reader of this file system.
+			Files in zip archives and other providers are opened and read on its worker threads.
+			param: filename = The file to read
+			param: offset = Byte offset of the first byte to read
+			param: size = Number of bytes to read, -1 to read until the end of the file
+			\return Task completing with the data read*/
+		Task<DataBuffer> read_async(const std::string &filename, int64_t offset = 0, int64_t size = -1) const;
+
+		/// \brief Reads many files, or parts of them, with a single submission.
+		/** \return One task per request, in the same order*/
+		std::vector<Task<DataBuffer>> read_async(const std::vector<AsyncFileRead> &requests) const;
+
+		/// \brief Sets the async file reader used by read_async.
+		void set_async_reader(const AsyncFileReader &reader);
+
+		/// \brief Returns the async file reader used by read_async.
+		/** One using AsyncFileReader::backend_auto is created on first use, if none was set.*/
+		AsyncFileReader get_async_reader() const;
+
 		/// \brief Mounts a file system at mount point.
 		/** This is only available if FileSystem was set
 			Filenames starting with "mount_point" at the start will be replaced by the filesystem specified by "fs"
@@ -128,6 +150,9 @@ namespace clan
 		class NullVFS { };
 		explicit FileSystem(class NullVFS null_fs);
 
+		/// \brief Finds the file system whose provider stores a file, following mount points
+		FileSystem find_provider(const std::string &filename, std::string &out_provider_filename) const;
+
 		std::shared_ptr<FileSystem_Impl> impl;
 	};
 
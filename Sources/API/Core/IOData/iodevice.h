@@ -88,6 +88,16 @@ namespace clan
 			\return The size (-1 if position is unknown)*/
 		int get_position() const;
 
+		/// \brief Returns the size of data stream as a 64 bit value.
+		/** <p>Returns -1 if the size is unknown. Unlike get_size() this does not throw for streams larger than 2 GB.</p>
+			\return The size (-1 if size is unknown)*/
+		int64_t get_size64() const;
+
+		/// \brief Returns the position in the data stream as a 64 bit value.
+		/** <p>Returns -1 if the position is unknown.</p>
+			\return The position (-1 if position is unknown)*/
+		int64_t get_position64() const;
+
 		/// \brief Returns true if the input source is in little endian mode.
 		/** \return true if little endian*/
 		bool is_little_endian() const;
@@ -129,6 +139,13 @@ namespace clan
 		/// \return false = Failed
 		bool seek(int position, SeekMode mode = seek_set);
 
+		/// \brief Seek in data stream using a 64 bit position.
+		///
+		/// \param position Position to use (usage depends on the seek mode)
+		/// \param mode Seek mode
+		/// \return false = Failed
+		bool seek64(int64_t position, SeekMode mode = seek_set);
+
 		/// \brief Alias for receive(data, len, receive_all)
 		///
 		/// \param data Data to receive
@@ -147,6 +164,28 @@ namespace clan
 		/// \return size of data sent
 		int write(const void *data, int len, bool send_all = true);
 
+		/// \brief Receive more than 2 GB of data from device.
+		///
+		/// The data is received in 32 bit sized chunks.
+		///
+		/// \param data Data to receive
+		/// \param len Length to receive
+		/// \param receive_all true to receive all the data. false = receive part of the data, if it would block
+		///
+		/// \return size of data received
+		int64_t read64(void *data, int64_t len, bool receive_all = true);
+
+		/// \brief Send more than 2 GB of data to device.
+		///
+		/// The data is sent in 32 bit sized chunks.
+		///
+		/// \param data Data to send
+		/// \param len Length to send
+		/// \param send_all true to send all the data. false = send part of the data, if it would block
+		///
+		/// \return size of data sent
+		int64_t write64(const void *data, int64_t len, bool send_all = true);
+
 		/// \brief Changes input data endianess to the local systems mode.
 		void set_system_mode();
 
@@ -203,6 +242,25 @@ namespace clan
 		/// Warning, this is not portable.
 		void write_float(float data);
 
+		/// \brief Writes an array of unsigned 16 bit integers to output source.
+		///
+		/// The integers are byte swapped in bulk when the endian mode differs from the system.
+		/// \param data Integers to write
+		/// \param count Number of integers
+		void write_uint16_array(const uint16_t *data, int count);
+
+		/// \brief Writes an array of unsigned 32 bit integers to output source.
+		///
+		/// \param data Integers to write
+		/// \param count Number of integers
+		void write_uint32_array(const uint32_t *data, int count);
+
+		/// \brief Writes an array of floats to output source.
+		///
+		/// \param data Floats to write
+		/// \param count Number of floats
+		void write_float_array(const float *data, int count);
+
 		/// \brief  Writes a string to the output source.
 		///
 		/// \param str String to write
@@ -264,6 +322,26 @@ namespace clan
 			\return The float read.*/
 		float read_float();
 
+		/// \brief Reads an array of unsigned 16 bit integers from input source.
+		///
+		/// Reads all the data at once and byte swaps it in bulk when the endian mode differs from the system.
+		/// Throws an exception if fewer integers are available.
+		/// \param data Array receiving the integers
+		/// \param count Number of integers to read
+		void read_uint16_array(uint16_t *data, int count);
+
+		/// \brief Reads an array of unsigned 32 bit integers from input source.
+		///
+		/// \param data Array receiving the integers
+		/// \param count Number of integers to read
+		void read_uint32_array(uint32_t *data, int count);
+
+		/// \brief Reads an array of floats from input source.
+		///
+		/// \param data Array receiving the floats
+		/// \param count Number of floats to read
+		void read_float_array(float *data, int count);
+
 		/// \brief Reads a string from the input source.
 		/** <p>The binary format expected in the input source is first an uint32 telling the length of the
 			string, and then the string itself.</p>
@@ -292,6 +370,10 @@ namespace clan
 
 	protected:
 		std::shared_ptr<IODevice_Impl> impl;
+
+	private:
+		void read_array(void *data, int type_size, int count);
+		void write_array(const void *data, int type_size, int count);
 	};
 
 	/// \}
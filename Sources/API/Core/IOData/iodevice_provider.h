@@ -49,6 +49,15 @@ namespace clan
 		/** <p>Returns -1 if the position is unknown.</p>*/
 		virtual int get_position() const { return -1; }
 
+		/// \brief Returns the size of data stream as a 64 bit value.
+		/** <p>Returns -1 if the size is unknown. Providers able to address more than 2 GB
+			should override this. The default returns get_size().</p>*/
+		virtual int64_t get_size64() const { return get_size(); }
+
+		/// \brief Returns the position in the data stream as a 64 bit value.
+		/** <p>Returns -1 if the position is unknown. The default returns get_position().</p>*/
+		virtual int64_t get_position64() const { return get_position(); }
+
 		/// \brief Send data to device.
 		virtual int send(const void *data, int len, bool send_all = true) = 0;
 
@@ -63,6 +72,15 @@ namespace clan
 
 		/// \brief Seek in data stream.
 		virtual bool seek(int /*position*/, IODevice::SeekMode /*mode*/) { return false; }
+
+		/// \brief Seek in data stream using a 64 bit position.
+		/** <p>The default forwards to seek() and fails if the position does not fit 32 bits.</p>*/
+		virtual bool seek64(int64_t position, IODevice::SeekMode mode)
+		{
+			if (position != (int64_t)(int)position)
+				return false;
+			return seek((int)position, mode);
+		}
 	};
 
 	/// \}
@@ -46,6 +46,9 @@ namespace clan
 
 		/// \brief Constructs a IODevice Memory
 		///
+		/// Writes go to the data shared with the buffer passed in. An empty buffer has no data to
+		/// share yet, so give it a size or capacity first to see the writes through it.
+		///
 		/// \param data = Data Buffer
 		MemoryDevice(DataBuffer &data);
 
@@ -0,0 +1,140 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "file_system.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_I_O_Data clanCore I/O Data
+	/// \{
+
+	class IODevice;
+	class OverlayFileSystem_Impl;
+
+	/// \brief Merges several file systems into one, looking up files through a hashed path index.
+	///
+	/// Each layer is a FileSystem, such as a directory or a zip archive. When more than one layer contains
+	/// the same path, the layer with the highest priority shadows the others. Layers of equal priority
+	/// shadow the layers added before them.
+	///
+	/// The paths of all layers are merged into a single index on the first lookup after a layer has been added,
+	/// so opening a file costs one hash lookup no matter how many layers or files there are. Mount points
+	/// inside a layer are not part of the index.
+	///
+	/// Building the index lists every file in every layer. Use save_index and load_index to skip that
+	/// on later runs. A loaded index is not checked against the contents of the layers.
+	///
+	///    OverlayFileSystem overlay;
+	///    overlay.add_layer("Resources/base.zip", true);
+	///    overlay.add_layer("Resources/patch.zip", true, 1);
+	///    FileSystem vfs = overlay.get_file_system();
+	class OverlayFileSystem
+	{
+	public:
+		enum CaseMode
+		{
+			/// \brief Paths must match exactly
+			case_sensitive,
+
+			/// \brief Paths differing only in case refer to the same file
+			case_insensitive
+		};
+
+		/// \brief Constructs an overlay file system without layers.
+		///
+		/// \param case_mode = How paths are compared
+		OverlayFileSystem(CaseMode case_mode = case_sensitive);
+
+		~OverlayFileSystem();
+
+		/// \brief Returns how paths are compared.
+		CaseMode get_case_mode() const;
+
+		/// \brief Returns the number of layers.
+		int get_layer_count() const;
+
+		/// \brief Returns the number of files in the index, building it if needed.
+		int get_file_count() const;
+
+		/// \brief Returns the paths of all files in the index, building it if needed.
+		std::vector<std::string> get_file_list() const;
+
+		/// \brief Returns true if a layer contains the file.
+		bool has_file(const std::string &filename) const;
+
+		/// \brief Opens a file from the layer with the highest priority containing it.
+		/** Files not in the index are created in the layer with the highest priority,
+			if the open mode allows it.
+			param: filename = The file to open
+			param: mode = File::OpenMode modes
+			param: access = File::AccessFlags flags
+			param: share = File::ShareFlags flags
+			param: flags = File::Flags flags
+			\return The IODevice*/
+		IODevice open_file(const std::string &filename,
+			File::OpenMode mode = File::open_existing,
+			unsigned int access = File::access_read,
+			unsigned int share = File::share_all,
+			unsigned int flags = 0) const;
+
+		/// \brief Returns a FileSystem reading through this overlay.
+		FileSystem get_file_system() const;
+
+		/// \brief Adds a layer.
+		/** param: fs = File system of the layer
+			param: priority = Layers with a higher priority shadow layers with a lower one*/
+		void add_layer(const FileSystem &fs, int priority = 0);
+
+		/// \brief Adds a directory or zip file as a layer.
+		/** param: path = Path to the directory or zip file
+			param: is_zip_file = true if path is a zip file
+			param: priority = Layers with a higher priority shadow layers with a lower one*/
+		void add_layer(const std::string &path, bool is_zip_file, int priority = 0);
+
+		/// \brief Builds the index now, instead of on the first lookup.
+		void build_index();
+
+		/// \brief Writes the index, building it if needed.
+		void save_index(IODevice &device) const;
+
+		/// \brief Reads an index written by save_index.
+		/** The layers must be added in the same order, with the same paths, as when the index was saved.
+			\return false if the index does not match the layers, in which case it is built on the next lookup*/
+		bool load_index(IODevice &device);
+
+	private:
+		std::shared_ptr<OverlayFileSystem_Impl> impl;
+	};
+
+	/// \}
+}
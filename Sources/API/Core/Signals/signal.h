@@ -29,6 +29,7 @@
 #pragma once
 
 #include "bind_member.h"
+#include "signal_queue.h"
 #include <memory>
 #include <functional>
 #include <vector>
@@ -63,11 +64,80 @@ namespace clan
 		virtual ~SlotImpl() { }
 	};
 
+	/// \brief Slot list of a signal
+	///
+	/// Disconnected slots are cleared in place and compacted away later, so emitting only walks the
+	/// list and never needs to copy it. Compaction is postponed while an emit is in progress.
+	/// Nothing here is synchronized, so a signal must only be used by one thread at a time.
 	template<typename SlotImplType>
 	class SignalImpl
 	{
 	public:
-		std::vector<std::weak_ptr<SlotImplType>> slots;
+		SignalImpl() { }
+
+		class SlotEntry
+		{
+		public:
+			SlotEntry(const std::shared_ptr<SlotImplType> &slot) : slot(slot.get()), weak_slot(slot) { }
+
+			SlotImplType *slot;
+			std::weak_ptr<SlotImplType> weak_slot;
+		};
+
+		class EmitScope
+		{
+		public:
+			EmitScope(SignalImpl &signal) : signal(signal) { signal.emit_depth++; }
+			~EmitScope() { if (--signal.emit_depth == 0) signal.compact_if_needed(); }
+			EmitScope(const EmitScope &) = delete;
+			EmitScope &operator=(const EmitScope &) = delete;
+
+		private:
+			SignalImpl &signal;
+		};
+
+		void add(const std::shared_ptr<SlotImplType> &slot)
+		{
+			slot->index = slots.size();
+			slots.push_back(SlotEntry(slot));
+		}
+
+		void remove(SlotImplType *slot)
+		{
+			SlotEntry &entry = slots[slot->index];
+			entry.slot = nullptr;
+			entry.weak_slot.reset();
+			num_removed++;
+			compact_if_needed();
+		}
+
+		std::vector<SlotEntry> slots;
+
+	private:
+		void compact_if_needed()
+		{
+			if (emit_depth != 0 || num_removed * 2 < slots.size())
+				return;
+
+			size_t pos = 0;
+			for (size_t i = 0; i < slots.size(); i++)
+			{
+				if (slots[i].slot)
+				{
+					slots[i].slot->index = pos;
+					if (pos != i)
+						slots[pos] = std::move(slots[i]);
+					pos++;
+				}
+			}
+			slots.erase(slots.begin() + pos, slots.end());
+			num_removed = 0;
+		}
+
+		size_t num_removed = 0;
+
+		// Above one when a callback emits the same signal again
+		int emit_depth = 0;
 	};
 
 	template<typename FuncType>
@@ -82,22 +152,40 @@ namespace clan
 		{
 			std::shared_ptr<SignalImpl<SlotImplT>> sig = signal.lock();
 			if (sig)
-			{
-				for (auto it = sig->slots.begin(); it != sig->slots.end(); ++it)
-				{
-					// todo: investigate if "it->lock().get() == this" is required
-					if (it->expired() || it->lock().get() == this)
-					{
-						it = sig->slots.erase(it);
-						if (it == sig->slots.end())
-							break;
-					}
-				}
-			}
+				sig->remove(this);
 		}
 
 		std::weak_ptr<SignalImpl<SlotImplT>> signal;
 		std::function<FuncType> callback;
+		size_t index = 0;
+	};
+
+	template<typename FuncType>
+	class SignalQueuedCall;
+
+	/// \brief Callback posting a copy of the signal arguments to a signal queue
+	template<typename... Params>
+	class SignalQueuedCall<void(Params...)>
+	{
+	public:
+		typedef std::function<void(Params...)> TargetFunc;
+
+		static TargetFunc create(const SignalQueue &queue, const std::shared_ptr<TargetFunc> &target)
+		{
+			std::weak_ptr<TargetFunc> weak_target = target;
+			return [queue, target, weak_target](Params... params)
+			{
+				queue.post(std::bind(&SignalQueuedCall::invoke, weak_target, params...));
+			};
+		}
+
+	private:
+		static void invoke(const std::weak_ptr<TargetFunc> &weak_target, const typename std::decay<Params>::type &... params)
+		{
+			std::shared_ptr<TargetFunc> target = weak_target.lock();
+			if (target)
+				(*target)(params...);
+		}
 	};
 
 	template<typename FuncType>
@@ -109,13 +197,21 @@ namespace clan
 		template<typename... Args>
 		void operator()(Args&&... args)
 		{
-			std::vector<std::weak_ptr<SlotImplT<FuncType>>> slots = impl->slots;
-			for (std::weak_ptr<SlotImplT<FuncType>> &weak_slot : slots)
+			// Keep the slot list alive in case a callback destroys the signal
+			std::shared_ptr<SignalImpl<SlotImplT<FuncType>>> sig = impl;
+			typename SignalImpl<SlotImplT<FuncType>>::EmitScope emit_scope(*sig);
+
+			// Slots connected during the emit are not called until the next one
+			size_t count = sig->slots.size();
+			for (size_t i = 0; i < count; i++)
 			{
-				std::shared_ptr<SlotImplT<FuncType>> slot = weak_slot.lock();
-				if (slot)
+				if (sig->slots[i].slot)
 				{
-					slot->callback(std::forward<Args>(args)...);
+					std::shared_ptr<SlotImplT<FuncType>> slot = sig->slots[i].weak_slot.lock();
+					if (slot)
+					{
+						slot->callback(std::forward<Args>(args)...);
+					}
 				}
 			}
 		}
@@ -123,7 +219,7 @@ namespace clan
 		Slot connect(const std::function<FuncType> &func)
 		{
 			auto slot_impl = std::make_shared<SlotImplT<FuncType>>(impl, func);
-			impl->slots.push_back(slot_impl);
+			impl->add(slot_impl);
 			return Slot(slot_impl);
 		}
 
@@ -133,6 +229,16 @@ namespace clan
 			return connect(bind_member(instance, func));
 		}
 
+		/// \brief Connects a callback that runs on the thread processing a signal queue
+		///
+		/// The arguments are copied when the signal is emitted. Queued calls are dropped if the slot is destroyed before they run.
+		template<typename CallbackType>
+		Slot connect(const SignalQueue &queue, CallbackType func)
+		{
+			auto target = std::make_shared<std::function<FuncType>>(func);
+			return connect(SignalQueuedCall<FuncType>::create(queue, target));
+		}
+
 	private:
 		std::shared_ptr<SignalImpl<SlotImplT<FuncType>>> impl;
 	};
@@ -152,6 +258,12 @@ namespace clan
 			slots.push_back(signal.connect(func));
 		}
 
+		template<typename FuncType, typename CallbackType>
+		void connect(Signal<FuncType> &signal, const SignalQueue &queue, CallbackType func)
+		{
+			slots.push_back(signal.connect(queue, func));
+		}
+
 	private:
 		std::vector<Slot> slots;
 	};
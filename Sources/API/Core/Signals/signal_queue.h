@@ -0,0 +1,87 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "../System/task.h"
+#include <memory>
+#include <functional>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Signals clanCore Signals
+	/// \{
+
+	class SignalQueue_Impl;
+
+	/// \brief Queue that moves calls from emitting threads to a target thread
+	///
+	/// Any thread may post calls. They are stored in a lock-free list and run in the order they
+	/// were posted, in batches. If the queue has an executor, posting schedules a single batch on it
+	/// whenever the queue goes from empty to non-empty. Without an executor, the owner calls process()
+	/// from its own loop.
+	///
+	/// <code>SignalQueue main_queue(RunLoop::resume_on_main());</code>
+	/// <code>slots.connect(network_signal, main_queue, [](const NetGameEvent &e) { ... });</code>
+	class SignalQueue
+	{
+	public:
+		/// \brief Constructs a queue that is drained by calling process()
+		SignalQueue();
+
+		/// \brief Constructs a queue that is drained on the thread(s) of an executor
+		SignalQueue(const TaskExecutor &executor);
+
+		/// \brief Constructs a queue that is drained by a work queue
+		///
+		/// Only one batch runs at a time, so the calls stay in order even if the work queue has several workers.
+		SignalQueue(const WorkQueue &work_queue);
+
+		/// \brief Adds a call to the queue
+		void post(std::function<void()> func) const;
+
+		/// \brief Runs all calls posted so far
+		///
+		/// Only one thread may process the queue at a time.
+		/// \return Number of calls run
+		int process() const;
+
+		/// \brief Removes all pending calls without running them
+		void clear() const;
+
+		/// \brief Returns true if no calls are pending
+		///
+		/// Safe to call from any thread, but calls posted or processed at the same time may make the answer stale.
+		bool is_empty() const;
+
+	private:
+		std::shared_ptr<SignalQueue_Impl> impl;
+	};
+
+	/// \}
+}
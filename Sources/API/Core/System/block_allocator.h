@@ -38,6 +38,26 @@ namespace clan
 
 	class BlockAllocator_Impl;
 
+	/// \brief Memory usage statistics for a BlockAllocator
+	class BlockAllocatorStats
+	{
+	public:
+		/// \brief Total size of the blocks allocated from the heap
+		size_t bytes_reserved = 0;
+
+		/// \brief Bytes currently handed out by the allocator
+		size_t bytes_used = 0;
+
+		/// \brief Highest value bytes_used has reached since the allocator was created or last freed
+		size_t high_water = 0;
+
+		/// \brief Number of blocks currently owned by the allocator
+		int num_blocks = 0;
+
+		/// \brief Number of heap allocations the allocator has done since it was created
+		int heap_allocations = 0;
+	};
+
 	/// \brief Memory allocator that allocates in blocks.
 	///
 	/// <p>This allocator will never free any memory until free() is called or
@@ -46,24 +66,82 @@ namespace clan
 	///    otherwise the destructors of the objects will not get called. Same rules
 	///    apply to the new_obj and delete_obj template functions.</p>
 	///    <p>The allocator allocates memory from the heap in blocks. Each time the
-	///    allocated block is exhausted, the allocator will double the block size
-	///    and allocate more memory.</p>
+	///    allocated block is exhausted, the allocator will double the block size,
+	///    up to the maximum block size, and allocate more memory.</p>
+	///    <p>Small allocations given back with deallocate() are kept in free lists
+	///    per 16 byte size class and reused in O(1). Markers allow stack-style
+	///    rewinding, and reset() rewinds everything while keeping the blocks,
+	///    so per-frame scratch memory can be reused without any heap allocations.</p>
+	///    <p>A BlockAllocator is not thread safe. Use one per thread, for example
+	///    through get_thread_allocator().</p>
 	class BlockAllocator
 	{
 	public:
+		/// \brief Position in the allocator saved by get_marker()
+		class Marker
+		{
+		public:
+			int block_index = 0;
+			int block_pos = 0;
+			size_t bytes_used = 0;
+			size_t free_bytes = 0;
+		};
+
+		/// \brief Rewinds the allocator to the position it had when the scope was created
+		class ScopedMarker
+		{
+		public:
+			ScopedMarker(BlockAllocator &allocator) : allocator(allocator), marker(allocator.get_marker()) { }
+			~ScopedMarker() { allocator.rewind(marker); }
+
+		private:
+			ScopedMarker(const ScopedMarker &) = delete;
+			ScopedMarker &operator=(const ScopedMarker &) = delete;
+
+			BlockAllocator &allocator;
+			Marker marker;
+		};
+
 		/// \brief Block Allocator constructor
-		BlockAllocator();
+		///
+		/// \param max_block_size = Block sizes stop doubling when they reach this size
+		BlockAllocator(int max_block_size = 1024 * 1024);
+
+		/// \brief Returns the allocator for the calling thread
+		///
+		/// The allocator is kept in ThreadLocalStorage and requires a ThreadLocalStorage object on the thread.
+		static BlockAllocator get_thread_allocator();
 
 		/// \brief Allocate memory (See note on this class for the allocation method)
 		/**
 			param: size = Size to allocate (in bytes)
-			\return The memory*/
+			\return The memory, 16 byte aligned*/
 		void *allocate(int size);
 
+		/// \brief Gives memory back to the allocator
+		///
+		/// Allocations up to 1024 bytes are reused by later allocations of the same size class.
+		/// Larger allocations are only reclaimed if they were the last allocation, or by rewind(), reset() or free().
+		void deallocate(void *data, int size);
+
+		/// \brief Returns the current allocation position
+		Marker get_marker() const;
+
+		/// \brief Releases everything allocated after the marker was taken
+		///
+		/// Memory given back with deallocate() stays reusable if it lies before the marker position.
+		void rewind(const Marker &marker);
+
+		/// \brief Releases all allocations but keeps the blocks for reuse
+		void reset();
+
 		/// \brief Free the allocated memory
 		/** If required, use delete_obj() to call the destructor before using this function*/
 		void free();
 
+		/// \brief Returns memory usage statistics
+		BlockAllocatorStats get_stats() const;
+
 	private:
 		std::shared_ptr<BlockAllocator_Impl> impl;
 	};
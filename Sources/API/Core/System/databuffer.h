@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 
 namespace clan
 {
@@ -38,14 +39,30 @@ namespace clan
 	class DataBuffer_Impl;
 
 	/// \brief General purpose data buffer.
+	///
+	/// DataBuffer objects are references to shared data: copying a DataBuffer does not copy the bytes.
+	/// Data is 16 byte aligned. Small payloads are stored inline with the reference counted object
+	/// so they only need a single heap allocation. A moved-from buffer is empty.
+	///
+	/// A buffer that never had a size or capacity set does not allocate anything, and so has nothing
+	/// to share yet. Copies made of it before it is sized are independent of it.
 	class DataBuffer
 	{
 	public:
 		/// \brief Constructs a data buffer of 0 size.
+		///
+		/// No memory is allocated until a size or capacity is set.
 		DataBuffer();
 		DataBuffer(unsigned int size);
 		DataBuffer(const void *data, unsigned int size);
+
+		/// \brief Constructs a data buffer with a copy of part of another buffer
+		///
+		/// Use slice() to reference the bytes without copying them.
 		DataBuffer(const DataBuffer &data, unsigned int pos, unsigned int size);
+
+		DataBuffer(const DataBuffer &copy);
+		DataBuffer(DataBuffer &&move);
 		~DataBuffer();
 
 		/// \brief Returns a pointer to the data.
@@ -60,11 +77,19 @@ namespace clan
 		const Type *get_data() const { return reinterpret_cast<const Type*>(get_data()); }
 
 		/// \brief Returns the size of the data.
+		///
+		/// Throws an exception if the size does not fit. Use get_size64 for buffers larger than 4 GB.
 		unsigned int get_size() const;
 
+		/// \brief Returns the size of the data.
+		uint64_t get_size64() const;
+
 		/// \brief Returns the capacity of the data buffer object.
 		unsigned int get_capacity() const;
 
+		/// \brief Returns the capacity of the data buffer object.
+		uint64_t get_capacity64() const;
+
 		/// \brief Returns a char in the buffer.
 		char &operator[](int i);
 		const char &operator[](int i) const;
@@ -74,15 +99,33 @@ namespace clan
 		/// \brief Returns true if the buffer is 0 in size.
 		bool is_null() const;
 
+		/// \brief Returns true if the buffer is a slice referencing the data of another buffer
+		bool is_slice() const;
+
+		/// \brief Returns a buffer referencing part of this buffer's data without copying it
+		///
+		/// The slice keeps the data alive and writes through either buffer are visible in both.
+		/// Growing the slice beyond its original size detaches it into a private copy.
+		DataBuffer slice(uint64_t pos, uint64_t size) const;
+
 		DataBuffer &operator =(const DataBuffer &copy);
+		DataBuffer &operator =(DataBuffer &&move);
 
 		/// \brief Resize the buffer.
 		void set_size(unsigned int size);
 
+		/// \brief Resize the buffer.
+		void set_size64(uint64_t size);
+
 		/// \brief Preallocate enough memory.
 		void set_capacity(unsigned int capacity);
 
+		/// \brief Preallocate enough memory.
+		void set_capacity64(uint64_t capacity);
+
 	private:
+		void create_impl(uint64_t capacity);
+
 		std::shared_ptr<DataBuffer_Impl> impl;
 	};
 
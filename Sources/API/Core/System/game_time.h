@@ -38,7 +38,56 @@ namespace clan
 
 	class GameTime_Impl;
 
+	/// \brief Source of time for a GameTime
+	///
+	/// The default clock uses System::get_microseconds() and System::sleep(). A clock of its own
+	/// lets a GameTime run on simulated time, for example in tests or when replaying recorded frames.
+	class GameTimeClock
+	{
+	public:
+		virtual ~GameTimeClock() { }
+
+		/// \brief Returns the current time in microseconds
+		virtual uint64_t get_microseconds() = 0;
+
+		/// \brief Sleeps for roughly the given time. May take longer.
+		virtual void sleep(int milliseconds) = 0;
+
+		/// \brief Gives up the rest of the time slice while spin waiting for the next frame
+		virtual void yield() = 0;
+	};
+
+	/// \brief Frame time statistics over the most recent updates
+	class GameTimeFrameStats
+	{
+	public:
+		/// \brief Number of frames the statistics are based on
+		int num_frames = 0;
+
+		float average_ms = 0.0f;
+		float min_ms = 0.0f;
+		float max_ms = 0.0f;
+
+		/// \brief Median frame time
+		float p50_ms = 0.0f;
+
+		/// \brief Frame time 95 percent of the frames stayed within
+		float p95_ms = 0.0f;
+
+		/// \brief Frame time 99 percent of the frames stayed within
+		float p99_ms = 0.0f;
+	};
+
 	/// \brief Tracks time elapsed in various forms useful for games
+	///
+	/// Simulation ticks are counted with a fixed step accumulator, so the same elapsed time always
+	/// results in the same number of ticks. A typical game loop looks like this:
+	/// <code>
+	/// game_time.update();
+	/// for (int i = 0; i < game_time.get_ticks_elapsed(); i++)
+	///     simulate(game_time.get_tick_time_elapsed());
+	/// render(game_time.get_tick_interpolation_time());
+	/// </code>
 	class GameTime
 	{
 	public:
@@ -48,6 +97,11 @@ namespace clan
 		/// \param max_updates_per_second = Maximum number of updates per second (aka FPS, frames per second). 0 = Unlimited
 		GameTime(int ticks_per_second = 20, int max_updates_per_second = 0);
 
+		/// \brief Constructs a GameTime reading its time from a clock
+		///
+		/// \param clock = Clock used instead of the system time
+		GameTime(int ticks_per_second, int max_updates_per_second, const std::shared_ptr<GameTimeClock> &clock);
+
 		/// \brief Returns the time elapsed in seconds since last update.
 		float get_time_elapsed() const;
 
@@ -69,9 +123,23 @@ namespace clan
 		/// at the start of a tick its 0.0, and at the end its 1.0.
 		float get_tick_interpolation_time() const;
 
+		/// \brief Returns the number of ticks since this class was reset()
+		uint64_t get_total_ticks() const;
+
+		/// \brief Returns the maximum number of ticks a single update may report. 0 = Unlimited
+		int get_max_ticks_per_update() const;
+
 		/// \brief Returns the number of updates that occurred every second (aka fps, frames per second)
 		float get_updates_per_second() const;
 
+		/// \brief Returns the frame time in milliseconds that the given fraction of the recent updates stayed within
+		///
+		/// \param percentile = Fraction between 0.0 and 1.0, for example 0.99 for the 99th percentile
+		float get_frame_time_percentile(float percentile) const;
+
+		/// \brief Returns frame time statistics for the recent updates
+		GameTimeFrameStats get_frame_time_stats() const;
+
 		/// \brief Returns the number of seconds since this class was reset()
 		float get_current_time() const;
 
@@ -89,6 +157,18 @@ namespace clan
 		/// \brief Resets the timer.
 		void reset();
 
+		/// \brief Limits the number of ticks a single update can report
+		///
+		/// Time beyond the limit is discarded. This stops a slow frame from causing a spiral of
+		/// ever longer updates as the simulation tries to catch up. 0 = Unlimited
+		void set_max_ticks_per_update(int max_ticks);
+
+		/// \brief Sets the maximum number of updates per second (aka FPS, frames per second). 0 = Unlimited
+		///
+		/// update() sleeps until shortly before the next frame is due and spin waits the rest,
+		/// giving sub-millisecond frame pacing.
+		void set_max_updates_per_second(int max_updates_per_second);
+
 	private:
 		std::shared_ptr<GameTime_Impl> impl;
 	};
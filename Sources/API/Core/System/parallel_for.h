@@ -0,0 +1,80 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	/// \brief Returns the chunk size parallel_for uses for the range
+	///
+	/// If grain_size is zero or negative a chunk size is picked based on the number of CPU cores.
+	int parallel_grain_size(int begin, int end, int grain_size);
+
+	/// \brief Calls func for chunks of [begin, end) in parallel and waits for all of them to finish
+	///
+	/// The range is split into chunks of grain_size elements at begin + n * grain_size. The chunks are
+	/// processed by the worker threads of a shared work queue and by the calling thread itself, so nested calls
+	/// from inside func can not deadlock. Ranges no larger than one chunk, or machines with a single core,
+	/// run func(begin, end) directly on the calling thread.
+	///
+	/// If func throws, the remaining chunks are skipped and the first exception is rethrown.
+	void parallel_for(int begin, int end, int grain_size, const std::function<void(int chunk_begin, int chunk_end)> &func);
+
+	/// \brief Maps chunks of [begin, end) in parallel and combines the partial results
+	///
+	/// map is called as map(chunk_begin, chunk_end) and must return the partial result for the chunk.
+	/// The partial results are combined in range order on the calling thread with reduce(accumulated, partial),
+	/// which keeps the result deterministic even for non-associative floating point reductions.
+	template<typename T, typename MapFunc, typename ReduceFunc>
+	T parallel_reduce(int begin, int end, int grain_size, const T &identity, MapFunc map, ReduceFunc reduce)
+	{
+		if (end <= begin)
+			return identity;
+
+		grain_size = parallel_grain_size(begin, end, grain_size);
+		int num_chunks = (end - begin + grain_size - 1) / grain_size;
+		std::vector<T> partial(num_chunks, identity);
+		parallel_for(begin, end, grain_size, [&](int chunk_begin, int chunk_end)
+		{
+			partial[(chunk_begin - begin) / grain_size] = map(chunk_begin, chunk_end);
+		});
+
+		T result = identity;
+		for (const auto &value : partial)
+			result = reduce(result, value);
+		return result;
+	}
+
+	/// \}
+}
@@ -0,0 +1,105 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	class IODevice;
+
+	/// \brief Records timed zones for viewing in a trace viewer
+	///
+	/// Zones are placed with CL_PROFILE_SCOPE and are only compiled in when CL_ENABLE_PROFILING is defined.
+	/// Each thread records into its own ring buffer, overwriting its oldest zones when the buffer is full.
+	/// The recording can be exported in the Chrome trace event format, which chrome://tracing and
+	/// the Perfetto UI can open.
+	class Profiler
+	{
+	public:
+		/// \brief Starts recording, discarding any previous recording
+		///
+		/// \param zones_per_thread Size of the ring buffer of each thread
+		static void start(int zones_per_thread = 64 * 1024);
+
+		/// \brief Stops recording
+		static void stop();
+
+		/// \brief Returns true while recording
+		static bool is_active();
+
+		/// \brief Sets the name shown for the calling thread in the trace
+		static void set_thread_name(const std::string &name);
+
+		/// \brief Returns the recording in Chrome trace event format
+		///
+		/// Call stop() first, or zones recorded during the export may be missing.
+		static std::string get_chrome_trace();
+
+		/// \brief Writes the recording in Chrome trace event format
+		static void save_chrome_trace(IODevice &device);
+		static void save_chrome_trace(const std::string &filename);
+
+		/// \brief Adds a zone to the recording of the calling thread
+		///
+		/// The name must stay valid until the recording has been exported, such as a string literal.
+		static void add_zone(const char *name, uint64_t begin_microseconds, uint64_t end_microseconds);
+	};
+
+	/// \brief Records the time from construction to destruction as a profiler zone
+	class ProfileZone
+	{
+	public:
+		ProfileZone(const char *name);
+		~ProfileZone();
+
+	private:
+		ProfileZone(const ProfileZone &) = delete;
+		ProfileZone &operator=(const ProfileZone &) = delete;
+
+		const char *name;
+		uint64_t begin_microseconds;
+	};
+
+#define CL_PROFILE_CONCAT_INNER(a, b) a##b
+#define CL_PROFILE_CONCAT(a, b) CL_PROFILE_CONCAT_INNER(a, b)
+
+	/// \brief Records the rest of the enclosing scope as a profiler zone
+#ifdef CL_ENABLE_PROFILING
+#define CL_PROFILE_SCOPE(name) clan::ProfileZone CL_PROFILE_CONCAT(cl_profile_zone_, __LINE__)(name)
+#else
+#define CL_PROFILE_SCOPE(name)
+#endif
+
+	/// \}
+}
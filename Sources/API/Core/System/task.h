@@ -0,0 +1,478 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "work_queue.h"
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define CL_TASK_COROUTINES
+#endif
+#endif
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	/// \brief Decides which thread a task continuation runs on
+	///
+	/// A null executor runs the work directly on the thread that completed the previous task.
+	/// When compiled as C++20 an executor can also be awaited in a Task coroutine to switch thread:
+	/// <code>co_await resume_on_worker(queue);</code>
+	class TaskExecutor
+	{
+	public:
+		TaskExecutor() { }
+		TaskExecutor(const std::function<void(const std::function<void()> &)> &execute_func) : execute_func(execute_func) { }
+
+		/// \brief Runs work on the thread(s) of this executor
+		void execute(const std::function<void()> &work) const
+		{
+			if (execute_func)
+				execute_func(work);
+			else
+				work();
+		}
+
+#ifdef CL_TASK_COROUTINES
+		bool await_ready() const { return false; }
+		void await_suspend(std::coroutine_handle<> handle) const { execute([handle]() { handle.resume(); }); }
+		void await_resume() const { }
+#endif
+
+	private:
+		std::function<void(const std::function<void()> &)> execute_func;
+	};
+
+	/// \brief Executor that runs work on the worker threads of a work queue
+	inline TaskExecutor resume_on_worker(WorkQueue queue)
+	{
+		return TaskExecutor([queue](const std::function<void()> &work) mutable { queue.queue(work); });
+	}
+
+	/// \brief Work queued on a task until it completes
+	class TaskContinuation
+	{
+	public:
+		virtual ~TaskContinuation() { }
+		virtual void run() = 0;
+
+		TaskContinuation *next = nullptr;
+	};
+
+	template<typename Func>
+	class TaskContinuationT : public TaskContinuation
+	{
+	public:
+		TaskContinuationT(Func func) : func(std::move(func)) { }
+		void run() override { func(); }
+
+	private:
+		Func func;
+	};
+
+	class TaskBase_Impl
+	{
+	public:
+		TaskBase_Impl() { }
+		TaskBase_Impl(const TaskBase_Impl &) = delete;
+		TaskBase_Impl &operator=(const TaskBase_Impl &) = delete;
+
+		~TaskBase_Impl()
+		{
+			while (continuations)
+			{
+				TaskContinuation *next = continuations->next;
+				delete continuations;
+				continuations = next;
+			}
+		}
+
+		bool is_ready()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			return ready;
+		}
+
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			ready_event.wait(lock, [&]() { return ready; });
+		}
+
+		void set_exception(std::exception_ptr new_exception)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			exception = new_exception;
+			complete(lock);
+		}
+
+		/// \brief Runs func when the task is ready. Runs it immediately if it already is.
+		///
+		/// The continuation is a single allocation holding func itself, without a std::function around it.
+		template<typename Func>
+		void on_ready(Func func)
+		{
+			std::unique_ptr<TaskContinuation> continuation(new TaskContinuationT<Func>(std::move(func)));
+			if (!add_continuation(continuation))
+				continuation->run();
+		}
+
+		/// \brief Takes ownership of the continuation, unless the task already was ready
+		bool add_continuation(std::unique_ptr<TaskContinuation> &continuation)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (ready)
+				return false;
+
+			// Kept in reverse order, complete() restores the order they were added in
+			continuation->next = continuations;
+			continuations = continuation.release();
+			return true;
+		}
+
+		void rethrow_if_failed()
+		{
+			if (exception)
+				std::rethrow_exception(exception);
+		}
+
+		std::exception_ptr exception;
+
+	protected:
+		void complete(std::unique_lock<std::mutex> &lock)
+		{
+			ready = true;
+			TaskContinuation *node = continuations;
+			continuations = nullptr;
+			lock.unlock();
+			ready_event.notify_all();
+
+			TaskContinuation *list = nullptr;
+			while (node)
+			{
+				TaskContinuation *next = node->next;
+				node->next = list;
+				list = node;
+				node = next;
+			}
+
+			while (list)
+			{
+				std::unique_ptr<TaskContinuation> continuation(list);
+				list = list->next;
+				continuation->run();
+			}
+		}
+
+		std::mutex mutex;
+
+	private:
+		std::condition_variable ready_event;
+		bool ready = false;
+		TaskContinuation *continuations = nullptr;
+	};
+
+	template<typename T>
+	class Task_Impl : public TaskBase_Impl
+	{
+	public:
+		void set_value(T new_value)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			value.reset(new T(std::move(new_value)));
+			complete(lock);
+		}
+
+		std::unique_ptr<T> value;
+	};
+
+	template<>
+	class Task_Impl<void> : public TaskBase_Impl
+	{
+	public:
+		void set_value()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			complete(lock);
+		}
+	};
+
+	template<typename T> class Task;
+
+	/// \brief Type returned by func when TaskInvoke calls it with args
+	///
+	/// std::result_of is deprecated in C++17 and removed in C++20.
+	template<typename Func, typename... Args>
+	struct TaskResult
+	{
+		typedef decltype(std::declval<Func&>()(std::declval<Args>()...)) type;
+	};
+
+	template<typename R>
+	struct TaskInvoke
+	{
+		template<typename Func, typename... Args>
+		static void invoke(const std::shared_ptr<Task_Impl<R>> &result, Func &func, Args&&... args)
+		{
+			try
+			{
+				result->set_value(func(std::forward<Args>(args)...));
+			}
+			catch (...)
+			{
+				result->set_exception(std::current_exception());
+			}
+		}
+	};
+
+	template<>
+	struct TaskInvoke<void>
+	{
+		template<typename Func, typename... Args>
+		static void invoke(const std::shared_ptr<Task_Impl<void>> &result, Func &func, Args&&... args)
+		{
+			try
+			{
+				func(std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				result->set_exception(std::current_exception());
+				return;
+			}
+			result->set_value();
+		}
+	};
+
+#ifdef CL_TASK_COROUTINES
+	/// \brief Returns false if the task already was ready and the coroutine should continue right away
+	inline bool resume_when_ready(const std::shared_ptr<TaskBase_Impl> &impl, std::coroutine_handle<> handle)
+	{
+		auto resume = [handle]() { handle.resume(); };
+		std::unique_ptr<TaskContinuation> continuation(new TaskContinuationT<decltype(resume)>(resume));
+		return impl->add_continuation(continuation);
+	}
+
+	template<typename T>
+	class TaskPromise
+	{
+	public:
+		Task<T> get_return_object() { return Task<T>(impl); }
+		std::suspend_never initial_suspend() { return std::suspend_never(); }
+		std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+		void return_value(T value) { impl->set_value(std::move(value)); }
+		void unhandled_exception() { impl->set_exception(std::current_exception()); }
+
+	private:
+		std::shared_ptr<Task_Impl<T>> impl = std::make_shared<Task_Impl<T>>();
+	};
+
+	template<>
+	class TaskPromise<void>
+	{
+	public:
+		Task<void> get_return_object();
+		std::suspend_never initial_suspend() { return std::suspend_never(); }
+		std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+		void return_void() { impl->set_value(); }
+		void unhandled_exception() { impl->set_exception(std::current_exception()); }
+
+	private:
+		std::shared_ptr<Task_Impl<void>> impl = std::make_shared<Task_Impl<void>>();
+	};
+#endif
+
+	/// \brief Result of work that completes asynchronously
+	///
+	/// Continuations are chained with then() and run on the thread picked by their executor:
+	/// <code>
+	/// task_run(resume_on_worker(queue), [=]() { return File::read_bytes(filename); })
+	///	.then(resume_on_worker(queue), [](DataBuffer data) { return decode(data); })
+	///	.then(RunLoop::resume_on_main(), [](Image image) { upload(image); });
+	/// </code>
+	/// When compiled as C++20, Task is also a coroutine return type and can be awaited.
+	template<typename T>
+	class Task
+	{
+	public:
+		/// \brief Constructs a null task
+		Task() { }
+		Task(const std::shared_ptr<Task_Impl<T>> &impl) : impl(impl) { }
+
+		/// \brief Creates a task that is already completed with a value
+		static Task<T> from_value(T value)
+		{
+			auto impl = std::make_shared<Task_Impl<T>>();
+			impl->set_value(std::move(value));
+			return Task<T>(impl);
+		}
+
+		/// \brief Returns true if this is a null task
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns true if the task has completed, either with a value or an exception
+		bool is_ready() const { return impl->is_ready(); }
+
+		/// \brief Blocks until the task has completed
+		void wait() const { impl->wait(); }
+
+		/// \brief Waits for the task and returns its value. Rethrows the exception of a failed task.
+		///
+		/// The value is owned by the task and stays valid as long as a Task object refers to it.
+		const T &get() const
+		{
+			impl->wait();
+			impl->rethrow_if_failed();
+			return *impl->value;
+		}
+
+		/// \brief Waits for the task and moves its value out. Rethrows the exception of a failed task.
+		///
+		/// Works for move-only types. Leaves a moved-from value behind for other holders of the task.
+		T take() const
+		{
+			impl->wait();
+			impl->rethrow_if_failed();
+			return std::move(*impl->value);
+		}
+
+		/// \brief Calls func(value) on the executor when this task completes
+		///
+		/// If this task failed the exception is passed on to the returned task and func is not called.
+		template<typename Func>
+		Task<typename TaskResult<Func, T&>::type> then(const TaskExecutor &executor, Func func) const
+		{
+			typedef typename TaskResult<Func, T&>::type R;
+			auto source = impl;
+			auto result = std::make_shared<Task_Impl<R>>();
+			source->on_ready([=]()
+			{
+				if (source->exception)
+				{
+					result->set_exception(source->exception);
+					return;
+				}
+				executor.execute([=]() mutable { TaskInvoke<R>::invoke(result, func, *source->value); });
+			});
+			return Task<R>(result);
+		}
+
+#ifdef CL_TASK_COROUTINES
+		typedef TaskPromise<T> promise_type;
+
+		bool await_ready() const { return impl->is_ready(); }
+		bool await_suspend(std::coroutine_handle<> handle) const { return resume_when_ready(impl, handle); }
+		const T &await_resume() const { return get(); }
+#endif
+
+	private:
+		std::shared_ptr<Task_Impl<T>> impl;
+	};
+
+	template<>
+	class Task<void>
+	{
+	public:
+		Task() { }
+		Task(const std::shared_ptr<Task_Impl<void>> &impl) : impl(impl) { }
+
+		/// \brief Creates a task that is already completed
+		static Task<void> from_value()
+		{
+			auto impl = std::make_shared<Task_Impl<void>>();
+			impl->set_value();
+			return Task<void>(impl);
+		}
+
+		bool is_null() const { return !impl; }
+		bool is_ready() const { return impl->is_ready(); }
+		void wait() const { impl->wait(); }
+
+		void get() const
+		{
+			impl->wait();
+			impl->rethrow_if_failed();
+		}
+
+		template<typename Func>
+		Task<typename TaskResult<Func>::type> then(const TaskExecutor &executor, Func func) const
+		{
+			typedef typename TaskResult<Func>::type R;
+			auto source = impl;
+			auto result = std::make_shared<Task_Impl<R>>();
+			source->on_ready([=]()
+			{
+				if (source->exception)
+				{
+					result->set_exception(source->exception);
+					return;
+				}
+				executor.execute([=]() mutable { TaskInvoke<R>::invoke(result, func); });
+			});
+			return Task<R>(result);
+		}
+
+#ifdef CL_TASK_COROUTINES
+		typedef TaskPromise<void> promise_type;
+
+		bool await_ready() const { return impl->is_ready(); }
+		bool await_suspend(std::coroutine_handle<> handle) const { return resume_when_ready(impl, handle); }
+		void await_resume() const { get(); }
+#endif
+
+	private:
+		std::shared_ptr<Task_Impl<void>> impl;
+	};
+
+#ifdef CL_TASK_COROUTINES
+	inline Task<void> TaskPromise<void>::get_return_object() { return Task<void>(impl); }
+#endif
+
+	/// \brief Runs func on the executor and returns a task for its result
+	template<typename Func>
+	Task<typename TaskResult<Func>::type> task_run(const TaskExecutor &executor, Func func)
+	{
+		typedef typename TaskResult<Func>::type R;
+		auto result = std::make_shared<Task_Impl<R>>();
+		executor.execute([=]() mutable { TaskInvoke<R>::invoke(result, func); });
+		return Task<R>(result);
+	}
+
+	/// \}
+}
@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <vector>
+
+namespace clan
+{
+	/// \addtogroup clanCore_System clanCore System
+	/// \{
+
+	class WorkQueue;
+	class TaskGraph;
+	class TaskGraph_Impl;
+	class TaskGraphTask_Impl;
+
+	/// \brief Handle to a task in a TaskGraph
+	class TaskGraphTask
+	{
+	public:
+		/// \brief Constructs a null task
+		TaskGraphTask();
+
+		/// \brief Returns true if this is a null task
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns true if the task has finished running
+		bool is_finished() const;
+
+		/// \brief Makes this task wait for another task to finish before it runs
+		///
+		/// Can only be called before the task has been released to the work queue (before TaskGraph::run for tasks added
+		/// to an idle graph). Use TaskGraph::add with a predecessor list or then() to extend a running graph.
+		void depends_on(const TaskGraphTask &predecessor);
+
+		/// \brief Adds a continuation that runs on a worker thread when this task has finished
+		TaskGraphTask then(const std::function<void()> &func);
+
+	private:
+		TaskGraphTask(const std::shared_ptr<TaskGraphTask_Impl> &impl);
+
+		std::shared_ptr<TaskGraphTask_Impl> impl;
+		friend class TaskGraph;
+		friend class TaskGraph_Impl;
+	};
+
+	/// \brief Set of tasks with dependencies executed on a WorkQueue
+	///
+	/// A task is queued on the work queue as soon as all of its predecessors have finished. Tasks may fan out to
+	/// several successors and fan in from several predecessors. Tasks that complete on a worker thread release
+	/// their successors directly from that thread, without a round trip through the main WorkQueue thread.
+	class TaskGraph
+	{
+	public:
+		/// \brief Constructs a task graph executing on the specified work queue
+		TaskGraph(const WorkQueue &queue);
+		~TaskGraph();
+
+		/// \brief Adds a task to the graph
+		///
+		/// If the graph is already running the task is released immediately. Tasks may also be added after the graph
+		/// has finished, in which case func_finished is invoked again once they are done.
+		TaskGraphTask add(const std::function<void()> &func);
+
+		/// \brief Adds a task that runs when all the predecessors have finished
+		TaskGraphTask add(const std::function<void()> &func, const std::vector<TaskGraphTask> &predecessors);
+
+		/// \brief Starts running all tasks
+		void run();
+
+		/// \brief Returns true if the graph is running and all its tasks have finished
+		bool is_finished() const;
+
+		/// \brief Blocks until all tasks have finished
+		///
+		/// If a task threw an exception, the first exception is rethrown here. Tasks that had not started
+		/// when the exception was thrown are skipped.
+		void wait();
+
+		/// \brief Callback invoked on the main WorkQueue thread when all tasks have finished
+		///
+		/// Invoked each time the graph runs out of unfinished tasks. Requires WorkQueue::process_work_completed to be called.
+		std::function<void()> &func_finished();
+
+	private:
+		std::shared_ptr<TaskGraph_Impl> impl;
+	};
+
+	/// \}
+}
@@ -49,7 +49,57 @@ namespace clan
 		virtual void work_completed() { }
 	};
 
+	/// \brief Priority lanes for queued work
+	///
+	/// Workers always pick work from the highest non-empty lane.
+	enum class WorkPriority
+	{
+		high,
+		normal,
+		low
+	};
+
 	class WorkQueue_Impl;
+	class WorkHandle_Impl;
+
+	/// \brief Handle to a function queued on a WorkQueue
+	class WorkHandle
+	{
+	public:
+		/// \brief Constructs a null handle
+		WorkHandle();
+
+		/// \brief Returns true if this is a null handle
+		bool is_null() const { return !impl; }
+
+		/// \brief Returns true if the function has finished running
+		bool is_finished() const;
+
+		/// \brief Returns true if the work was cancelled before it started
+		bool is_cancelled() const;
+
+		/// \brief Returns the current priority of the work
+		WorkPriority get_priority() const;
+
+		/// \brief Cancels the work if it has not started running yet
+		///
+		/// \return true if the work was cancelled, false if it is already running or has finished
+		bool cancel();
+
+		/// \brief Blocks until the function has finished running or the work was cancelled
+		///
+		/// Rethrows any exception thrown by the function.
+		void wait();
+
+		/// \brief Moves the work to another priority lane if it has not started running yet
+		void set_priority(WorkPriority priority);
+
+	private:
+		WorkHandle(const std::shared_ptr<WorkHandle_Impl> &impl);
+
+		std::shared_ptr<WorkHandle_Impl> impl;
+		friend class WorkQueue;
+	};
 
 	/// \brief Thread pool for worker threads
 	class WorkQueue
@@ -57,16 +107,20 @@ namespace clan
 	public:
 		/// \brief Constructs a work queue
 		/// \param serial_queue If true, executes items in the order they are queued, one at a time
-		WorkQueue(bool serial_queue = false);
+		/// \param work_stealing If true, each worker thread gets its own queue and idle workers steal from the others.
+		///                      Reduces lock contention when many small items are queued. Ignored for serial queues.
+		WorkQueue(bool serial_queue = false, bool work_stealing = false);
 		~WorkQueue();
 
 		/// \brief Queue some work to be executed on a worker thread
 		///
 		/// Transfers ownership of the item queued. WorkQueue will delete the item.
-		void queue(WorkItem *item);
+		void queue(WorkItem *item, WorkPriority priority = WorkPriority::normal);
 
 		/// \brief Queue some work to be executed on a worker thread
-		void queue(const std::function<void()> &func);
+		///
+		/// \return Handle that can wait for, cancel or re-prioritise the work
+		WorkHandle queue(const std::function<void()> &func, WorkPriority priority = WorkPriority::normal);
 
 		/// \brief Queue some work to be executed on the main WorkQueue thread
 		void work_completed(const std::function<void()> &func);
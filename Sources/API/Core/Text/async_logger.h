@@ -0,0 +1,116 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <string>
+#include <cstdint>
+
+namespace clan
+{
+	/// \addtogroup clanCore_Text clanCore Text
+	/// \{
+
+	class AsyncLogger_Impl;
+
+	/// \brief What log_event does when the calling thread's log buffer is full
+	enum class AsyncLogOverflow
+	{
+		/// \brief Discard the event and count it as dropped
+		drop,
+
+		/// \brief Wait for the logging thread to make room
+		block
+	};
+
+	/// \brief Statistics for an asynchronous logger
+	class AsyncLoggerStats
+	{
+	public:
+		/// \brief Events passed on to the loggers
+		uint64_t events_logged = 0;
+
+		/// \brief Events discarded because a log buffer was full
+		uint64_t events_dropped = 0;
+
+		/// \brief Number of times a thread had to wait for room in its log buffer
+		uint64_t events_blocked = 0;
+
+		/// \brief Number of batches passed on to the loggers
+		uint64_t batches_written = 0;
+
+		/// \brief Number of per-thread log buffers currently allocated
+		///
+		/// The buffer of a thread is freed after the thread exits.
+		uint64_t thread_buffers = 0;
+	};
+
+	/// \brief Moves logging to a background thread
+	///
+	/// While an AsyncLogger exists, log_event only places the event in a lock-free buffer owned by the
+	/// calling thread. Formatting of log_event arguments is deferred to the logging thread, which
+	/// passes the events in batches to all enabled Logger instances. Only one AsyncLogger may exist at a time.
+	class AsyncLogger
+	{
+	public:
+		/// \brief Starts the logging thread
+		///
+		/// \param buffer_size Number of events each thread can have waiting before the overflow policy applies
+		/// \param overflow What to do when a thread's buffer is full
+		/// \param flush_interval_ms Maximum time in milliseconds an event waits before it is written
+		AsyncLogger(int buffer_size = 1024, AsyncLogOverflow overflow = AsyncLogOverflow::drop, int flush_interval_ms = 50);
+
+		/// \brief Writes all pending events and stops the logging thread
+		~AsyncLogger();
+
+		/// \brief Waits until all events logged by the calling thread have been written
+		void flush();
+
+		/// \brief Returns the logger statistics
+		AsyncLoggerStats get_stats() const;
+
+		/// \brief Returns true if an AsyncLogger is active
+		static bool is_enabled();
+
+		/// \brief Queues an event, returns false if no AsyncLogger is active
+		static bool log(const std::string &type, const std::string &text);
+
+		/// \brief Queues an event formatted by the logging thread, returns false if no AsyncLogger is active
+		static bool log_deferred(const std::string &type, std::function<std::string()> format_func);
+
+	private:
+		AsyncLogger(const AsyncLogger &) = delete;
+		AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+		std::shared_ptr<AsyncLogger_Impl> impl;
+	};
+
+	/// \}
+}
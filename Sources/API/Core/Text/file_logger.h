@@ -48,6 +48,9 @@ namespace clan
 		/// \brief Log text to file.
 		void log(const std::string &type, const std::string &text) override;
 
+		/// \brief Log several events to file with a single write.
+		void log_batch(const std::vector<LogEntry> &entries) override;
+
 	private:
 		File *file;
 	};
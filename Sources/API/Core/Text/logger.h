@@ -30,13 +30,23 @@
 
 #include "string_format.h"
 #include "string_help.h"
+#include "async_logger.h"
 #include <mutex>
+#include <vector>
 
 namespace clan
 {
 	/// \addtogroup clanCore_Text clanCore Text
 	/// \{
 
+	/// \brief Event passed to a logger.
+	class LogEntry
+	{
+	public:
+		std::string type;
+		std::string text;
+	};
+
 	/// \brief Logger interface.
 	class Logger
 	{
@@ -60,6 +70,11 @@ namespace clan
 		/// \brief Log text.
 		virtual void log(const std::string &type, const std::string &text) = 0;
 
+		/// \brief Log several events at once.
+		///
+		/// Called by AsyncLogger. The default implementation calls log for each event.
+		virtual void log_batch(const std::vector<LogEntry> &entries);
+
 	protected:
 		static StringFormat get_log_string(const std::string &type, const std::string &text);
 	};
@@ -68,46 +83,85 @@ namespace clan
 	///
 	void log_event(const std::string &type, const std::string &text);
 
+	/// \brief Type a log_event argument is stored as while its formatting is deferred
+	template <class Arg>
+	class LogEventArg
+	{
+	public:
+		typedef Arg type;
+	};
+
+	template <>
+	class LogEventArg<const char *>
+	{
+	public:
+		typedef std::string type;
+	};
+
+	template <>
+	class LogEventArg<char *>
+	{
+	public:
+		typedef std::string type;
+	};
+
+	template <class... Args>
+	std::string format_log_event(const std::string &format, const Args &... args)
+	{
+		StringFormat f(format);
+		int index = 1;
+		int expand[] = { 0, (f.set_arg(index++, args), 0)... };
+		(void)expand;
+		return f.get_result();
+	}
+
+	template <class... Args>
+	void log_event_args(const std::string &type, const std::string &format, const Args &... args)
+	{
+		if (!AsyncLogger::is_enabled() || !AsyncLogger::log_deferred(type, std::bind(&format_log_event<typename LogEventArg<Args>::type...>, format, typename LogEventArg<Args>::type(args)...)))
+			log_event(type, format_log_event(format, args...));
+	}
+
 	template <class Arg1>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); log_event(type, f.get_result());
+		log_event_args(type, format, arg1);
 	}
 
 	template <class Arg1, class Arg2>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); log_event(type, f.get_result());
+		log_event_args(type, format, arg1, arg2);
 	}
 
 	template <class Arg1, class Arg2, class Arg3>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); log_event(type, f.get_result());
+		log_event_args(type, format, arg1, arg2, arg3);
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); log_event(type, f.get_result());
+		log_event_args(type, format, arg1, arg2, arg3, arg4);
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); log_event(type, f.get_result());
+		log_event_args(type, format, arg1, arg2, arg3, arg4, arg5);
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); log_event(type, f.get_result());
+		log_event_args(type, format, arg1, arg2, arg3, arg4, arg5, arg6);
 	}
 
 	template <class Arg1, class Arg2, class Arg3, class Arg4, class Arg5, class Arg6, class Arg7>
 	void log_event(const std::string &type, const std::string &format, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7)
 	{
-		StringFormat f(format); f.set_arg(1, arg1); f.set_arg(2, arg2); f.set_arg(3, arg3); f.set_arg(4, arg4); f.set_arg(5, arg5); f.set_arg(6, arg6); f.set_arg(7, arg7); log_event(type, f.get_result());
+		log_event_args(type, format, arg1, arg2, arg3, arg4, arg5, arg6, arg7);
 	}
 
 	/// \}
@@ -75,6 +75,23 @@ namespace clan
 		/// \brief Opens a file in the archive.
 		IODevice open_file(const std::string &filename);
 
+		/// \brief Returns true if filenames differing only in case refer to the same entry.
+		bool is_case_insensitive() const;
+
+		/// \brief Sets if filenames differing only in case refer to the same entry.
+		/** <p>Entries are found through a hash index built when the archive is loaded. Changing this rebuilds it.</p>*/
+		void set_case_insensitive(bool enable);
+
+		/// \brief Returns the distance in bytes between seek checkpoints of compressed files opened with open_file.
+		int64_t get_seek_index_interval() const;
+
+		/// \brief Sets the distance in bytes between seek checkpoints of compressed files opened with open_file.
+		/** <p>While a compressed file is read, the decompressor state is saved each time another interval
+			of uncompressed data has been passed. Seeking then resumes from the closest checkpoint instead of
+			decompressing from the start of the file. Each checkpoint uses about 44 KB of memory.</p>
+			<p>A value of 0 disables the checkpoints. Only affects files opened after the call.</p>*/
+		void set_seek_index_interval(int64_t bytes);
+
 		/// \brief Get full path to source:
 		std::string get_pathname(const std::string &filename);
 
@@ -38,6 +38,7 @@ namespace clan
 	/// \{
 
 	class IODevice;
+	class WorkQueue;
 	class ZipWriter_Impl;
 
 	/// \brief Zip file writer.
@@ -50,6 +51,17 @@ namespace clan
 		/// \param storeFilenamesAsUTF8 = bool
 		ZipWriter(IODevice &output, bool storeFilenamesAsUTF8 = false);
 
+		/// \brief Constructs a ZipWriter that compresses on worker threads
+		///
+		/// File data is split into blocks of 1 MB. The blocks, of one file or of several files in a row, are
+		/// compressed and checksummed on the work queue while the calling thread continues. They are written
+		/// to the output in order. Each block is compressed on its own, so compressed files end up slightly larger.
+		///
+		/// \param output = IODevice
+		/// \param storeFilenamesAsUTF8 = bool
+		/// \param queue = Work queue to compress on
+		ZipWriter(IODevice &output, bool storeFilenamesAsUTF8, const WorkQueue &queue);
+
 		/// \brief Begins file entry in the zip file.
 		void begin_file(const std::string &filename, bool compress);
 
@@ -60,6 +72,8 @@ namespace clan
 		void end_file();
 
 		/// \brief Writes the table of contents part of the zip file.
+		///
+		/// Waits for all blocks still being compressed on the work queue.
 		void write_toc();
 
 	private:
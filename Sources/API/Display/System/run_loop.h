@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include "../../Core/System/task.h"
 #include <functional>
 #include <future>
 
@@ -52,6 +53,12 @@ namespace clan
 		/// This provides a thread-safe way to execute some code on the main thread
 		/// as part of the message processing step.
 		static void main_thread_async(std::function<void()> func);
+
+		/// \brief Returns an executor running task continuations on the main thread during message processing
+		///
+		/// <code>task.then(RunLoop::resume_on_main(), [](Image image) { ... });</code>
+		/// or in a C++20 Task coroutine: <code>co_await RunLoop::resume_on_main();</code>
+		static TaskExecutor resume_on_main();
 		
 		/// \brief Executes a task on the main thread with a future result
 		///
@@ -54,6 +54,7 @@
 #include "Core/System/cl_platform.h"
 #include "Core/System/comptr.h"
 #include "Core/Text/file_logger.h"
+#include "Core/Text/async_logger.h"
 #include "Core/Text/console.h"
 #include "Core/Text/console_logger.h"
 #include "Core/Text/logger.h"
@@ -73,9 +74,14 @@
 #include "Core/System/userdata.h"
 #include "Core/System/game_time.h"
 #include "Core/System/work_queue.h"
+#include "Core/System/task_graph.h"
+#include "Core/System/parallel_for.h"
+#include "Core/System/task.h"
+#include "Core/System/profiler.h"
 #include "Core/ErrorReporting/crash_reporter.h"
 #include "Core/ErrorReporting/exception_dialog.h"
 #include "Core/Signals/signal.h"
+#include "Core/Signals/signal_queue.h"
 #include "Core/Resources/resource.h"
 #include "Core/Resources/resource_container.h"
 #include "Core/Resources/resource_object.h"
@@ -93,7 +99,11 @@
 #include "Core/IOData/directory_scanner.h"
 #include "Core/IOData/file_system.h"
 #include "Core/IOData/file_system_provider.h"
+#include "Core/IOData/overlay_file_system.h"
 #include "Core/IOData/directory_listing.h"
+#include "Core/IOData/async_file_reader.h"
+#include "Core/IOData/buffered_iodevice.h"
+#include "Core/IOData/file_mapping.h"
 #include "Core/IOData/memory_device.h"
 #include "Core/IOData/html_url.h"
 #include "Core/Zip/zip_archive.h"
@@ -0,0 +1,468 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+#include "async_file_reader_io_uring.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Text/string_format.h"
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		int io_uring_setup(unsigned entries, io_uring_params *params)
+		{
+			return (int)syscall(__NR_io_uring_setup, entries, params);
+		}
+
+		int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+		{
+			return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0);
+		}
+
+		int io_uring_register(int ring_fd, unsigned opcode, void *arg, unsigned nr_args)
+		{
+			return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+		}
+
+		// user_data of the no-op submitted to wake up the completion thread
+		const uint64_t wakeup_user_data = 0;
+
+		// Completions report the bytes read as an int
+		const int64_t max_read_size = 1 << 30;
+	}
+
+	std::unique_ptr<AsyncFileReader_IOUring> AsyncFileReader_IOUring::create(AsyncFileReader_Impl *reader, int queue_depth)
+	{
+		std::unique_ptr<AsyncFileReader_IOUring> io_uring(new AsyncFileReader_IOUring(reader, queue_depth));
+		if (!io_uring->init())
+			return nullptr;
+		io_uring->completion_thread = std::thread(&AsyncFileReader_IOUring::completion_main, io_uring.get());
+		return io_uring;
+	}
+
+	AsyncFileReader_IOUring::AsyncFileReader_IOUring(AsyncFileReader_Impl *reader, int queue_depth)
+		: reader(reader), queue_depth(queue_depth)
+	{
+	}
+
+	AsyncFileReader_IOUring::~AsyncFileReader_IOUring()
+	{
+		if (completion_thread.joinable())
+		{
+			// The completion thread exits when the no-op completes and all reads are done.
+			// If the ring failed it exits as soon as nothing is left in the kernel.
+			std::unique_lock<std::mutex> lock(mutex);
+			stop_flag = true;
+			if (!ring_failed)
+			{
+				io_uring_sqe *sqe = get_sqe();
+				sqe->opcode = IORING_OP_NOP;
+				sqe->user_data = wakeup_user_data;
+				queued_operations.push_back(nullptr);
+				enter_sqes(lock);
+			}
+			submitted_event.notify_all();
+			fail_rejected(lock);
+			lock.unlock();
+			completion_thread.join();
+		}
+
+		if (sqes)
+			munmap(sqes, sqes_size);
+		if (cq_ring && cq_ring != sq_ring)
+			munmap(cq_ring, cq_ring_size);
+		if (sq_ring)
+			munmap(sq_ring, sq_ring_size);
+		if (ring_fd != -1)
+			::close(ring_fd);
+	}
+
+	bool AsyncFileReader_IOUring::init()
+	{
+		// One extra entry for the wakeup no-op
+		io_uring_params params;
+		memset(&params, 0, sizeof(io_uring_params));
+		ring_fd = io_uring_setup(queue_depth + 1, &params);
+		if (ring_fd < 0)
+		{
+			ring_fd = -1;
+			return false;
+		}
+
+		// IORING_OP_READ needs Linux 5.6. Older kernels use the thread pool instead.
+		std::vector<char> probe_data(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+		io_uring_probe *probe = reinterpret_cast<io_uring_probe*>(probe_data.data());
+		if (io_uring_register(ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0)
+			return false;
+		if (probe->last_op < IORING_OP_READ || !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
+			return false;
+
+		sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (single_mmap)
+			sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+		void *ptr = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+		if (ptr == MAP_FAILED)
+			return false;
+		sq_ring = ptr;
+
+		if (single_mmap)
+		{
+			cq_ring = sq_ring;
+		}
+		else
+		{
+			ptr = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+			if (ptr == MAP_FAILED)
+				return false;
+			cq_ring = ptr;
+		}
+
+		sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+		if (ptr == MAP_FAILED)
+			return false;
+		sqes = static_cast<io_uring_sqe*>(ptr);
+
+		char *sq = static_cast<char*>(sq_ring);
+		sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+		char *cq = static_cast<char*>(cq_ring);
+		cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+		return true;
+	}
+
+	void AsyncFileReader_IOUring::submit(std::vector<std::unique_ptr<AsyncFileReadOperation>> &operations)
+	{
+		std::vector<AsyncFileReadOperation*> opened;
+		opened.reserve(operations.size());
+		for (auto &operation : operations)
+		{
+			AsyncFileReadOperation *op = operation.release();
+			if (open(op))
+				opened.push_back(op);
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		backlog.insert(backlog.end(), opened.begin(), opened.end());
+		queue_sqes(lock);
+		fail_rejected(lock);
+	}
+
+	bool AsyncFileReader_IOUring::open(AsyncFileReadOperation *operation)
+	{
+		const AsyncFileRead &request = operation->request;
+		if (request.offset < 0)
+		{
+			fail(operation, string_format("AsyncFileReader: Invalid offset for '%1'", request.filename));
+			return false;
+		}
+
+		operation->handle = ::open(request.filename.c_str(), O_RDONLY | O_CLOEXEC);
+		if (operation->handle == -1)
+		{
+			fail(operation, string_format("AsyncFileReader: Unable to open file '%1'", request.filename));
+			return false;
+		}
+
+		int64_t size = request.size;
+		if (size < 0)
+		{
+			struct stat file_stat;
+			if (fstat(operation->handle, &file_stat) == -1)
+			{
+				fail(operation, string_format("AsyncFileReader: Unable to get size of '%1'", request.filename));
+				return false;
+			}
+			size = std::max((int64_t)file_stat.st_size - request.offset, (int64_t)0);
+		}
+
+		try
+		{
+			operation->buffer.set_size64(size);
+		}
+		catch (...)
+		{
+			::close(operation->handle);
+			reader->fail(std::unique_ptr<AsyncFileReadOperation>(operation), std::current_exception());
+			return false;
+		}
+
+		if (size == 0)
+		{
+			complete(operation);
+			return false;
+		}
+		return true;
+	}
+
+	void AsyncFileReader_IOUring::completion_main()
+	{
+		std::vector<std::pair<AsyncFileReadOperation*, int>> completions;
+		bool stopping = false;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			if (stopping && submitted == 0 && backlog.empty())
+				break;
+
+			// Only wait in the kernel while it has something to complete
+			submitted_event.wait(lock, [&]() { return submitted > 0 || (stop_flag && ring_failed); });
+			if (submitted == 0)
+				break;
+			lock.unlock();
+
+			int result = io_uring_enter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+			if (result < 0 && errno != EINTR)
+			{
+				// No more completions can be reaped. Fail everything still pending.
+				int error = errno;
+				lock.lock();
+				set_failed(string_format("AsyncFileReader: io_uring_enter failed: %1", strerror(error)));
+				for (AsyncFileReadOperation *operation : submitted_operations)
+				{
+					orphaned_buffers.push_back(operation->buffer);
+					rejected.push_back(operation);
+				}
+				submitted_operations.clear();
+				submitted = 0;
+				fail_rejected(lock);
+				break;
+			}
+
+			unsigned first_head = *cq_head;
+			unsigned head = first_head;
+			unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+			while (head != tail)
+			{
+				const io_uring_cqe &cqe = cqes[head & *cq_mask];
+				if (cqe.user_data == wakeup_user_data)
+					stopping = true;
+				else
+					completions.push_back(std::make_pair(reinterpret_cast<AsyncFileReadOperation*>(cqe.user_data), cqe.res));
+				head++;
+			}
+			__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+			lock.lock();
+			submitted -= (int)(head - first_head);
+			for (auto &completion : completions)
+				submitted_operations.erase(completion.first);
+			lock.unlock();
+
+			for (auto &completion : completions)
+				read_completed(completion.first, completion.second);
+			completions.clear();
+
+			lock.lock();
+			queue_sqes(lock);
+			fail_rejected(lock);
+		}
+	}
+
+	void AsyncFileReader_IOUring::read_completed(AsyncFileReadOperation *operation, int result)
+	{
+		if (result == -EINTR || result == -EAGAIN)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			backlog.push_front(operation);
+		}
+		else if (result < 0)
+		{
+			fail(operation, string_format("AsyncFileReader: Unable to read file '%1': %2", operation->request.filename, strerror(-result)));
+		}
+		else
+		{
+			operation->bytes_read += result;
+			if (result == 0 || operation->bytes_read == (int64_t)operation->buffer.get_size64())
+			{
+				complete(operation);
+			}
+			else
+			{
+				// Short read, queue the rest
+				std::unique_lock<std::mutex> lock(mutex);
+				backlog.push_front(operation);
+			}
+		}
+	}
+
+	void AsyncFileReader_IOUring::queue_sqes(std::unique_lock<std::mutex> &lock)
+	{
+		if (ring_failed)
+		{
+			rejected.insert(rejected.end(), backlog.begin(), backlog.end());
+			backlog.clear();
+			return;
+		}
+
+		while (submitted_operations.size() + queued_operations.size() < (size_t)queue_depth && !backlog.empty())
+		{
+			AsyncFileReadOperation *operation = backlog.front();
+			backlog.pop_front();
+
+			int64_t remaining = (int64_t)operation->buffer.get_size64() - operation->bytes_read;
+			io_uring_sqe *sqe = get_sqe();
+			sqe->opcode = IORING_OP_READ;
+			sqe->fd = operation->handle;
+			sqe->addr = (uint64_t)(uintptr_t)(operation->buffer.get_data() + operation->bytes_read);
+			sqe->len = (unsigned)std::min(remaining, max_read_size);
+			sqe->off = (uint64_t)(operation->request.offset + operation->bytes_read);
+			sqe->user_data = (uint64_t)(uintptr_t)operation;
+			queued_operations.push_back(operation);
+		}
+		enter_sqes(lock);
+	}
+
+	io_uring_sqe *AsyncFileReader_IOUring::get_sqe()
+	{
+		unsigned index = (*sq_tail + sqes_queued) & *sq_mask;
+		sq_array[index] = index;
+		sqes_queued++;
+		memset(&sqes[index], 0, sizeof(io_uring_sqe));
+		return &sqes[index];
+	}
+
+	void AsyncFileReader_IOUring::enter_sqes(std::unique_lock<std::mutex> &lock)
+	{
+		if (sqes_queued == 0)
+			return;
+
+		// Publish the new entries before the kernel is told about them
+		__atomic_store_n(sq_tail, *sq_tail + sqes_queued, __ATOMIC_RELEASE);
+
+		// Called from the destructor and the completion thread, so errors are not thrown
+		unsigned consumed = 0;
+		while (consumed < sqes_queued)
+		{
+			int result = io_uring_enter(ring_fd, sqes_queued - consumed, 0, 0);
+			if (result >= 0)
+			{
+				consumed += result;
+			}
+			else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			{
+				set_failed(string_format("AsyncFileReader: io_uring_enter failed: %1", strerror(errno)));
+				break;
+			}
+		}
+
+		// The kernel consumes the entries in queue order
+		for (size_t i = 0; i < queued_operations.size(); i++)
+		{
+			AsyncFileReadOperation *operation = queued_operations[i];
+			if (i < consumed)
+			{
+				submitted++;
+				if (operation)
+					submitted_operations.insert(operation);
+			}
+			else if (operation)
+			{
+				rejected.push_back(operation);
+			}
+		}
+		queued_operations.clear();
+		sqes_queued = 0;
+
+		if (consumed > 0)
+			submitted_event.notify_all();
+	}
+
+	void AsyncFileReader_IOUring::set_failed(const std::string &message)
+	{
+		if (!ring_failed)
+		{
+			ring_failed = true;
+			ring_error = message;
+		}
+		rejected.insert(rejected.end(), backlog.begin(), backlog.end());
+		backlog.clear();
+		submitted_event.notify_all();
+	}
+
+	void AsyncFileReader_IOUring::fail_rejected(std::unique_lock<std::mutex> &lock)
+	{
+		if (rejected.empty())
+			return;
+
+		std::vector<AsyncFileReadOperation*> operations;
+		operations.swap(rejected);
+		std::string message = ring_error;
+
+		lock.unlock();
+		for (AsyncFileReadOperation *operation : operations)
+			fail(operation, message);
+		lock.lock();
+	}
+
+	void AsyncFileReader_IOUring::complete(AsyncFileReadOperation *operation)
+	{
+		::close(operation->handle);
+		reader->complete(std::unique_ptr<AsyncFileReadOperation>(operation));
+	}
+
+	void AsyncFileReader_IOUring::fail(AsyncFileReadOperation *operation, const std::string &message)
+	{
+		if (operation->handle != -1)
+			::close(operation->handle);
+		reader->fail(std::unique_ptr<AsyncFileReadOperation>(operation), std::make_exception_ptr(Exception(message)));
+	}
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+#include "../async_file_reader_impl.h"
+#include <linux/io_uring.h>
+#include <unordered_set>
+
+namespace clan
+{
+	/// \brief Reads files with the Linux io_uring interface
+	///
+	/// Talks to the kernel with raw system calls, so liburing is not needed.
+	/// Files are opened on the submitting thread. The reads are queued to the
+	/// submission ring and a single thread waits for their completions.
+	class AsyncFileReader_IOUring
+	{
+	public:
+		~AsyncFileReader_IOUring();
+
+		/// \brief Returns null if the kernel does not support io_uring, or it is blocked
+		static std::unique_ptr<AsyncFileReader_IOUring> create(AsyncFileReader_Impl *reader, int queue_depth);
+
+		void submit(std::vector<std::unique_ptr<AsyncFileReadOperation>> &operations);
+
+	private:
+		AsyncFileReader_IOUring(AsyncFileReader_Impl *reader, int queue_depth);
+		bool init();
+		void completion_main();
+
+		bool open(AsyncFileReadOperation *operation);
+		void read_completed(AsyncFileReadOperation *operation, int result);
+		void queue_sqes(std::unique_lock<std::mutex> &lock);
+		void enter_sqes(std::unique_lock<std::mutex> &lock);
+		void set_failed(const std::string &message);
+		void fail_rejected(std::unique_lock<std::mutex> &lock);
+		io_uring_sqe *get_sqe();
+		void complete(AsyncFileReadOperation *operation);
+		void fail(AsyncFileReadOperation *operation, const std::string &message);
+
+		AsyncFileReader_Impl *reader;
+		int queue_depth;
+
+		int ring_fd = -1;
+		void *sq_ring = nullptr;
+		void *cq_ring = nullptr;
+		size_t sq_ring_size = 0;
+		size_t cq_ring_size = 0;
+		io_uring_sqe *sqes = nullptr;
+		size_t sqes_size = 0;
+
+		unsigned *sq_tail = nullptr;
+		unsigned *sq_mask = nullptr;
+		unsigned *sq_array = nullptr;
+		unsigned *cq_head = nullptr;
+		unsigned *cq_tail = nullptr;
+		unsigned *cq_mask = nullptr;
+		io_uring_cqe *cqes = nullptr;
+
+		std::mutex mutex;
+		std::condition_variable submitted_event;
+		std::deque<AsyncFileReadOperation*> backlog;
+
+		// Operations of the queued entries in queue order. Null for the wakeup no-op.
+		std::vector<AsyncFileReadOperation*> queued_operations;
+		unsigned sqes_queued = 0;
+
+		// Operations and no-ops the kernel has consumed, but not completed yet
+		std::unordered_set<AsyncFileReadOperation*> submitted_operations;
+		int submitted = 0;
+
+		// Once io_uring_enter fails nothing more is submitted and all pending operations fail
+		bool ring_failed = false;
+		std::string ring_error;
+		std::vector<AsyncFileReadOperation*> rejected;
+
+		// The kernel may still write into the buffers of reads abandoned while in flight
+		std::vector<DataBuffer> orphaned_buffers;
+
+		bool stop_flag = false;
+		std::thread completion_thread;
+	};
+}
+
+#endif
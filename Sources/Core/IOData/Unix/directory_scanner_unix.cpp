@@ -33,6 +33,10 @@
 #endif
 #include <fnmatch.h>
 #include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #include "directory_scanner_unix.h"
 
 #include <string.h>
@@ -155,4 +159,86 @@ bool DirectoryScanner_Unix::next()
 	}
 }
 
+namespace
+{
+	void add_scan_entry(int dir_fd, const char *name, unsigned char type, const std::string &relative_path, std::vector<DirectoryScanEntry> &out_entries, std::vector<std::string> &out_subdirectories)
+	{
+		if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+			return;
+
+		// Only stat when the file system does not store the type in the directory
+		struct stat statbuf;
+		if (type == DT_UNKNOWN)
+		{
+			if (fstatat(dir_fd, name, &statbuf, AT_SYMLINK_NOFOLLOW) == -1)
+				type = DT_REG;
+			else if (S_ISDIR(statbuf.st_mode))
+				type = DT_DIR;
+			else if (S_ISLNK(statbuf.st_mode))
+				type = DT_LNK;
+			else
+				type = DT_REG;
+		}
+
+		// Symbolic links are reported as what they point to, like DirectoryScanner does, but not followed
+		bool is_directory = (type == DT_DIR);
+		if (type == DT_LNK)
+			is_directory = fstatat(dir_fd, name, &statbuf, 0) == 0 && S_ISDIR(statbuf.st_mode);
+
+		std::string pathname = relative_path.empty() ? std::string(name) : relative_path + "/" + name;
+		if (type == DT_DIR)
+			out_subdirectories.push_back(pathname);
+		out_entries.push_back(DirectoryScanEntry(pathname, is_directory));
+	}
+
+#ifdef __linux__
+	struct LinuxDirent64
+	{
+		uint64_t d_ino;
+		int64_t d_off;
+		unsigned short d_reclen;
+		unsigned char d_type;
+		char d_name[1];
+	};
+#endif
+}
+
+bool DirectoryScanner_Unix::read_directory(const std::string &path, const std::string &relative_path, std::vector<DirectoryScanEntry> &out_entries, std::vector<std::string> &out_subdirectories)
+{
+	int fd = open(path.empty() ? "." : path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd == -1)
+		return false;
+
+#ifdef __linux__
+	// Fetch many entries per system call, instead of the small batches readdir uses
+	std::vector<uint64_t> buffer(64 * 1024 / sizeof(uint64_t));
+	while (true)
+	{
+		long size = syscall(SYS_getdents64, fd, buffer.data(), buffer.size() * sizeof(uint64_t));
+		if (size <= 0)
+			break;
+
+		const char *data = reinterpret_cast<const char*>(buffer.data());
+		for (long pos = 0; pos < size;)
+		{
+			const LinuxDirent64 *entry = reinterpret_cast<const LinuxDirent64*>(data + pos);
+			add_scan_entry(fd, entry->d_name, entry->d_type, relative_path, out_entries, out_subdirectories);
+			pos += entry->d_reclen;
+		}
+	}
+	close(fd);
+#else
+	DIR *dir = fdopendir(fd);
+	if (dir == nullptr)
+	{
+		close(fd);
+		return false;
+	}
+	while (dirent *entry = readdir(dir))
+		add_scan_entry(fd, entry->d_name, entry->d_type, relative_path, out_entries, out_subdirectories);
+	closedir(dir);
+#endif
+	return true;
+}
+
 }
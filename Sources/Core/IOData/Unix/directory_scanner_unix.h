@@ -84,6 +84,9 @@ public:
 	/// \brief Find next file in directory scan. Returns false if no more files was found.
 	bool next() override;
 
+	/// \brief Reads all entries of a directory for DirectoryScanner::scan_tree. Returns false if it could not be opened.
+	static bool read_directory(const std::string &path, const std::string &relative_path, std::vector<DirectoryScanEntry> &out_entries, std::vector<std::string> &out_subdirectories);
+
 /// \name Implementation
 /// \{
 
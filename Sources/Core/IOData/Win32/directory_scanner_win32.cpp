@@ -29,6 +29,7 @@
 #include "Core/precomp.h"
 #include "directory_scanner_win32.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/IOData/path_help.h"
 
 namespace clan
 {
@@ -159,4 +160,32 @@ namespace clan
 		if (path[len - 1] == '/' || path[len - 1] == '\\') return path;
 		return path + "\\";
 	}
+
+	bool DirectoryScanner_Win32::read_directory(const std::string &path, const std::string &relative_path, std::vector<DirectoryScanEntry> &out_entries, std::vector<std::string> &out_subdirectories)
+	{
+		// The attributes come with each entry, and the basic info level skips the short 8.3 names
+		WIN32_FIND_DATAW fileinfo;
+		std::wstring filename = StringHelp::utf8_to_ucs2(PathHelp::add_trailing_slash(path.empty() ? "." : path, PathHelp::path_type_file) + "*");
+		HANDLE handle = FindFirstFileExW(filename.c_str(), FindExInfoBasic, &fileinfo, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+		if (handle == INVALID_HANDLE_VALUE)
+			return false;
+
+		do
+		{
+			if (wcscmp(fileinfo.cFileName, L".") == 0 || wcscmp(fileinfo.cFileName, L"..") == 0)
+				continue;
+
+			std::string name = StringHelp::ucs2_to_utf8(fileinfo.cFileName);
+			std::string pathname = relative_path.empty() ? name : relative_path + "/" + name;
+			bool is_directory = (fileinfo.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+
+			// Junctions and directory symlinks are returned, but not followed
+			if (is_directory && (fileinfo.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0)
+				out_subdirectories.push_back(pathname);
+			out_entries.push_back(DirectoryScanEntry(pathname, is_directory));
+		} while (FindNextFileW(handle, &fileinfo));
+
+		FindClose(handle);
+		return true;
+	}
 }
@@ -73,6 +73,9 @@ namespace clan
 		/// \brief Find next file in directory scan. Returns false if no more files was found.
 		virtual bool next();
 
+		/// \brief Reads all entries of a directory for DirectoryScanner::scan_tree. Returns false if it could not be opened.
+		static bool read_directory(const std::string &path, const std::string &relative_path, std::vector<DirectoryScanEntry> &out_entries, std::vector<std::string> &out_subdirectories);
+
 	private:
 		std::string path_with_ending_slash(const std::string &path);
 
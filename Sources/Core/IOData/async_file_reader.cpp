@@ -0,0 +1,268 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/async_file_reader.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Text/string_format.h"
+#include "async_file_reader_impl.h"
+#ifdef HAVE_LINUX_IO_URING_H
+#include "Unix/async_file_reader_io_uring.h"
+#endif
+#include <algorithm>
+
+#ifndef HAVE_LINUX_IO_URING_H
+namespace clan
+{
+	// io_uring is only available on Linux, this is never instantiated elsewhere
+	class AsyncFileReader_IOUring
+	{
+	public:
+		void submit(std::vector<std::unique_ptr<AsyncFileReadOperation>> &operations) { }
+	};
+}
+#endif
+
+namespace clan
+{
+	AsyncFileReader::AsyncFileReader()
+	{
+	}
+
+	AsyncFileReader::AsyncFileReader(Backend backend, int queue_depth)
+		: impl(std::make_shared<AsyncFileReader_Impl>(backend, queue_depth))
+	{
+	}
+
+	void AsyncFileReader::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("AsyncFileReader is null");
+	}
+
+	AsyncFileReader::Backend AsyncFileReader::get_backend() const
+	{
+		throw_if_null();
+		return impl->backend;
+	}
+
+	int AsyncFileReader::get_queue_depth() const
+	{
+		throw_if_null();
+		return impl->queue_depth;
+	}
+
+	int AsyncFileReader::get_pending_count() const
+	{
+		throw_if_null();
+		return impl->pending.load();
+	}
+
+	Task<DataBuffer> AsyncFileReader::read(const std::string &filename, int64_t offset, int64_t size)
+	{
+		return read(std::vector<AsyncFileRead>(1, AsyncFileRead(filename, offset, size))).front();
+	}
+
+	std::vector<Task<DataBuffer>> AsyncFileReader::read(const std::vector<AsyncFileRead> &requests)
+	{
+		throw_if_null();
+
+		std::vector<Task<DataBuffer>> tasks;
+		std::vector<std::unique_ptr<AsyncFileReadOperation>> operations;
+		tasks.reserve(requests.size());
+		operations.reserve(requests.size());
+		for (const auto &request : requests)
+		{
+			std::unique_ptr<AsyncFileReadOperation> operation(new AsyncFileReadOperation());
+			operation->request = request;
+			tasks.push_back(Task<DataBuffer>(operation->task));
+			operations.push_back(std::move(operation));
+		}
+		impl->submit(operations);
+		return tasks;
+	}
+
+	Task<DataBuffer> AsyncFileReader::read(const std::function<IODevice()> &open_device, int64_t offset, int64_t size)
+	{
+		throw_if_null();
+
+		std::vector<std::unique_ptr<AsyncFileReadOperation>> operations;
+		operations.push_back(std::unique_ptr<AsyncFileReadOperation>(new AsyncFileReadOperation()));
+		operations.back()->request = AsyncFileRead(std::string(), offset, size);
+		operations.back()->open_device = open_device;
+		Task<DataBuffer> task(operations.back()->task);
+		impl->submit(operations);
+		return task;
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	AsyncFileReader_Impl::AsyncFileReader_Impl(AsyncFileReader::Backend backend, int queue_depth)
+		: backend(AsyncFileReader::backend_thread_pool), queue_depth(std::max(queue_depth, 1)), pending(0)
+	{
+		if (backend != AsyncFileReader::backend_thread_pool)
+		{
+#ifdef HAVE_LINUX_IO_URING_H
+			io_uring = AsyncFileReader_IOUring::create(this, this->queue_depth);
+#endif
+			if (io_uring)
+				this->backend = AsyncFileReader::backend_io_uring;
+			else if (backend == AsyncFileReader::backend_io_uring)
+				throw Exception("AsyncFileReader: io_uring is not available");
+		}
+	}
+
+	AsyncFileReader_Impl::~AsyncFileReader_Impl()
+	{
+		// Both backends finish the reads already queued before they shut down
+		io_uring.reset();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		lock.unlock();
+		worker_event.notify_all();
+		for (auto &thread : workers)
+			thread.join();
+	}
+
+	void AsyncFileReader_Impl::submit(std::vector<std::unique_ptr<AsyncFileReadOperation>> &operations)
+	{
+		pending += (int)operations.size();
+
+		if (io_uring)
+		{
+			std::vector<std::unique_ptr<AsyncFileReadOperation>> device_operations;
+			for (auto &operation : operations)
+			{
+				if (operation->open_device)
+					device_operations.push_back(std::move(operation));
+			}
+			operations.erase(std::remove(operations.begin(), operations.end(), nullptr), operations.end());
+
+			io_uring->submit(operations);
+			queue_on_workers(device_operations);
+		}
+		else
+		{
+			queue_on_workers(operations);
+		}
+	}
+
+	void AsyncFileReader_Impl::complete(std::unique_ptr<AsyncFileReadOperation> operation)
+	{
+		operation->buffer.set_size64(operation->bytes_read);
+		pending--;
+		operation->task->set_value(std::move(operation->buffer));
+	}
+
+	void AsyncFileReader_Impl::fail(std::unique_ptr<AsyncFileReadOperation> operation, std::exception_ptr exception)
+	{
+		pending--;
+		operation->task->set_exception(exception);
+	}
+
+	void AsyncFileReader_Impl::queue_on_workers(std::vector<std::unique_ptr<AsyncFileReadOperation>> &operations)
+	{
+		if (operations.empty())
+			return;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		for (auto &operation : operations)
+			work.push_back(std::move(operation));
+
+		// Blocking reads need a thread each, so the pool is only started when first needed
+		const int max_workers = 8;
+		if (workers.empty())
+		{
+			int num_workers = std::min(queue_depth, max_workers);
+			for (int i = 0; i < num_workers; i++)
+				workers.push_back(std::thread(&AsyncFileReader_Impl::worker_main, this));
+		}
+		lock.unlock();
+		worker_event.notify_all();
+	}
+
+	void AsyncFileReader_Impl::worker_main()
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			worker_event.wait(lock, [&]() { return stop_flag || !work.empty(); });
+			if (work.empty())
+				break;
+			std::unique_ptr<AsyncFileReadOperation> operation = std::move(work.front());
+			work.pop_front();
+			lock.unlock();
+
+			try
+			{
+				read_blocking(operation.get());
+			}
+			catch (...)
+			{
+				fail(std::move(operation), std::current_exception());
+				continue;
+			}
+			complete(std::move(operation));
+		}
+	}
+
+	void AsyncFileReader_Impl::read_blocking(AsyncFileReadOperation *operation)
+	{
+		const AsyncFileRead &request = operation->request;
+		IODevice device = operation->open_device ? operation->open_device() : File(request.filename);
+
+		if (request.offset != 0 && !device.seek64(request.offset, IODevice::seek_set))
+			throw Exception(string_format("AsyncFileReader: Unable to seek to %1 in '%2'", (long long)request.offset, request.filename));
+
+		int64_t size = request.size;
+		int64_t device_size = device.get_size64();
+		if (size < 0 && device_size >= 0)
+			size = std::max(device_size - request.offset, (int64_t)0);
+
+		if (size >= 0)
+		{
+			operation->buffer.set_size64(size);
+			operation->bytes_read = std::max(device.read64(operation->buffer.get_data(), size), (int64_t)0);
+		}
+		else
+		{
+			// Device of unknown size, read until it ends
+			const int chunk_size = 64 * 1024;
+			while (true)
+			{
+				operation->buffer.set_size64(operation->bytes_read + chunk_size);
+				int received = device.read(operation->buffer.get_data() + operation->bytes_read, chunk_size);
+				if (received <= 0)
+					break;
+				operation->bytes_read += received;
+			}
+		}
+	}
+}
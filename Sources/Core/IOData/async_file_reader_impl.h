@@ -0,0 +1,82 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/IOData/async_file_reader.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace clan
+{
+	class AsyncFileReader_IOUring;
+
+	class AsyncFileReadOperation
+	{
+	public:
+		AsyncFileRead request;
+		std::function<IODevice()> open_device;
+		std::shared_ptr<Task_Impl<DataBuffer>> task = std::make_shared<Task_Impl<DataBuffer>>();
+		DataBuffer buffer;
+		int64_t bytes_read = 0;
+		int handle = -1;
+	};
+
+	class AsyncFileReader_Impl
+	{
+	public:
+		AsyncFileReader_Impl(AsyncFileReader::Backend backend, int queue_depth);
+		~AsyncFileReader_Impl();
+
+		void submit(std::vector<std::unique_ptr<AsyncFileReadOperation>> &operations);
+
+		/// \brief Completes the task of an operation and deletes it
+		void complete(std::unique_ptr<AsyncFileReadOperation> operation);
+		void fail(std::unique_ptr<AsyncFileReadOperation> operation, std::exception_ptr exception);
+
+		AsyncFileReader::Backend backend;
+		int queue_depth;
+		std::atomic_int pending;
+
+	private:
+		void queue_on_workers(std::vector<std::unique_ptr<AsyncFileReadOperation>> &operations);
+		void worker_main();
+		void read_blocking(AsyncFileReadOperation *operation);
+
+		std::unique_ptr<AsyncFileReader_IOUring> io_uring;
+
+		std::mutex mutex;
+		std::condition_variable worker_event;
+		std::deque<std::unique_ptr<AsyncFileReadOperation>> work;
+		std::vector<std::thread> workers;
+		bool stop_flag = false;
+	};
+}
@@ -0,0 +1,289 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/buffered_iodevice.h"
+#include "API/Core/System/exception.h"
+#include "iodevice_impl.h"
+#include "iodevice_provider_buffered.h"
+#include <algorithm>
+#include <limits>
+
+namespace clan
+{
+	BufferedIODevice::BufferedIODevice()
+	{
+	}
+
+	BufferedIODevice::BufferedIODevice(IODevice device, int buffer_size)
+		: IODevice(new IODeviceProvider_Buffered(device, buffer_size))
+	{
+	}
+
+	IODevice BufferedIODevice::get_device() const
+	{
+		throw_if_null();
+		const IODeviceProvider_Buffered *provider = dynamic_cast<const IODeviceProvider_Buffered*>(impl->provider);
+		return provider->get_device();
+	}
+
+	int BufferedIODevice::get_buffer_size() const
+	{
+		throw_if_null();
+		const IODeviceProvider_Buffered *provider = dynamic_cast<const IODeviceProvider_Buffered*>(impl->provider);
+		return provider->get_buffer_size();
+	}
+
+	void BufferedIODevice::flush()
+	{
+		throw_if_null();
+		IODeviceProvider_Buffered *provider = dynamic_cast<IODeviceProvider_Buffered*>(impl->provider);
+		provider->flush();
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	IODeviceProvider_Buffered::IODeviceProvider_Buffered(IODevice device, int buffer_size)
+		: device(device), buffer_size(std::max(buffer_size, 16))
+	{
+		device.throw_if_null();
+		buffer.resize(this->buffer_size);
+	}
+
+	IODeviceProvider_Buffered::~IODeviceProvider_Buffered()
+	{
+		try
+		{
+			flush();
+		}
+		catch (...)
+		{
+			// Destructors must not throw. Call BufferedIODevice::flush() to see write errors.
+		}
+	}
+
+	int IODeviceProvider_Buffered::get_size() const
+	{
+		int64_t size = get_size64();
+		if (size > std::numeric_limits<int>::max())
+			throw Exception("BufferedIODevice: Device size does not fit 32 bits");
+		return (int)size;
+	}
+
+	int IODeviceProvider_Buffered::get_position() const
+	{
+		int64_t position = get_position64();
+		if (position > std::numeric_limits<int>::max())
+			throw Exception("BufferedIODevice: Device position does not fit 32 bits");
+		return (int)position;
+	}
+
+	int64_t IODeviceProvider_Buffered::get_size64() const
+	{
+		int64_t size = device.get_size64();
+		if (size != -1 && write_size > 0)
+			size = std::max(size, get_position64());
+		return size;
+	}
+
+	int64_t IODeviceProvider_Buffered::get_position64() const
+	{
+		int64_t position = device.get_position64();
+		if (position == -1)
+			return -1;
+		return position - get_read_available() + write_size;
+	}
+
+	int IODeviceProvider_Buffered::send(const void *data, int len, bool send_all)
+	{
+		if (len <= 0)
+			return 0;
+
+		discard_read();
+
+		if (write_size + len > buffer_size)
+			flush_write();
+
+		if (len >= buffer_size)
+			return device.send(data, len, send_all);
+
+		memcpy(buffer.data() + write_size, data, len);
+		write_size += len;
+		return len;
+	}
+
+	int IODeviceProvider_Buffered::receive(void *data, int len, bool receive_all)
+	{
+		if (len <= 0)
+			return 0;
+
+		flush_write();
+
+		char *dest = static_cast<char*>(data);
+		int total = 0;
+		while (total < len)
+		{
+			if (get_read_available() == 0)
+			{
+				// Large reads go directly to the destination
+				int remaining = len - total;
+				if (remaining >= buffer_size)
+				{
+					read_pos = 0;
+					read_end = 0;
+					int received = device.receive(dest + total, remaining, receive_all);
+					if (received > 0)
+						total += received;
+					break;
+				}
+
+				if (!fill(1))
+					break;
+			}
+
+			int amount = std::min(get_read_available(), len - total);
+			memcpy(dest + total, buffer.data() + read_pos, amount);
+			read_pos += amount;
+			total += amount;
+
+			if (!receive_all)
+				break;
+		}
+		return total;
+	}
+
+	int IODeviceProvider_Buffered::peek(void *data, int len)
+	{
+		if (len <= 0)
+			return 0;
+
+		flush_write();
+		fill(len);
+
+		int amount = std::min(get_read_available(), len);
+		memcpy(data, buffer.data() + read_pos, amount);
+		return amount;
+	}
+
+	bool IODeviceProvider_Buffered::seek(int position, IODevice::SeekMode mode)
+	{
+		return seek64(position, mode);
+	}
+
+	bool IODeviceProvider_Buffered::seek64(int64_t position, IODevice::SeekMode mode)
+	{
+		flush_write();
+
+		// Seek inside the buffer, if the target is still in it
+		if (read_end > 0)
+		{
+			int64_t device_position = device.get_position64();
+			if (device_position != -1)
+			{
+				int64_t buffer_start = device_position - read_end;
+				int64_t target = -1;
+				if (mode == IODevice::seek_set)
+					target = position;
+				else if (mode == IODevice::seek_cur)
+					target = device_position - get_read_available() + position;
+				else if (mode == IODevice::seek_end && device.get_size64() != -1)
+					target = device.get_size64() + position;
+
+				if (target >= buffer_start && target <= device_position)
+				{
+					read_pos = (int)(target - buffer_start);
+					return true;
+				}
+			}
+		}
+
+		if (mode == IODevice::seek_cur)
+			position -= get_read_available();
+		read_pos = 0;
+		read_end = 0;
+		return device.seek64(position, mode);
+	}
+
+	IODeviceProvider *IODeviceProvider_Buffered::duplicate()
+	{
+		return new IODeviceProvider_Buffered(device.duplicate(), buffer_size);
+	}
+
+	void IODeviceProvider_Buffered::flush()
+	{
+		flush_write();
+		discard_read();
+	}
+
+	bool IODeviceProvider_Buffered::fill(int min_available)
+	{
+		int available = get_read_available();
+		if (available >= min_available)
+			return true;
+
+		// Move the unread data to the start of the buffer
+		if (read_pos > 0)
+		{
+			memmove(buffer.data(), buffer.data() + read_pos, available);
+			read_pos = 0;
+			read_end = available;
+		}
+
+		if ((int)buffer.size() < min_available)
+			buffer.resize(min_available);
+
+		while (read_end < min_available)
+		{
+			int received = device.receive(buffer.data() + read_end, (int)buffer.size() - read_end, false);
+			if (received <= 0)
+				break;
+			read_end += received;
+		}
+		return get_read_available() >= min_available;
+	}
+
+	void IODeviceProvider_Buffered::flush_write()
+	{
+		if (write_size > 0)
+		{
+			int size = write_size;
+			write_size = 0;
+			if (device.send(buffer.data(), size, true) != size)
+				throw Exception("BufferedIODevice: Unable to write to device");
+		}
+	}
+
+	void IODeviceProvider_Buffered::discard_read()
+	{
+		int available = get_read_available();
+		read_pos = 0;
+		read_end = 0;
+		if (available > 0)
+			device.seek(-available, IODevice::seek_cur);
+	}
+}
@@ -28,7 +28,13 @@
 
 #include "Core/precomp.h"
 #include "API/Core/IOData/directory_scanner.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/Text/string_format.h"
 #include "directory_scanner_impl.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #ifdef WIN32
 #include "Win32/directory_scanner_win32.h"
@@ -42,6 +48,98 @@
 
 namespace clan
 {
+	namespace
+	{
+		// State shared by the calling thread and the helpers queued for a DirectoryScanner::scan_tree call
+		class DirectoryTreeScan
+		{
+		public:
+			DirectoryTreeScan(const std::string &root) : root(root), active_reads(0), helpers(0), max_helpers(std::max((int)std::thread::hardware_concurrency(), 1))
+			{
+			}
+
+			// Reads directories until there are none left. Only the calling thread queues helpers and waits
+			// for directories still being read, so the helpers never keep a reference to the work queue.
+			static void run(const std::shared_ptr<DirectoryTreeScan> &scan, WorkQueue *calling_thread_queue)
+			{
+				std::unique_lock<std::mutex> lock(scan->mutex);
+				while (true)
+				{
+					if (calling_thread_queue)
+						queue_helpers(scan, *calling_thread_queue);
+
+					if (!scan->pending.empty())
+					{
+						std::string relative_path = scan->pending.back();
+						scan->pending.pop_back();
+						scan->active_reads++;
+						lock.unlock();
+
+						// Collect a batch per directory so the lock is only taken once for it
+						std::vector<DirectoryScanEntry> entries;
+						std::vector<std::string> subdirectories;
+						read_directory(scan->get_path(relative_path), relative_path, entries, subdirectories);
+
+						lock.lock();
+						scan->entries.insert(scan->entries.end(), entries.begin(), entries.end());
+						scan->pending.insert(scan->pending.end(), subdirectories.begin(), subdirectories.end());
+						scan->active_reads--;
+						scan->changed.notify_all();
+					}
+					else if (calling_thread_queue && scan->active_reads > 0)
+					{
+						scan->changed.wait(lock);
+					}
+					else
+					{
+						break;
+					}
+				}
+
+				if (!calling_thread_queue)
+					scan->helpers--;
+			}
+
+			std::string get_path(const std::string &relative_path) const
+			{
+				if (relative_path.empty())
+					return root;
+				return root.empty() ? relative_path : PathHelp::add_trailing_slash(root, PathHelp::path_type_file) + relative_path;
+			}
+
+			static bool read_directory(const std::string &path, const std::string &relative_path, std::vector<DirectoryScanEntry> &out_entries, std::vector<std::string> &out_subdirectories)
+			{
+#ifdef WIN32
+				return DirectoryScanner_Win32::read_directory(path, relative_path, out_entries, out_subdirectories);
+#else
+				return DirectoryScanner_Unix::read_directory(path, relative_path, out_entries, out_subdirectories);
+#endif
+			}
+
+			std::string root;
+
+			std::mutex mutex;
+			std::condition_variable changed;
+			std::vector<std::string> pending;
+			std::vector<DirectoryScanEntry> entries;
+			int active_reads;
+			int helpers;
+			int max_helpers;
+
+		private:
+			// Must be called with the mutex locked
+			static void queue_helpers(const std::shared_ptr<DirectoryTreeScan> &scan, WorkQueue &queue)
+			{
+				// The calling thread reads too, so one pending directory does not need a helper
+				while (scan->helpers < scan->max_helpers && scan->helpers + 1 < (int)scan->pending.size())
+				{
+					scan->helpers++;
+					queue.queue([scan]() { run(scan, nullptr); });
+				}
+			}
+		};
+	}
+
 	DirectoryScanner::DirectoryScanner()
 	{
 #ifdef WIN32
@@ -109,4 +207,32 @@ namespace clan
 	{
 		return impl->next();
 	}
+
+	std::vector<DirectoryScanEntry> DirectoryScanner::scan_tree(const std::string &pathname, const WorkQueue &queue)
+	{
+		auto scan = std::make_shared<DirectoryTreeScan>(pathname);
+
+		// The top directory is read first, so a failure to open it can be reported
+		std::vector<std::string> subdirectories;
+		if (!DirectoryTreeScan::read_directory(pathname, std::string(), scan->entries, subdirectories))
+			throw Exception(string_format("Unable to scan directory: %1", pathname));
+
+		std::unique_lock<std::mutex> lock(scan->mutex);
+		scan->pending = subdirectories;
+		lock.unlock();
+		WorkQueue helper_queue = queue;
+		DirectoryTreeScan::run(scan, &helper_queue);
+
+		// Helpers still queued find nothing left to do, so the result can be handed out now
+		lock.lock();
+		std::vector<DirectoryScanEntry> entries;
+		entries.swap(scan->entries);
+		return entries;
+	}
+
+	std::vector<DirectoryScanEntry> DirectoryScanner::scan_tree(const std::string &pathname)
+	{
+		WorkQueue queue;
+		return scan_tree(pathname, queue);
+	}
 }
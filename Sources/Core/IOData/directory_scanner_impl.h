@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include "API/Core/IOData/directory_scanner.h"
+
 namespace clan
 {
 	class DirectoryScanner_Impl
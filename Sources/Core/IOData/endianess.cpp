@@ -28,26 +28,117 @@
 
 #include "Core/precomp.h"
 #include "API/Core/IOData/cl_endian.h"
+#include "API/Core/System/system.h"
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#define CL_ENDIAN_SSSE3
+// GCC and Clang only allow SSSE3 instructions in functions marked for it, unless -mssse3 is passed
+#if defined(__GNUC__) && !defined(__SSSE3__)
+#define CL_ENDIAN_SSSE3_FUNC __attribute__((target("ssse3")))
+#else
+#define CL_ENDIAN_SSSE3_FUNC
+#endif
+#endif
 
 namespace clan
 {
-	void Endian::swap(void *data, int type_size, int total_times)
+	namespace
 	{
-		if (type_size == 1) return;
+		void swap_bytes(unsigned char *d, int type_size, int total_times)
+		{
+			for (int j = 0; j < total_times; j++)
+			{
+				for (int i = 0; i < type_size / 2; i++)
+				{
+					unsigned char a = d[i];
+					d[i] = d[type_size - 1 - i];
+					d[type_size - 1 - i] = a;
+				}
 
-		unsigned char *d = (unsigned char *)data;
+				d += type_size;
+			}
+		}
 
-		for (int j = 0; j < total_times; j++)
+#ifndef CL_DISABLE_SSE2
+		// Swaps 16 bytes at a time, returns the number of elements swapped
+		int swap_sse2(unsigned char *d, int type_size, int total_times)
 		{
-			for (int i = 0; i < type_size / 2; i++)
+			int count = (int)((int64_t)total_times * type_size / 16);
+			for (int i = 0; i < count; i++)
 			{
-				unsigned char a = d[i];
-				d[i] = d[type_size - 1 - i];
-				d[type_size - 1 - i] = a;
+				__m128i *p = reinterpret_cast<__m128i*>(d + i * 16);
+				__m128i v = _mm_loadu_si128(p);
+
+				// Swap the bytes in each 16 bit word, then reverse the words in each element
+				v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+				if (type_size == 4)
+				{
+					v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+					v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+				}
+				else if (type_size == 8)
+				{
+					v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+					v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+				}
+
+				_mm_storeu_si128(p, v);
 			}
+			return count * 16 / type_size;
+		}
+#endif
+
+#ifdef CL_ENDIAN_SSSE3
+		const bool has_ssse3 = System::detect_cpu_extension(System::ssse3);
+
+		// Swaps 32 bytes at a time with byte shuffles, returns the number of elements swapped
+		CL_ENDIAN_SSSE3_FUNC int swap_ssse3(unsigned char *d, int type_size, int total_times)
+		{
+			__m128i mask;
+			if (type_size == 2)
+				mask = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+			else if (type_size == 4)
+				mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+			else
+				mask = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
 
-			d += type_size;
+			int count = (int)((int64_t)total_times * type_size / 32);
+			for (int i = 0; i < count; i++)
+			{
+				__m128i *p = reinterpret_cast<__m128i*>(d + i * 32);
+				__m128i v0 = _mm_loadu_si128(p);
+				__m128i v1 = _mm_loadu_si128(p + 1);
+				_mm_storeu_si128(p, _mm_shuffle_epi8(v0, mask));
+				_mm_storeu_si128(p + 1, _mm_shuffle_epi8(v1, mask));
+			}
+			return count * 32 / type_size;
 		}
+#endif
+	}
+
+	void Endian::swap(void *data, int type_size, int total_times)
+	{
+		if (type_size == 1) return;
+
+		unsigned char *d = (unsigned char *)data;
+
+#ifndef CL_DISABLE_SSE2
+		if (type_size == 2 || type_size == 4 || type_size == 8)
+		{
+			int swapped = 0;
+#ifdef CL_ENDIAN_SSSE3
+			if (has_ssse3)
+				swapped = swap_ssse3(d, type_size, total_times);
+#endif
+			swapped += swap_sse2(d + swapped * type_size, type_size, total_times - swapped);
+			d += swapped * type_size;
+			total_times -= swapped;
+		}
+#endif
+
+		swap_bytes(d, type_size, total_times);
 	}
 
 	bool Endian::is_system_big()
@@ -31,6 +31,7 @@
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/System/exception.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/System/task.h"
 #include "iodevice_impl.h"
 #include "iodevice_provider_file.h"
 
@@ -39,12 +40,12 @@ namespace clan
 	std::string File::read_text(const std::string &filename)
 	{
 		File file(filename);
-		unsigned int file_size = file.get_size();
+		size_t file_size = (size_t)file.get_size64();
 		std::vector<char> text;
 		text.resize(file_size + 1);
 		text[file_size] = 0;
 		if (file_size)
-			file.read(&text[0], file_size);
+			file.read64(&text[0], file_size);
 		file.close();
 		if (file_size)
 			return std::string(&text[0]);
@@ -55,12 +56,23 @@ namespace clan
 	DataBuffer File::read_bytes(const std::string &filename)
 	{
 		File file(filename);
-		DataBuffer buffer(file.get_size());
-		file.read(buffer.get_data(), buffer.get_size());
+		DataBuffer buffer;
+		buffer.set_size64(file.get_size64());
+		file.read64(buffer.get_data(), buffer.get_size64());
 		file.close();
 		return buffer;
 	}
 
+	Task<DataBuffer> File::read_bytes_async(const WorkQueue &queue, const std::string &filename)
+	{
+		return task_run(resume_on_worker(queue), [filename]() { return File::read_bytes(filename); });
+	}
+
+	FileMapping File::map(const std::string &filename, FileMapping::AccessPattern pattern)
+	{
+		return FileMapping(PathHelp::normalize(filename, PathHelp::path_type_file), pattern);
+	}
+
 	void File::write_text(const std::string &filename, const std::string &text, bool write_bom)
 	{
 		File file(filename, create_always, access_write);
@@ -76,7 +88,7 @@ namespace clan
 	void File::write_bytes(const std::string &filename, const DataBuffer &bytes)
 	{
 		File file(filename, create_always, access_write);
-		file.write(bytes.get_data(), bytes.get_size());
+		file.write64(bytes.get_data(), bytes.get_size64());
 		file.close();
 	}
 
@@ -0,0 +1,211 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/file_mapping.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Text/string_help.h"
+#include "API/Core/Text/string_format.h"
+#include "iodevice_provider_mmap.h"
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace clan
+{
+	class FileMapping_Impl
+	{
+	public:
+		FileMapping_Impl(const std::string &filename, FileMapping::AccessPattern pattern);
+		~FileMapping_Impl();
+
+		void advise(FileMapping::AccessPattern pattern, size_t offset, size_t length);
+
+		char *data = nullptr;
+		size_t size = 0;
+	};
+
+	FileMapping::FileMapping()
+	{
+	}
+
+	FileMapping::FileMapping(const std::string &filename, AccessPattern pattern)
+		: impl(std::make_shared<FileMapping_Impl>(filename, pattern))
+	{
+	}
+
+	void FileMapping::throw_if_null() const
+	{
+		if (!impl)
+			throw Exception("FileMapping is null");
+	}
+
+	const char *FileMapping::get_data() const
+	{
+		return impl ? impl->data : nullptr;
+	}
+
+	size_t FileMapping::get_size() const
+	{
+		return impl ? impl->size : 0;
+	}
+
+	void FileMapping::advise(AccessPattern pattern, size_t offset, size_t length) const
+	{
+		throw_if_null();
+		impl->advise(pattern, offset, length);
+	}
+
+	IODevice FileMapping::create_device() const
+	{
+		throw_if_null();
+		return IODevice(new IODeviceProvider_MMap(*this));
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+#ifdef WIN32
+
+	FileMapping_Impl::FileMapping_Impl(const std::string &filename, FileMapping::AccessPattern pattern)
+	{
+		DWORD flags = 0;
+		if (pattern == FileMapping::access_sequential)
+			flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+		else if (pattern == FileMapping::access_random)
+			flags |= FILE_FLAG_RANDOM_ACCESS;
+
+		HANDLE file = CreateFile(StringHelp::utf8_to_ucs2(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, flags, 0);
+		if (file == INVALID_HANDLE_VALUE)
+			throw Exception(string_format("Unable to open file '%1'", filename));
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size))
+		{
+			CloseHandle(file);
+			throw Exception(string_format("Unable to get size of file '%1'", filename));
+		}
+
+		if (file_size.QuadPart > 0)
+		{
+			HANDLE mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+			if (mapping)
+			{
+				data = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				CloseHandle(mapping);
+			}
+			if (!data)
+			{
+				CloseHandle(file);
+				throw Exception(string_format("Unable to map file '%1'", filename));
+			}
+			size = (size_t)file_size.QuadPart;
+		}
+		CloseHandle(file);
+	}
+
+	FileMapping_Impl::~FileMapping_Impl()
+	{
+		if (data)
+			UnmapViewOfFile(data);
+	}
+
+	void FileMapping_Impl::advise(FileMapping::AccessPattern pattern, size_t offset, size_t length)
+	{
+		// Windows only takes the access pattern when the file is opened
+	}
+
+#else
+
+	FileMapping_Impl::FileMapping_Impl(const std::string &filename, FileMapping::AccessPattern pattern)
+	{
+		int handle = ::open(filename.c_str(), O_RDONLY);
+		if (handle == -1)
+			throw Exception(string_format("Unable to open file '%1'", filename));
+
+		struct stat file_stat;
+		if (fstat(handle, &file_stat) == -1)
+		{
+			::close(handle);
+			throw Exception(string_format("Unable to get size of file '%1'", filename));
+		}
+
+		if (file_stat.st_size > 0)
+		{
+			void *result = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+			if (result == MAP_FAILED)
+			{
+				::close(handle);
+				throw Exception(string_format("Unable to map file '%1'", filename));
+			}
+			data = static_cast<char*>(result);
+			size = (size_t)file_stat.st_size;
+		}
+
+		// The mapping keeps the file open
+		::close(handle);
+
+		if (pattern != FileMapping::access_normal)
+			advise(pattern, 0, 0);
+	}
+
+	FileMapping_Impl::~FileMapping_Impl()
+	{
+		if (data)
+			munmap(data, size);
+	}
+
+	void FileMapping_Impl::advise(FileMapping::AccessPattern pattern, size_t offset, size_t length)
+	{
+		if (!data || offset >= size)
+			return;
+		if (length == 0 || length > size - offset)
+			length = size - offset;
+
+		// The range must start at a page boundary
+		size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+		size_t page_offset = offset % page_size;
+		offset -= page_offset;
+		length += page_offset;
+
+		int advice = POSIX_MADV_NORMAL;
+		switch (pattern)
+		{
+		case FileMapping::access_normal: advice = POSIX_MADV_NORMAL; break;
+		case FileMapping::access_sequential: advice = POSIX_MADV_SEQUENTIAL; break;
+		case FileMapping::access_random: advice = POSIX_MADV_RANDOM; break;
+		case FileMapping::access_will_need: advice = POSIX_MADV_WILLNEED; break;
+		}
+		posix_madvise(data + offset, length, advice);
+	}
+
+#endif
+}
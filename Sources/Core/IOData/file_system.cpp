@@ -57,6 +57,9 @@ namespace clan
 		FileSystemProvider *provider;
 
 		std::vector< std::pair<std::string, FileSystem> > mounts;
+
+		std::mutex async_reader_mutex;
+		AsyncFileReader async_reader;
 	};
 
 	FileSystem::FileSystem()
@@ -204,6 +207,76 @@ namespace clan
 		}
 	}
 
+	Task<DataBuffer> FileSystem::read_async(const std::string &filename, int64_t offset, int64_t size) const
+	{
+		return read_async(std::vector<AsyncFileRead>(1, AsyncFileRead(filename, offset, size))).front();
+	}
+
+	std::vector<Task<DataBuffer>> FileSystem::read_async(const std::vector<AsyncFileRead> &requests) const
+	{
+		AsyncFileReader reader = get_async_reader();
+
+		std::vector<Task<DataBuffer>> tasks(requests.size());
+		std::vector<AsyncFileRead> native_requests;
+		std::vector<size_t> native_indexes;
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			std::string provider_filename;
+			FileSystem fs = find_provider(requests[i].filename, provider_filename);
+
+			// Files on disk are batched into a single submission to the reader
+			FileSystemProvider_File *file_provider = dynamic_cast<FileSystemProvider_File*>(fs.impl->provider);
+			if (file_provider)
+			{
+				native_requests.push_back(AsyncFileRead(file_provider->get_path() + provider_filename, requests[i].offset, requests[i].size));
+				native_indexes.push_back(i);
+			}
+			else
+			{
+				tasks[i] = reader.read([=]() { return fs.impl->provider->open_file(provider_filename, File::open_existing, File::access_read); }, requests[i].offset, requests[i].size);
+			}
+		}
+
+		std::vector<Task<DataBuffer>> native_tasks = reader.read(native_requests);
+		for (size_t i = 0; i < native_tasks.size(); i++)
+			tasks[native_indexes[i]] = native_tasks[i];
+		return tasks;
+	}
+
+	void FileSystem::set_async_reader(const AsyncFileReader &reader)
+	{
+		std::unique_lock<std::mutex> lock(impl->async_reader_mutex);
+		impl->async_reader = reader;
+	}
+
+	AsyncFileReader FileSystem::get_async_reader() const
+	{
+		std::unique_lock<std::mutex> lock(impl->async_reader_mutex);
+		if (impl->async_reader.is_null())
+			impl->async_reader = AsyncFileReader(AsyncFileReader::backend_auto);
+		return impl->async_reader;
+	}
+
+	FileSystem FileSystem::find_provider(const std::string &filename_rel, std::string &out_provider_filename) const
+	{
+		std::string filename = PathHelp::make_absolute(
+			"/",
+			filename_rel,
+			PathHelp::path_type_virtual);
+
+		for (const auto &mount : impl->mounts)
+		{
+			if (mount.first == filename.substr(0, mount.first.length()))
+				return mount.second.find_provider(filename.substr(mount.first.length()), out_provider_filename);
+		}
+
+		if (!impl->provider)
+			throw Exception(string_format("Unable to open file: %1", filename));
+
+		out_provider_filename = PathHelp::make_relative("/", filename, PathHelp::path_type_virtual);
+		return *this;
+	}
+
 	void FileSystem::mount(const std::string &mount_point, FileSystem fs)
 	{
 		std::string mount_point_slash = PathHelp::add_trailing_slash(
@@ -0,0 +1,125 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "file_system_provider_overlay.h"
+#include "overlay_file_system_impl.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/directory_listing_entry.h"
+#include "API/Core/IOData/path_help.h"
+#include <algorithm>
+#include <set>
+
+namespace clan
+{
+	FileSystemProvider_Overlay::FileSystemProvider_Overlay(const std::shared_ptr<OverlayFileSystem_Impl> &overlay)
+		: overlay(overlay), listing_index(0)
+	{
+	}
+
+	FileSystemProvider_Overlay::~FileSystemProvider_Overlay()
+	{
+	}
+
+	std::string FileSystemProvider_Overlay::get_path() const
+	{
+		return std::string();
+	}
+
+	std::string FileSystemProvider_Overlay::get_identifier() const
+	{
+		std::unique_lock<std::mutex> lock(overlay->mutex);
+		std::string identifier = "overlay:";
+		for (auto &layer : overlay->layers)
+			identifier += "[" + layer.fs.get_identifier() + "]";
+		return identifier;
+	}
+
+	IODevice FileSystemProvider_Overlay::open_file(const std::string &filename,
+		File::OpenMode mode,
+		unsigned int access,
+		unsigned int share,
+		unsigned int flags)
+	{
+		return overlay->open_file(filename, mode, access, share, flags);
+	}
+
+	bool FileSystemProvider_Overlay::initialize_directory_listing(const std::string &path)
+	{
+		listing.clear();
+		listing_index = 0;
+
+		std::string prefix = overlay->make_key(PathHelp::remove_trailing_slash(overlay->make_filename(path)));
+		if (!prefix.empty())
+			prefix += '/';
+
+		std::unique_lock<std::mutex> lock(overlay->mutex);
+		overlay->build_index();
+
+		std::set<std::string> added_directories;
+		for (auto &it : overlay->index)
+		{
+			const std::string &key = it.first;
+			if (key.compare(0, prefix.length(), prefix) != 0)
+				continue;
+
+			// Keys and filenames only differ in case, so the positions of the slashes match
+			const std::string &filename = it.second.filename;
+			std::string::size_type slash_pos = key.find('/', prefix.length());
+			if (slash_pos == std::string::npos)
+			{
+				ListingEntry entry = { filename.substr(prefix.length()), false };
+				listing.push_back(entry);
+			}
+			else if (added_directories.insert(key.substr(prefix.length(), slash_pos - prefix.length())).second)
+			{
+				ListingEntry entry = { filename.substr(prefix.length(), slash_pos - prefix.length()), true };
+				listing.push_back(entry);
+			}
+		}
+
+		std::sort(listing.begin(), listing.end(), [](const ListingEntry &a, const ListingEntry &b) { return a.filename < b.filename; });
+
+		// Directories only exist in the index through the files in them
+		return prefix.empty() || !listing.empty();
+	}
+
+	bool FileSystemProvider_Overlay::next_file(DirectoryListingEntry &entry)
+	{
+		if (listing_index >= listing.size())
+			return false;
+
+		entry.set_filename(listing[listing_index].filename);
+		entry.set_directory(listing[listing_index].is_directory);
+		entry.set_readable(true);
+		entry.set_hidden(false);
+		entry.set_writable(false);
+		listing_index++;
+		return true;
+	}
+}
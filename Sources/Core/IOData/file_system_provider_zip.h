@@ -46,6 +46,8 @@ namespace clan
 		std::string get_path() const override;
 		std::string get_identifier() const override;
 
+		const ZipArchive &get_archive() const { return zip_archive; }
+
 		/// \brief Open a zip file
 		/** param: filename = The filename to use
 			param: mode = File::OpenMode modes
@@ -32,6 +32,7 @@
 #include "API/Core/IOData/iodevice_provider.h"
 #include "API/Core/IOData/cl_endian.h"
 #include "iodevice_impl.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -69,6 +70,20 @@ namespace clan
 		return -1;
 	}
 
+	int64_t IODevice::get_size64() const
+	{
+		if (impl)
+			return impl->provider->get_size64();
+		return -1;
+	}
+
+	int64_t IODevice::get_position64() const
+	{
+		if (impl)
+			return impl->provider->get_position64();
+		return -1;
+	}
+
 	bool IODevice::is_little_endian() const
 	{
 		return impl->little_endian_mode;
@@ -114,6 +129,13 @@ namespace clan
 		return false;
 	}
 
+	bool IODevice::seek64(int64_t position, SeekMode mode)
+	{
+		if (impl)
+			return impl->provider->seek64(position, mode);
+		return false;
+	}
+
 	int IODevice::read(void *data, int len, bool receive_all)
 	{
 		return receive(data, len, receive_all);
@@ -124,6 +146,48 @@ namespace clan
 		return send(data, len, send_all);
 	}
 
+	int64_t IODevice::read64(void *data, int64_t len, bool receive_all)
+	{
+		if (!impl)
+			return -1;
+
+		const int64_t chunk_size = 1 << 30;
+		char *dest = static_cast<char*>(data);
+		int64_t total = 0;
+		while (total < len)
+		{
+			int chunk = (int)std::min(len - total, chunk_size);
+			int received = impl->provider->receive(dest + total, chunk, receive_all);
+			if (received <= 0)
+				break;
+			total += received;
+			if (received != chunk)
+				break;
+		}
+		return total;
+	}
+
+	int64_t IODevice::write64(const void *data, int64_t len, bool send_all)
+	{
+		if (!impl)
+			return -1;
+
+		const int64_t chunk_size = 1 << 30;
+		const char *src = static_cast<const char*>(data);
+		int64_t total = 0;
+		while (total < len)
+		{
+			int chunk = (int)std::min(len - total, chunk_size);
+			int sent = impl->provider->send(src + total, chunk, send_all);
+			if (sent <= 0)
+				break;
+			total += sent;
+			if (sent != chunk)
+				break;
+		}
+		return total;
+	}
+
 	void IODevice::set_system_mode()
 	{
 		impl->little_endian_mode = !Endian::is_system_big();
@@ -247,6 +311,43 @@ namespace clan
 		write(&final, sizeof(float));
 	}
 
+	void IODevice::write_uint16_array(const uint16_t *data, int count)
+	{
+		write_array(data, sizeof(uint16_t), count);
+	}
+
+	void IODevice::write_uint32_array(const uint32_t *data, int count)
+	{
+		write_array(data, sizeof(uint32_t), count);
+	}
+
+	void IODevice::write_float_array(const float *data, int count)
+	{
+		write_array(data, sizeof(float), count);
+	}
+
+	void IODevice::write_array(const void *data, int type_size, int count)
+	{
+		int64_t size = (int64_t)type_size * count;
+		if (impl->little_endian_mode != Endian::is_system_big())
+		{
+			if (write64(data, size) != size) throw Exception("IODevice::write_array() failed");
+			return;
+		}
+
+		// Swap a chunk at a time, as the source is const
+		const int chunk_count = 4096;
+		char buffer[chunk_count * 8];
+		const char *src = static_cast<const char*>(data);
+		for (int pos = 0; pos < count; pos += chunk_count)
+		{
+			int length = std::min(count - pos, chunk_count);
+			memcpy(buffer, src + (int64_t)pos * type_size, length * type_size);
+			Endian::swap(buffer, type_size, length);
+			if (write(buffer, length * type_size) != length * type_size) throw Exception("IODevice::write_array() failed");
+		}
+	}
+
 	void IODevice::write_string_a(const std::string &str)
 	{
 		int size = str.length();
@@ -404,6 +505,29 @@ namespace clan
 		return answer;
 	}
 
+	void IODevice::read_uint16_array(uint16_t *data, int count)
+	{
+		read_array(data, sizeof(uint16_t), count);
+	}
+
+	void IODevice::read_uint32_array(uint32_t *data, int count)
+	{
+		read_array(data, sizeof(uint32_t), count);
+	}
+
+	void IODevice::read_float_array(float *data, int count)
+	{
+		read_array(data, sizeof(float), count);
+	}
+
+	void IODevice::read_array(void *data, int type_size, int count)
+	{
+		int64_t size = (int64_t)type_size * count;
+		if (read64(data, size) != size) throw Exception("IODevice::read_array() failed");
+		if (impl->little_endian_mode == Endian::is_system_big())
+			Endian::swap(data, type_size, count);
+	}
+
 	std::string IODevice::read_string_a()
 	{
 		int size = read_int32();
@@ -0,0 +1,76 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/IOData/iodevice_provider.h"
+#include <vector>
+
+namespace clan
+{
+	class IODeviceProvider_Buffered : public IODeviceProvider
+	{
+	public:
+		IODeviceProvider_Buffered(IODevice device, int buffer_size);
+		~IODeviceProvider_Buffered();
+
+		int get_size() const override;
+		int get_position() const override;
+		int64_t get_size64() const override;
+		int64_t get_position64() const override;
+
+		int send(const void *data, int len, bool send_all) override;
+		int receive(void *data, int len, bool receive_all) override;
+		int peek(void *data, int len) override;
+		bool seek(int position, IODevice::SeekMode mode) override;
+		bool seek64(int64_t position, IODevice::SeekMode mode) override;
+		IODeviceProvider *duplicate() override;
+
+		void flush();
+
+		IODevice get_device() const { return device; }
+		int get_buffer_size() const { return buffer_size; }
+
+	private:
+		int get_read_available() const { return read_end - read_pos; }
+		bool fill(int min_available);
+		void flush_write();
+		void discard_read();
+
+		IODevice device;
+		int buffer_size;
+		std::vector<char> buffer;
+
+		// Bytes of buffer not read yet, when reading
+		int read_pos = 0;
+		int read_end = 0;
+
+		// Bytes of buffer not written yet, when writing
+		int write_size = 0;
+	};
+}
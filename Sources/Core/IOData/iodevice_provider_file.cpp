@@ -34,6 +34,7 @@
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Math/cl_math.h"
 #include "iodevice_provider_file.h"
+#include <limits>
 #ifndef WIN32
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -73,44 +74,56 @@ namespace clan
 	}
 
 	int IODeviceProvider_File::get_size() const
+	{
+		int64_t size = get_size64();
+		if (size > std::numeric_limits<int>::max())
+			throw Exception("IODeviceProvider_File::get_size(): File size does not fit 32 bits");
+		return (int)size;
+	}
+
+	int IODeviceProvider_File::get_position() const
+	{
+		int64_t pos = get_position64();
+		if (pos > std::numeric_limits<int>::max())
+			throw Exception("IODeviceProvider_File::get_position(): File position does not fit 32 bits");
+		return (int)pos;
+	}
+
+	int64_t IODeviceProvider_File::get_size64() const
 	{
 #ifdef WIN32
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
 
-		DWORD size = GetFileSize(handle, 0);
-		if (size == INVALID_FILE_SIZE)
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(handle, &size) == FALSE)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
 
-		return size;
+		return size.QuadPart;
 #else
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size, no file open");
 
-		off_t old_pos = lseek(handle, 0, SEEK_CUR);
-		if (old_pos == (off_t) -1)
+		struct stat file_stat;
+		if (fstat(handle, &file_stat) == -1)
 			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
-		off_t size = lseek(handle, 0, SEEK_END);
-		lseek(handle, old_pos, SEEK_SET);
 
-		if (size == (off_t) -1)
-			throw Exception("IODeviceProvider_File::get_size(): Unable to get file size");
-
-		return (int) size;
+		return (int64_t)file_stat.st_size;
 #endif
 	}
 
-	int IODeviceProvider_File::get_position() const
+	int64_t IODeviceProvider_File::get_position64() const
 	{
 #ifdef WIN32
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer, no file open");
 
-		DWORD pos = SetFilePointer(handle, 0, 0, FILE_CURRENT);
-		if (pos == INVALID_SET_FILE_POINTER)
+		LARGE_INTEGER distance, pos;
+		distance.QuadPart = 0;
+		if (SetFilePointerEx(handle, distance, &pos, FILE_CURRENT) == FALSE)
 			throw Exception("IODeviceProvider_File::get_position(): Unable to get file position pointer");
 
-		return (int)pos;
+		return pos.QuadPart;
 #else
 		if (handle == invalid_handle)
 			throw Exception("Unable to get file position pointer, no file open");
@@ -119,7 +132,7 @@ namespace clan
 		if (pos == (off_t) -1)
 			throw Exception("Unable to get file position pointer");
 
-		return pos;
+		return (int64_t)pos;
 #endif
 	}
 
@@ -302,6 +315,11 @@ namespace clan
 	}
 
 	bool IODeviceProvider_File::seek(int position, IODevice::SeekMode seek_mode)
+	{
+		return seek64(position, seek_mode);
+	}
+
+	bool IODeviceProvider_File::seek64(int64_t position, IODevice::SeekMode seek_mode)
 	{
 		if (handle == invalid_handle)
 			throw Exception("IODeviceProvider_File::seek(): Unable to get file position pointer, no file open");
@@ -315,8 +333,9 @@ namespace clan
 		case IODevice::seek_end: moveMethod = FILE_END; break;
 		}
 
-		DWORD new_pos = SetFilePointer(handle, position, 0, moveMethod);
-		return (new_pos != INVALID_FILE_SIZE);
+		LARGE_INTEGER distance;
+		distance.QuadPart = position;
+		return SetFilePointerEx(handle, distance, 0, moveMethod) == TRUE;
 #else
 		int mode = SEEK_SET;
 		if (seek_mode == File::seek_set)
@@ -326,7 +345,10 @@ namespace clan
 		else if (seek_mode == File::seek_end)
 			mode = SEEK_END;
 
-		off_t new_pos = lseek(handle, position, mode);
+		if ((int64_t)(off_t)position != position)
+			return false;
+
+		off_t new_pos = lseek(handle, (off_t)position, mode);
 		if (new_pos == (off_t) -1)
 			return false;
 		else
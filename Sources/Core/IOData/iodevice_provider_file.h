@@ -50,6 +50,8 @@ namespace clan
 
 		int get_size() const override;
 		int get_position() const override;
+		int64_t get_size64() const override;
+		int64_t get_position64() const override;
 
 		bool open(
 			const std::string &filename,
@@ -67,6 +69,7 @@ namespace clan
 		int peek(void *data, int len) override;
 
 		bool seek(int position, IODevice::SeekMode mode) override;
+		bool seek64(int64_t position, IODevice::SeekMode mode) override;
 
 		IODeviceProvider *duplicate() override;
 
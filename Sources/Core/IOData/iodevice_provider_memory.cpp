@@ -30,6 +30,8 @@
 #include "API/Core/IOData/memory_device.h"
 #include "iodevice_provider_memory.h"
 #include "API/Core/Math/cl_math.h"
+#include "API/Core/System/exception.h"
+#include <limits>
 
 namespace clan
 {
@@ -45,10 +47,26 @@ namespace clan
 
 	int IODeviceProvider_Memory::get_size() const
 	{
-		return data.get_size();
+		int64_t size = get_size64();
+		if (size > std::numeric_limits<int>::max())
+			throw Exception("IODeviceProvider_Memory::get_size(): Data size does not fit 32 bits");
+		return (int)size;
 	}
 
 	int IODeviceProvider_Memory::get_position() const
+	{
+		int64_t pos = get_position64();
+		if (pos > std::numeric_limits<int>::max())
+			throw Exception("IODeviceProvider_Memory::get_position(): Position does not fit 32 bits");
+		return (int)pos;
+	}
+
+	int64_t IODeviceProvider_Memory::get_size64() const
+	{
+		return (int64_t)data.get_size64();
+	}
+
+	int64_t IODeviceProvider_Memory::get_position64() const
 	{
 		validate_position();
 		return position;
@@ -67,16 +85,18 @@ namespace clan
 	int IODeviceProvider_Memory::send(const void *send_data, int len, bool send_all)
 	{
 		validate_position();
-		int size_needed = position + len;
-		if (size_needed > data.get_size())
+		if (len <= 0)
+			return 0;
+		uint64_t size_needed = (uint64_t)position + len;
+		if (size_needed > data.get_size64())
 		{
-			if (size_needed > data.get_capacity())	// Capacity exceeded
+			if (size_needed > data.get_capacity64())	// Capacity exceeded
 			{
 				// Estimate the optimum databuffer capacity. TODO: Maybe adjust this class to be link list based, thus removing reallocation and block movement of the DataBuffer
-				data.set_capacity(clan::max(size_needed + clan::min(size_needed, 16 * 1024 * 1024), 16 * 1024));
+				data.set_capacity64(clan::max(size_needed + clan::min(size_needed, (uint64_t)16 * 1024 * 1024), (uint64_t)16 * 1024));
 			}
 
-			data.set_size(size_needed);
+			data.set_size64(size_needed);
 		}
 		memcpy(data.get_data() + position, send_data, len);
 		position += len;
@@ -85,11 +105,7 @@ namespace clan
 
 	int IODeviceProvider_Memory::receive(void *recv_data, int len, bool receive_all)
 	{
-		validate_position();
-		int data_available = data.get_size() - position;
-		if (len > data_available)
-			len = data_available;
-		memcpy(recv_data, data.get_data() + position, len);
+		len = peek(recv_data, len);
 		position += len;
 		return len;
 	}
@@ -97,17 +113,25 @@ namespace clan
 	int IODeviceProvider_Memory::peek(void *recv_data, int len)
 	{
 		validate_position();
-		int data_available = data.get_size() - position;
+		int64_t data_available = (int64_t)data.get_size64() - position;
 		if (len > data_available)
-			len = data_available;
+			len = (int)data_available;
+		if (len <= 0)
+			return 0;
 		memcpy(recv_data, data.get_data() + position, len);
 		return len;
 	}
 
 	bool IODeviceProvider_Memory::seek(int requested_position, IODevice::SeekMode mode)
+	{
+		return seek64(requested_position, mode);
+	}
+
+	bool IODeviceProvider_Memory::seek64(int64_t requested_position, IODevice::SeekMode mode)
 	{
 		validate_position();
-		int new_position = position;
+		int64_t size = (int64_t)data.get_size64();
+		int64_t new_position = position;
 		switch (mode)
 		{
 		case IODevice::seek_set:
@@ -117,13 +141,13 @@ namespace clan
 			new_position += requested_position;
 			break;
 		case IODevice::seek_end:
-			new_position = data.get_size() + requested_position;
+			new_position = size + requested_position;
 			break;
 		default:
 			return false;
 		}
 
-		if (new_position >= 0 && new_position <= data.get_size())
+		if (new_position >= 0 && new_position <= size)
 		{
 			position = new_position;
 			return true;
@@ -141,9 +165,10 @@ namespace clan
 
 	void IODeviceProvider_Memory::validate_position() const
 	{
+		int64_t size = (int64_t)data.get_size64();
 		if (position < 0)
 			position = 0;
-		else if (position > data.get_size())
-			position = data.get_size();
+		else if (position > size)
+			position = size;
 	}
 }
@@ -41,6 +41,8 @@ namespace clan
 
 		virtual int get_size() const override;
 		virtual int get_position() const override;
+		virtual int64_t get_size64() const override;
+		virtual int64_t get_position64() const override;
 
 		const DataBuffer &get_data() const;
 		DataBuffer &get_data();
@@ -49,12 +51,13 @@ namespace clan
 		virtual int receive(void *data, int len, bool receive_all = true) override;
 		virtual int peek(void *data, int len) override;
 		virtual bool seek(int position, IODevice::SeekMode mode) override;
+		virtual bool seek64(int64_t position, IODevice::SeekMode mode) override;
 		IODeviceProvider *duplicate() override;
 
 	private:
 		void validate_position() const;
 
 		DataBuffer data;
-		mutable int position;
+		mutable int64_t position;
 	};
 }
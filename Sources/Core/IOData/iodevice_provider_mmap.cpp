@@ -0,0 +1,111 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "iodevice_provider_mmap.h"
+#include "API/Core/System/exception.h"
+#include <algorithm>
+#include <limits>
+
+namespace clan
+{
+	IODeviceProvider_MMap::IODeviceProvider_MMap(const FileMapping &mapping)
+		: mapping(mapping)
+	{
+	}
+
+	int IODeviceProvider_MMap::get_size() const
+	{
+		if (mapping.get_size() > (size_t)std::numeric_limits<int>::max())
+			throw Exception("IODeviceProvider_MMap::get_size(): File size does not fit 32 bits");
+		return (int)mapping.get_size();
+	}
+
+	int IODeviceProvider_MMap::get_position() const
+	{
+		if (position > (size_t)std::numeric_limits<int>::max())
+			throw Exception("IODeviceProvider_MMap::get_position(): File position does not fit 32 bits");
+		return (int)position;
+	}
+
+	int64_t IODeviceProvider_MMap::get_size64() const
+	{
+		return (int64_t)mapping.get_size();
+	}
+
+	int64_t IODeviceProvider_MMap::get_position64() const
+	{
+		return (int64_t)position;
+	}
+
+	int IODeviceProvider_MMap::send(const void *data, int len, bool send_all)
+	{
+		throw Exception("IODeviceProvider_MMap::send(): File mappings are read-only");
+	}
+
+	int IODeviceProvider_MMap::receive(void *data, int len, bool receive_all)
+	{
+		int amount = peek(data, len);
+		position += amount;
+		return amount;
+	}
+
+	int IODeviceProvider_MMap::peek(void *data, int len)
+	{
+		if (len <= 0 || position >= mapping.get_size())
+			return 0;
+
+		int amount = (int)std::min((size_t)len, mapping.get_size() - position);
+		memcpy(data, mapping.get_data() + position, amount);
+		return amount;
+	}
+
+	bool IODeviceProvider_MMap::seek(int new_position, IODevice::SeekMode mode)
+	{
+		return seek64(new_position, mode);
+	}
+
+	bool IODeviceProvider_MMap::seek64(int64_t new_position, IODevice::SeekMode mode)
+	{
+		int64_t target = new_position;
+		if (mode == IODevice::seek_cur)
+			target += (int64_t)position;
+		else if (mode == IODevice::seek_end)
+			target += (int64_t)mapping.get_size();
+
+		if (target < 0)
+			return false;
+		position = (size_t)target;
+		return true;
+	}
+
+	IODeviceProvider *IODeviceProvider_MMap::duplicate()
+	{
+		return new IODeviceProvider_MMap(mapping);
+	}
+}
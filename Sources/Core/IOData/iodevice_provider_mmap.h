@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/IOData/iodevice_provider.h"
+#include "API/Core/IOData/file_mapping.h"
+
+namespace clan
+{
+	class IODeviceProvider_MMap : public IODeviceProvider
+	{
+	public:
+		IODeviceProvider_MMap(const FileMapping &mapping);
+
+		int get_size() const override;
+		int get_position() const override;
+		int64_t get_size64() const override;
+		int64_t get_position64() const override;
+
+		int send(const void *data, int len, bool send_all) override;
+		int receive(void *data, int len, bool receive_all) override;
+		int peek(void *data, int len) override;
+		bool seek(int position, IODevice::SeekMode mode) override;
+		bool seek64(int64_t position, IODevice::SeekMode mode) override;
+		IODeviceProvider *duplicate() override;
+
+	private:
+		FileMapping mapping;
+		size_t position = 0;
+	};
+}
@@ -0,0 +1,328 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/IOData/overlay_file_system.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/directory_listing.h"
+#include "API/Core/Text/string_help.h"
+#include "API/Core/Text/string_format.h"
+#include "overlay_file_system_impl.h"
+#include "file_system_provider_overlay.h"
+#include "file_system_provider_zip.h"
+#include <algorithm>
+
+namespace clan
+{
+	namespace
+	{
+		const unsigned int index_file_magic = 0x4c564f43;	// "COVL"
+		const int index_file_version = 1;
+
+		// IODevice::read_string_a trusts the length, which a damaged index file cannot be
+		bool read_index_string(IODevice &device, std::string &out_string)
+		{
+			int length = device.read_int32();
+			if (length < 0 || length > device.get_size64() - device.get_position64())
+				return false;
+			out_string.resize(length);
+			return length == 0 || device.read(&out_string[0], length) == length;
+		}
+	}
+
+	OverlayFileSystem::OverlayFileSystem(CaseMode case_mode)
+		: impl(std::make_shared<OverlayFileSystem_Impl>(case_mode))
+	{
+	}
+
+	OverlayFileSystem::~OverlayFileSystem()
+	{
+	}
+
+	OverlayFileSystem::CaseMode OverlayFileSystem::get_case_mode() const
+	{
+		return impl->case_mode;
+	}
+
+	int OverlayFileSystem::get_layer_count() const
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		return (int)impl->layers.size();
+	}
+
+	int OverlayFileSystem::get_file_count() const
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->build_index();
+		return (int)impl->index.size();
+	}
+
+	std::vector<std::string> OverlayFileSystem::get_file_list() const
+	{
+		std::vector<std::string> files;
+		for (auto &entry : impl->get_entries())
+			files.push_back(entry.filename);
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	bool OverlayFileSystem::has_file(const std::string &filename) const
+	{
+		OverlayFileSystem_Impl::IndexEntry entry;
+		return impl->find(filename, entry);
+	}
+
+	IODevice OverlayFileSystem::open_file(const std::string &filename, File::OpenMode mode, unsigned int access, unsigned int share, unsigned int flags) const
+	{
+		return impl->open_file(filename, mode, access, share, flags);
+	}
+
+	FileSystem OverlayFileSystem::get_file_system() const
+	{
+		return FileSystem(new FileSystemProvider_Overlay(impl));
+	}
+
+	void OverlayFileSystem::add_layer(const FileSystem &fs, int priority)
+	{
+		impl->add_layer(fs, priority, fs.get_path());
+	}
+
+	void OverlayFileSystem::add_layer(const std::string &path, bool is_zip_file, int priority)
+	{
+		// Zip providers do not know the path of their archive, so it is passed along for save_index
+		impl->add_layer(FileSystem(path, is_zip_file), priority, path);
+	}
+
+	void OverlayFileSystem::build_index()
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->build_index();
+	}
+
+	void OverlayFileSystem::save_index(IODevice &device) const
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->build_index();
+
+		device.set_little_endian_mode();
+		device.write_uint32(index_file_magic);
+		device.write_int32(index_file_version);
+		device.write_int32(impl->case_mode);
+		device.write_int32((int)impl->layers.size());
+		for (auto &layer : impl->layers)
+		{
+			device.write_string_a(layer.path);
+			device.write_int32(layer.priority);
+		}
+
+		device.write_int32((int)impl->index.size());
+		for (auto &it : impl->index)
+		{
+			device.write_int32(it.second.layer);
+			device.write_string_a(it.second.filename);
+		}
+	}
+
+	bool OverlayFileSystem::load_index(IODevice &device)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->index_built = false;
+		impl->index.clear();
+
+		try
+		{
+			device.set_little_endian_mode();
+			if (device.read_uint32() != index_file_magic || device.read_int32() != index_file_version || device.read_int32() != impl->case_mode)
+				return false;
+
+			int layer_count = device.read_int32();
+			if (layer_count != (int)impl->layers.size())
+				return false;
+			for (auto &layer : impl->layers)
+			{
+				std::string path;
+				if (!read_index_string(device, path) || path != layer.path || device.read_int32() != layer.priority)
+					return false;
+			}
+
+			// Each entry takes at least 8 bytes
+			int file_count = device.read_int32();
+			if (file_count < 0 || file_count > (device.get_size64() - device.get_position64()) / 8)
+				return false;
+			impl->index.reserve(file_count);
+			for (int i = 0; i < file_count; i++)
+			{
+				int layer_index = device.read_int32();
+				std::string filename;
+				if (layer_index < 0 || layer_index >= layer_count || !read_index_string(device, filename))
+				{
+					impl->index.clear();
+					return false;
+				}
+				impl->add_file(layer_index, filename);
+			}
+		}
+		catch (const Exception &)
+		{
+			impl->index.clear();
+			return false;
+		}
+
+		impl->index_built = true;
+		return true;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	std::string OverlayFileSystem_Impl::make_filename(const std::string &filename) const
+	{
+		std::string path = PathHelp::make_absolute("/", filename, PathHelp::path_type_virtual);
+		return path.substr(1);
+	}
+
+	std::string OverlayFileSystem_Impl::make_key(const std::string &filename) const
+	{
+		return case_mode == OverlayFileSystem::case_insensitive ? StringHelp::text_to_lower(filename) : filename;
+	}
+
+	bool OverlayFileSystem_Impl::find(const std::string &filename, IndexEntry &out_entry)
+	{
+		std::string key = make_key(make_filename(filename));
+
+		std::unique_lock<std::mutex> lock(mutex);
+		build_index();
+		auto it = index.find(key);
+		if (it == index.end())
+			return false;
+		out_entry = it->second;
+		return true;
+	}
+
+	std::vector<OverlayFileSystem_Impl::IndexEntry> OverlayFileSystem_Impl::get_entries()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		build_index();
+		std::vector<IndexEntry> entries;
+		entries.reserve(index.size());
+		for (auto &it : index)
+			entries.push_back(it.second);
+		return entries;
+	}
+
+	IODevice OverlayFileSystem_Impl::open_file(const std::string &filename, File::OpenMode mode, unsigned int access, unsigned int share, unsigned int flags)
+	{
+		std::string layer_filename = make_filename(filename);
+		std::string key = make_key(layer_filename);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		build_index();
+		auto it = index.find(key);
+		if (it != index.end())
+		{
+			FileSystem fs = layers[it->second.layer].fs;
+			layer_filename = it->second.filename;
+			lock.unlock();
+			return fs.open_file(layer_filename, mode, access, share, flags);
+		}
+
+		if (mode == File::open_existing || layers.empty())
+			throw Exception(string_format("Unable to open file: %1", filename));
+
+		// New files go to the layer with the highest priority
+		int layer_index = (int)layers.size() - 1;
+		IODevice device = layers[layer_index].fs.open_file(layer_filename, mode, access, share, flags);
+		add_file(layer_index, layer_filename);
+		return device;
+	}
+
+	void OverlayFileSystem_Impl::add_layer(const FileSystem &fs, int priority, const std::string &path)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		// Keep the layers sorted by priority, with layers of equal priority in the order they were added
+		auto it = std::upper_bound(layers.begin(), layers.end(), priority, [](int priority, const Layer &layer) { return priority < layer.priority; });
+		layers.insert(it, Layer(fs, priority, path));
+
+		index_built = false;
+		index.clear();
+	}
+
+	void OverlayFileSystem_Impl::build_index()
+	{
+		if (index_built)
+			return;
+
+		index.clear();
+		for (int i = 0; i < (int)layers.size(); i++)
+			add_layer_files(i);
+		index_built = true;
+	}
+
+	void OverlayFileSystem_Impl::add_layer_files(int layer_index)
+	{
+		// Zip archives already have their file list in memory
+		FileSystemProvider_Zip *zip_provider = dynamic_cast<FileSystemProvider_Zip*>(layers[layer_index].fs.get_provider());
+		if (zip_provider)
+		{
+			ZipArchive archive = zip_provider->get_archive();
+			for (auto &zip_entry : archive.get_file_list())
+			{
+				if (!zip_entry.is_directory())
+					add_file(layer_index, make_filename(zip_entry.get_archive_filename()));
+			}
+		}
+		else
+		{
+			add_directory_files(layer_index, std::string());
+		}
+	}
+
+	void OverlayFileSystem_Impl::add_directory_files(int layer_index, const std::string &directory)
+	{
+		DirectoryListing listing = layers[layer_index].fs.get_directory_listing(directory);
+		while (listing.next())
+		{
+			std::string name = listing.get_filename();
+			if (name == "." || name == "..")
+				continue;
+
+			std::string filename = directory.empty() ? name : directory + "/" + name;
+			if (listing.is_directory())
+				add_directory_files(layer_index, filename);
+			else
+				add_file(layer_index, filename);
+		}
+	}
+
+	void OverlayFileSystem_Impl::add_file(int layer_index, const std::string &filename)
+	{
+		// Layers are added in priority order, so a later layer always shadows an earlier one
+		index[make_key(filename)] = IndexEntry(layer_index, filename);
+	}
+}
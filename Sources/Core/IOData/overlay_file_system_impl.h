@@ -0,0 +1,87 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/IOData/overlay_file_system.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace clan
+{
+	class OverlayFileSystem_Impl
+	{
+	public:
+		struct Layer
+		{
+			Layer(const FileSystem &fs, int priority, const std::string &path) : fs(fs), priority(priority), path(path) { }
+
+			FileSystem fs;
+			int priority;
+			std::string path;
+		};
+
+		struct IndexEntry
+		{
+			IndexEntry(int layer = 0, const std::string &filename = std::string()) : layer(layer), filename(filename) { }
+
+			int layer;
+			std::string filename;
+		};
+
+		OverlayFileSystem_Impl(OverlayFileSystem::CaseMode case_mode) : case_mode(case_mode), index_built(false)
+		{
+		}
+
+		/// \brief Normalizes a path to the form used in the index, without a leading slash
+		std::string make_filename(const std::string &filename) const;
+
+		/// \brief Returns the index key of a normalized path
+		std::string make_key(const std::string &filename) const;
+
+		bool find(const std::string &filename, IndexEntry &out_entry);
+		std::vector<IndexEntry> get_entries();
+
+		IODevice open_file(const std::string &filename, File::OpenMode mode, unsigned int access, unsigned int share, unsigned int flags);
+		void add_layer(const FileSystem &fs, int priority, const std::string &path);
+
+		// These must be called with the mutex locked
+		void build_index();
+		void add_layer_files(int layer_index);
+		void add_directory_files(int layer_index, const std::string &directory);
+		void add_file(int layer_index, const std::string &filename);
+
+		OverlayFileSystem::CaseMode case_mode;
+
+		std::mutex mutex;
+		std::vector<Layer> layers;
+
+		bool index_built;
+		std::unordered_map<std::string, IndexEntry> index;
+	};
+}
@@ -0,0 +1,216 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Signals/signal_queue.h"
+#include <atomic>
+
+namespace clan
+{
+	class SignalQueue_Impl : public std::enable_shared_from_this<SignalQueue_Impl>
+	{
+	public:
+		SignalQueue_Impl(bool has_executor, const TaskExecutor &executor) : has_executor(has_executor), executor(executor), head(nullptr), scheduled(false), pending(nullptr)
+		{
+		}
+
+		~SignalQueue_Impl()
+		{
+			free_nodes(head.exchange(nullptr));
+			free_nodes(pending.load());
+		}
+
+		void post(std::function<void()> func);
+		int process();
+		void clear();
+		bool is_empty() const;
+
+	private:
+		struct Node
+		{
+			Node(std::function<void()> func) : func(std::move(func)), next(nullptr) { }
+
+			std::function<void()> func;
+			Node *next;
+		};
+
+		void drain();
+		void take_posted();
+		static void free_nodes(Node *node);
+
+		bool has_executor;
+		TaskExecutor executor;
+
+		// Posted calls in reverse order, pushed by any thread
+		std::atomic<Node *> head;
+
+		// True while a drain is scheduled or running on the executor
+		std::atomic_bool scheduled;
+
+		// Calls taken from head in posting order. Only the processing thread changes it, but is_empty may read it from any thread.
+		std::atomic<Node *> pending;
+	};
+
+	SignalQueue::SignalQueue()
+		: impl(std::make_shared<SignalQueue_Impl>(false, TaskExecutor()))
+	{
+	}
+
+	SignalQueue::SignalQueue(const TaskExecutor &executor)
+		: impl(std::make_shared<SignalQueue_Impl>(true, executor))
+	{
+	}
+
+	SignalQueue::SignalQueue(const WorkQueue &work_queue)
+		: impl(std::make_shared<SignalQueue_Impl>(true, resume_on_worker(work_queue)))
+	{
+	}
+
+	void SignalQueue::post(std::function<void()> func) const
+	{
+		impl->post(std::move(func));
+	}
+
+	int SignalQueue::process() const
+	{
+		return impl->process();
+	}
+
+	void SignalQueue::clear() const
+	{
+		impl->clear();
+	}
+
+	bool SignalQueue::is_empty() const
+	{
+		return impl->is_empty();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	void SignalQueue_Impl::post(std::function<void()> func)
+	{
+		Node *node = new Node(std::move(func));
+		node->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(node->next, node))
+		{
+		}
+
+		if (has_executor && !scheduled.exchange(true))
+		{
+			std::shared_ptr<SignalQueue_Impl> self = shared_from_this();
+			executor.execute([self]() { self->drain(); });
+		}
+	}
+
+	void SignalQueue_Impl::drain()
+	{
+		while (true)
+		{
+			try
+			{
+				process();
+			}
+			catch (...)
+			{
+				scheduled.store(false);
+				throw;
+			}
+
+			// A post seeing scheduled as true relies on this drain to pick up its call
+			scheduled.store(false);
+			if (is_empty() || scheduled.exchange(true))
+				break;
+		}
+	}
+
+	int SignalQueue_Impl::process()
+	{
+		take_posted();
+
+		int count = 0;
+		while (Node *next = pending.load(std::memory_order_relaxed))
+		{
+			std::unique_ptr<Node> node(next);
+			pending.store(node->next);
+			count++;
+			node->func();
+		}
+		return count;
+	}
+
+	void SignalQueue_Impl::clear()
+	{
+		take_posted();
+		free_nodes(pending.exchange(nullptr));
+	}
+
+	bool SignalQueue_Impl::is_empty() const
+	{
+		return pending.load() == nullptr && head.load() == nullptr;
+	}
+
+	void SignalQueue_Impl::take_posted()
+	{
+		Node *node = head.exchange(nullptr);
+		if (!node)
+			return;
+
+		// Reverse into posting order and put the calls after those left over from an earlier batch
+		Node *list = nullptr;
+		while (node)
+		{
+			Node *next = node->next;
+			node->next = list;
+			list = node;
+			node = next;
+		}
+
+		Node *tail = pending.load(std::memory_order_relaxed);
+		if (tail)
+		{
+			while (tail->next)
+				tail = tail->next;
+			tail->next = list;
+		}
+		else
+		{
+			pending.store(list);
+		}
+	}
+
+	void SignalQueue_Impl::free_nodes(Node *node)
+	{
+		while (node)
+		{
+			Node *next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+}
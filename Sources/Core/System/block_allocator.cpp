@@ -28,7 +28,7 @@
 
 #include "Core/precomp.h"
 #include "API/Core/System/block_allocator.h"
-#include "API/Core/System/databuffer.h"
+#include "API/Core/System/thread_local_storage.h"
 #include "API/Core/Math/cl_math.h"
 #include <vector>
 
@@ -37,35 +37,242 @@ namespace clan
 	class BlockAllocator_Impl
 	{
 	public:
-		std::vector<DataBuffer> blocks;
+		BlockAllocator_Impl(int max_block_size) : max_block_size(max_block_size) { clear_free_lists(); }
+		~BlockAllocator_Impl() { free_blocks(); }
+
+		static const int alignment = 16;
+		static const int max_pooled_size = 1024;
+		static const int num_size_classes = max_pooled_size / alignment;
+
+		struct Block
+		{
+			char *data;
+			int size;
+		};
+
+		struct FreeChunk
+		{
+			FreeChunk *next;
+		};
+
+		void *allocate_from_blocks(int aligned_size);
+		void rewind_free_lists(const BlockAllocator::Marker &marker);
+		bool is_before(const void *data, const BlockAllocator::Marker &marker) const;
+		void clear_free_lists();
+		void free_blocks();
+
+		std::vector<Block> blocks;
+		int block_index = 0;
 		int block_pos = 0;
+		int max_block_size = 0;
+
+		FreeChunk *free_lists[num_size_classes];
+		size_t free_bytes = 0;
+
+		BlockAllocatorStats stats;
 	};
 
-	BlockAllocator::BlockAllocator()
-		: impl(std::make_shared<BlockAllocator_Impl>())
+	class BlockAllocatorThreadData : public ThreadLocalStorageData
 	{
+	public:
+		BlockAllocator allocator;
+	};
+
+	BlockAllocator::BlockAllocator(int max_block_size)
+		: impl(std::make_shared<BlockAllocator_Impl>(max_block_size))
+	{
+	}
+
+	BlockAllocator BlockAllocator::get_thread_allocator()
+	{
+		static const std::string name = "clan::BlockAllocator";
+		std::shared_ptr<ThreadLocalStorageData> data = ThreadLocalStorage::get_variable(name);
+		if (!data)
+		{
+			data = std::make_shared<BlockAllocatorThreadData>();
+			ThreadLocalStorage::set_variable(name, data);
+		}
+		return static_cast<BlockAllocatorThreadData *>(data.get())->allocator;
 	}
 
 	void *BlockAllocator::allocate(int size)
 	{
-		if (impl->blocks.empty())
-			impl->blocks.push_back(DataBuffer(size * 10));
-		DataBuffer &cur = impl->blocks.back();
-		if (impl->block_pos + size <= cur.get_size())
+		int aligned_size = (max(size, 1) + BlockAllocator_Impl::alignment - 1) & ~(BlockAllocator_Impl::alignment - 1);
+
+		void *data = nullptr;
+		if (aligned_size <= BlockAllocator_Impl::max_pooled_size)
 		{
-			void *data = cur.get_data() + impl->block_pos;
-			impl->block_pos += size;
-			return data;
+			BlockAllocator_Impl::FreeChunk *&head = impl->free_lists[aligned_size / BlockAllocator_Impl::alignment - 1];
+			if (head)
+			{
+				data = head;
+				head = head->next;
+				impl->free_bytes -= aligned_size;
+			}
 		}
-		impl->blocks.push_back(DataBuffer(max(cur.get_size() * 2, size)));
-		impl->block_pos = size;
-		return impl->blocks.back().get_data();
+
+		if (!data)
+			data = impl->allocate_from_blocks(aligned_size);
+
+		impl->stats.bytes_used += aligned_size;
+		impl->stats.high_water = max(impl->stats.high_water, impl->stats.bytes_used);
+		return data;
+	}
+
+	void BlockAllocator::deallocate(void *data, int size)
+	{
+		if (!data)
+			return;
+
+		int aligned_size = (max(size, 1) + BlockAllocator_Impl::alignment - 1) & ~(BlockAllocator_Impl::alignment - 1);
+		impl->stats.bytes_used -= aligned_size;
+
+		// Last allocation from the current block can simply be popped
+		if (impl->block_index < (int)impl->blocks.size())
+		{
+			char *block_data = impl->blocks[impl->block_index].data;
+			if (static_cast<char*>(data) + aligned_size == block_data + impl->block_pos && impl->block_pos >= aligned_size)
+			{
+				impl->block_pos -= aligned_size;
+				return;
+			}
+		}
+
+		if (aligned_size <= BlockAllocator_Impl::max_pooled_size)
+		{
+			BlockAllocator_Impl::FreeChunk *&head = impl->free_lists[aligned_size / BlockAllocator_Impl::alignment - 1];
+			BlockAllocator_Impl::FreeChunk *chunk = static_cast<BlockAllocator_Impl::FreeChunk *>(data);
+			chunk->next = head;
+			head = chunk;
+			impl->free_bytes += aligned_size;
+		}
+	}
+
+	BlockAllocator::Marker BlockAllocator::get_marker() const
+	{
+		Marker marker;
+		marker.block_index = impl->block_index;
+		marker.block_pos = impl->block_pos;
+		marker.bytes_used = impl->stats.bytes_used;
+		marker.free_bytes = impl->free_bytes;
+		return marker;
+	}
+
+	void BlockAllocator::rewind(const Marker &marker)
+	{
+		impl->block_index = marker.block_index;
+		impl->block_pos = marker.block_pos;
+		impl->rewind_free_lists(marker);
+
+		// Memory in the free lists is not in use, so whatever was given back since the marker is subtracted
+		impl->stats.bytes_used = marker.bytes_used + marker.free_bytes - impl->free_bytes;
+	}
+
+	void BlockAllocator::reset()
+	{
+		rewind(Marker());
 	}
 
 	void BlockAllocator::free()
 	{
-		impl->blocks.clear();
+		impl->free_blocks();
+		impl->block_index = 0;
 		impl->block_pos = 0;
+		impl->clear_free_lists();
+		impl->stats.bytes_reserved = 0;
+		impl->stats.bytes_used = 0;
+		impl->stats.high_water = 0;
+		impl->stats.num_blocks = 0;
+	}
+
+	BlockAllocatorStats BlockAllocator::get_stats() const
+	{
+		return impl->stats;
+	}
+
+	void *BlockAllocator_Impl::allocate_from_blocks(int aligned_size)
+	{
+		// Look for room in the current block, then in blocks kept from before a rewind
+		while (block_index < (int)blocks.size())
+		{
+			Block &cur = blocks[block_index];
+			if (block_pos + aligned_size <= cur.size)
+			{
+				void *data = cur.data + block_pos;
+				block_pos += aligned_size;
+				return data;
+			}
+
+			if (block_index + 1 == (int)blocks.size())
+				break;
+			block_index++;
+			block_pos = 0;
+		}
+
+		int block_size;
+		if (blocks.empty())
+			block_size = min(aligned_size * 10, max_block_size);
+		else
+			block_size = min(blocks.back().size * 2, max_block_size);
+		block_size = max(block_size, aligned_size);
+
+		Block block;
+		block.data = static_cast<char*>(System::aligned_alloc(block_size, alignment));
+		block.size = block_size;
+		blocks.push_back(block);
+		block_index = (int)blocks.size() - 1;
+		block_pos = aligned_size;
+
+		stats.bytes_reserved += block_size;
+		stats.num_blocks++;
+		stats.heap_allocations++;
+
+		return block.data;
+	}
+
+	void BlockAllocator_Impl::free_blocks()
+	{
+		for (auto &block : blocks)
+			System::aligned_free(block.data);
+		blocks.clear();
+	}
+
+	void BlockAllocator_Impl::rewind_free_lists(const BlockAllocator::Marker &marker)
+	{
+		for (int size_class = 0; size_class < num_size_classes; size_class++)
+		{
+			FreeChunk **link = &free_lists[size_class];
+			while (*link)
+			{
+				if (is_before(*link, marker))
+				{
+					link = &(*link)->next;
+				}
+				else
+				{
+					*link = (*link)->next;
+					free_bytes -= (size_class + 1) * alignment;
+				}
+			}
+		}
+	}
+
+	bool BlockAllocator_Impl::is_before(const void *data, const BlockAllocator::Marker &marker) const
+	{
+		const char *ptr = static_cast<const char *>(data);
+		for (int i = 0; i <= marker.block_index && i < (int)blocks.size(); i++)
+		{
+			if (ptr >= blocks[i].data && ptr < blocks[i].data + blocks[i].size)
+				return i < marker.block_index || ptr < blocks[i].data + marker.block_pos;
+		}
+		return false;
+	}
+
+	void BlockAllocator_Impl::clear_free_lists()
+	{
+		for (auto &head : free_lists)
+			head = nullptr;
+		free_bytes = 0;
 	}
 
 	void *BlockAllocated::operator new(size_t size, BlockAllocator *allocator)
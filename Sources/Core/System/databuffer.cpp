@@ -28,95 +28,199 @@
 
 #include "Core/precomp.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/exception.h"
 #include <string.h>
+#include <limits>
 
 namespace clan
 {
 	class DataBuffer_Impl
 	{
 	public:
-		DataBuffer_Impl() : data(nullptr), size(0), allocated_size(0)
+		static const int alignment = 16;
+		static const int small_size = 64;
+
+		DataBuffer_Impl(char *small_data = nullptr) : data(nullptr), size(0), allocated_size(0), slice_offset(0), small_data(small_data)
 		{
 		}
 
 		~DataBuffer_Impl()
 		{
-			delete[] data;
+			free_data();
+		}
+
+		char *get_data()
+		{
+			return parent ? parent->get_data() + slice_offset : data;
+		}
+
+		void reallocate(uint64_t new_allocated_size);
+
+		void free_data()
+		{
+			if (data && data != small_data)
+				System::aligned_free(data);
+			data = nullptr;
 		}
 
 	public:
 		char *data;
-		unsigned int size;
-		unsigned int allocated_size;
+		uint64_t size;
+		uint64_t allocated_size;
+
+		// Slices reference the data of the root buffer at an offset
+		std::shared_ptr<DataBuffer_Impl> parent;
+		uint64_t slice_offset;
+
+		// Inline storage of DataBuffer_SmallImpl, null for buffers created with a larger size
+		char *small_data;
+	};
+
+	/// \brief Impl with room for a small payload, so tiny buffers only need a single heap allocation
+	class DataBuffer_SmallImpl : public DataBuffer_Impl
+	{
+	public:
+		DataBuffer_SmallImpl() : DataBuffer_Impl(align(storage))
+		{
+		}
+
+	private:
+		// Aligned manually, as alignas is not available on all supported compilers
+		static char *align(char *ptr)
+		{
+			return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~uintptr_t(alignment - 1));
+		}
+
+		char storage[small_size + alignment];
 	};
 
+	void DataBuffer_Impl::reallocate(uint64_t new_allocated_size)
+	{
+		if (new_allocated_size > std::numeric_limits<size_t>::max())
+			throw Exception("DataBuffer size too large for this platform");
+
+		char *old_data = get_data();
+		char *new_data;
+		if (new_allocated_size <= small_size && small_data && !parent && data == nullptr)
+		{
+			new_data = small_data;
+			new_allocated_size = small_size;
+		}
+		else
+		{
+			new_data = static_cast<char*>(System::aligned_alloc((size_t)new_allocated_size, alignment));
+		}
+
+		if (size > 0)
+			memcpy(new_data, old_data, (size_t)size);
+		memset(new_data + size, 0, (size_t)(new_allocated_size - size));
+
+		free_data();
+		parent.reset();
+		slice_offset = 0;
+		data = new_data;
+		allocated_size = new_allocated_size;
+	}
+
 	DataBuffer::DataBuffer()
-		: impl(std::make_shared<DataBuffer_Impl>())
 	{
 	}
 
 	DataBuffer::DataBuffer(unsigned int new_size)
-		: impl(std::make_shared<DataBuffer_Impl>())
 	{
 		set_size(new_size);
 	}
 
 	DataBuffer::DataBuffer(const void *new_data, unsigned int new_size)
-		: impl(std::make_shared<DataBuffer_Impl>())
 	{
 		set_size(new_size);
-		memcpy(impl->data, new_data, new_size);
+		if (new_size > 0)
+			memcpy(impl->data, new_data, new_size);
 	}
 
 	DataBuffer::DataBuffer(const DataBuffer &new_data, unsigned int pos, unsigned int size)
-		: impl(std::make_shared<DataBuffer_Impl>())
 	{
 		set_size(size);
-		memcpy(impl->data, new_data.get_data() + pos, size);
+		if (size > 0)
+			memcpy(impl->data, new_data.get_data() + pos, size);
+	}
+
+	DataBuffer::DataBuffer(const DataBuffer &copy) : impl(copy.impl)
+	{
+	}
+
+	DataBuffer::DataBuffer(DataBuffer &&move) : impl(std::move(move.impl))
+	{
 	}
 
 	DataBuffer::~DataBuffer()
 	{
 	}
 
+	void DataBuffer::create_impl(uint64_t capacity)
+	{
+		if (!impl)
+		{
+			if (capacity <= DataBuffer_Impl::small_size)
+				impl = std::make_shared<DataBuffer_SmallImpl>();
+			else
+				impl = std::make_shared<DataBuffer_Impl>();
+		}
+	}
+
 	char *DataBuffer::get_data()
 	{
-		return impl->data;
+		return impl ? impl->get_data() : nullptr;
 	}
 
 	const char *DataBuffer::get_data() const
 	{
-		return impl->data;
+		return impl ? impl->get_data() : nullptr;
 	}
 
 	unsigned int DataBuffer::get_size() const
 	{
-		return impl->size;
+		uint64_t size = get_size64();
+		if (size > std::numeric_limits<unsigned int>::max())
+			throw Exception("DataBuffer size does not fit 32 bits");
+		return (unsigned int)size;
+	}
+
+	uint64_t DataBuffer::get_size64() const
+	{
+		return impl ? impl->size : 0;
 	}
 
 	unsigned int DataBuffer::get_capacity() const
 	{
-		return impl->allocated_size;
+		uint64_t capacity = get_capacity64();
+		return capacity > std::numeric_limits<unsigned int>::max() ? std::numeric_limits<unsigned int>::max() : (unsigned int)capacity;
+	}
+
+	uint64_t DataBuffer::get_capacity64() const
+	{
+		return impl ? impl->allocated_size : 0;
 	}
 
 	char &DataBuffer::operator[](int i)
 	{
-		return impl->data[i];
+		return get_data()[i];
 	}
 
 	const char &DataBuffer::operator[](int i) const
 	{
-		return impl->data[i];
+		return get_data()[i];
 	}
 
 	char &DataBuffer::operator[](unsigned int i)
 	{
-		return impl->data[i];
+		return get_data()[i];
 	}
 
 	const char &DataBuffer::operator[](unsigned int i) const
 	{
-		return impl->data[i];
+		return get_data()[i];
 	}
 
 	DataBuffer &DataBuffer::operator =(const DataBuffer &copy)
@@ -125,39 +229,70 @@ namespace clan
 		return *this;
 	}
 
-	void DataBuffer::set_size(unsigned int new_size)
+	DataBuffer &DataBuffer::operator =(DataBuffer &&move)
 	{
-		if (new_size > impl->allocated_size)
+		impl = std::move(move.impl);
+		return *this;
+	}
+
+	bool DataBuffer::is_slice() const
+	{
+		return impl && impl->parent;
+	}
+
+	DataBuffer DataBuffer::slice(uint64_t pos, uint64_t size) const
+	{
+		uint64_t buffer_size = get_size64();
+		if (pos > buffer_size || size > buffer_size - pos)
+			throw Exception("DataBuffer slice out of range");
+
+		DataBuffer result;
+		if (size == 0)
+			return result;
+
+		result.impl = std::make_shared<DataBuffer_Impl>();
+		if (impl->parent)
 		{
-			char *old_data = impl->data;
-			impl->data = new char[new_size];
-			memcpy(impl->data, old_data, impl->size);
-			delete[] old_data;
-			memset(impl->data + impl->size, 0, new_size - impl->size);
-			impl->size = new_size;
-			impl->allocated_size = new_size;
+			result.impl->parent = impl->parent;
+			result.impl->slice_offset = impl->slice_offset + pos;
 		}
 		else
 		{
-			impl->size = new_size;
+			result.impl->parent = impl;
+			result.impl->slice_offset = pos;
 		}
+		result.impl->size = size;
+		result.impl->allocated_size = size;
+		return result;
+	}
+
+	void DataBuffer::set_size(unsigned int new_size)
+	{
+		set_size64(new_size);
+	}
+
+	void DataBuffer::set_size64(uint64_t new_size)
+	{
+		create_impl(new_size);
+		if (new_size > impl->allocated_size)
+			impl->reallocate(new_size);
+		impl->size = new_size;
 	}
 
 	void DataBuffer::set_capacity(unsigned int new_capacity)
 	{
+		set_capacity64(new_capacity);
+	}
+
+	void DataBuffer::set_capacity64(uint64_t new_capacity)
+	{
+		create_impl(new_capacity);
 		if (new_capacity > impl->allocated_size)
-		{
-			char *old_data = impl->data;
-			impl->data = new char[new_capacity];
-			memcpy(impl->data, old_data, impl->size);
-			delete[] old_data;
-			memset(impl->data + impl->size, 0, new_capacity - impl->size);
-			impl->allocated_size = new_capacity;
-		}
+			impl->reallocate(new_capacity);
 	}
 
 	bool DataBuffer::is_null() const
 	{
-		return impl->size == 0;
+		return get_size64() == 0;
 	}
 }
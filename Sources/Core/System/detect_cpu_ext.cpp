@@ -181,6 +181,11 @@ namespace clan
 			__cpuid((int*)cpuinfo, 0x80000001);
 			return ((cpuinfo[2] & (1 << 16)) != 0);
 		}
+		else if (ext == pclmulqdq)
+		{
+			__cpuid((int*)cpuinfo, 0x1);
+			return ((cpuinfo[2] & (1 << 1)) != 0);
+		}
 		return false;
 	}
 
@@ -30,11 +30,28 @@
 #include "API/Core/System/game_time.h"
 #include "API/Core/System/system.h"
 #include "game_time_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
 
 namespace clan
 {
+	class GameTimeSystemClock : public GameTimeClock
+	{
+	public:
+		uint64_t get_microseconds() override { return System::get_microseconds(); }
+		void sleep(int milliseconds) override { System::sleep(milliseconds); }
+		void yield() override { std::this_thread::yield(); }
+	};
+
 	GameTime::GameTime(int ticks_per_second, int max_updates_per_second)
-		: impl(std::make_shared<GameTime_Impl>(ticks_per_second, max_updates_per_second))
+		: impl(std::make_shared<GameTime_Impl>(ticks_per_second, max_updates_per_second, std::make_shared<GameTimeSystemClock>()))
+	{
+		reset();
+	}
+
+	GameTime::GameTime(int ticks_per_second, int max_updates_per_second, const std::shared_ptr<GameTimeClock> &clock)
+		: impl(std::make_shared<GameTime_Impl>(ticks_per_second, max_updates_per_second, clock))
 	{
 		reset();
 	}
@@ -69,11 +86,47 @@ namespace clan
 		return impl->tick_interpolation_time;
 	}
 
+	uint64_t GameTime::get_total_ticks() const
+	{
+		return impl->total_ticks;
+	}
+
+	int GameTime::get_max_ticks_per_update() const
+	{
+		return impl->max_ticks_per_update;
+	}
+
 	float GameTime::get_updates_per_second() const
 	{
 		return impl->current_fps;
 	}
 
+	float GameTime::get_frame_time_percentile(float percentile) const
+	{
+		return GameTime_Impl::get_percentile(impl->get_sorted_frame_times(), percentile);
+	}
+
+	GameTimeFrameStats GameTime::get_frame_time_stats() const
+	{
+		GameTimeFrameStats stats;
+		std::vector<uint64_t> frame_times = impl->get_sorted_frame_times();
+		if (frame_times.empty())
+			return stats;
+
+		uint64_t total = 0;
+		for (uint64_t frame_time : frame_times)
+			total += frame_time;
+
+		stats.num_frames = (int)frame_times.size();
+		stats.average_ms = total / (1000.0f * frame_times.size());
+		stats.min_ms = frame_times.front() / 1000.0f;
+		stats.max_ms = frame_times.back() / 1000.0f;
+		stats.p50_ms = GameTime_Impl::get_percentile(frame_times, 0.50f);
+		stats.p95_ms = GameTime_Impl::get_percentile(frame_times, 0.95f);
+		stats.p99_ms = GameTime_Impl::get_percentile(frame_times, 0.99f);
+		return stats;
+	}
+
 	float GameTime::get_current_time() const
 	{
 		double timer = ((double)(impl->current_time - impl->start_time)) / 1000000.0;
@@ -97,44 +150,105 @@ namespace clan
 
 	void GameTime_Impl::update()
 	{
+		if (frame_duration)	// Handle max fps
+			wait_for_next_frame();
+
 		uint64_t last_time = current_time;
 
-		current_time = System::get_microseconds();
+		current_time = clock->get_microseconds();
 
 		if (current_time < last_time)		// Old cpu's may report time travelling on early multicore processors (iirc)
 			last_time = current_time;
 
-		uint64_t ticks_per_microsecond = 1000000 / ticks_per_second;
-		uint64_t current_tick = (current_time - start_time) / ticks_per_microsecond;
-
-		ticks_elapsed = current_tick - last_tick;
-		time_elapsed_ms = (int)((time_elapsed_ms_microsecond_adjustment + current_time - last_time) / 1000);
-		time_elapsed_ms_microsecond_adjustment = (current_time - last_time) % 1000;
-		time_elapsed = (float)((current_time - last_time) / (double)1000000);
-		tick_interpolation_time = (float)(((current_time - start_time) % ticks_per_microsecond) / (double)ticks_per_microsecond);
+		uint64_t delta_time = current_time - last_time;
 
-		last_tick = current_tick;
+		tick_accumulator += delta_time * ticks_per_second;
+		uint64_t ticks = tick_accumulator / 1000000;
+		tick_accumulator %= 1000000;
+		if (max_ticks_per_update && ticks > (uint64_t)max_ticks_per_update)
+			ticks = max_ticks_per_update;	// Discard the time beyond the limit
 
-		if (min_update_time_ms)	// Handle max fps
-			process_max_fps();
+		ticks_elapsed = (int)ticks;
+		total_ticks += ticks;
+		time_elapsed_ms = (int)((time_elapsed_ms_microsecond_adjustment + delta_time) / 1000);
+		time_elapsed_ms_microsecond_adjustment = (time_elapsed_ms_microsecond_adjustment + delta_time) % 1000;
+		time_elapsed = (float)(delta_time / (double)1000000);
+		tick_interpolation_time = (float)(tick_accumulator / (double)1000000);
 
+		add_frame_time(delta_time);
 		calculate_fps();
 	}
 
-	void GameTime_Impl::process_max_fps()
+	void GameTime_Impl::wait_for_next_frame()
 	{
-		update_time_ms += time_elapsed_ms;
+		uint64_t now = clock->get_microseconds();
+		if (next_frame_time > now + frame_duration)	// Clock went backwards
+			next_frame_time = now;
+
+		// Sleep while the remaining time is comfortably above what the OS tends to oversleep
+		while (next_frame_time > now && next_frame_time - now > sleep_overshoot + 1000)
+		{
+			uint64_t sleep_time = next_frame_time - now - sleep_overshoot;
+			clock->sleep((int)(sleep_time / 1000));
+			uint64_t after_sleep = clock->get_microseconds();
+			if (after_sleep < now)
+				break;
+
+			uint64_t slept = after_sleep - now;
+			uint64_t requested = (sleep_time / 1000) * 1000;
+			uint64_t overshoot = slept > requested ? slept - requested : 0;
+			sleep_overshoot = std::max(overshoot, sleep_overshoot * 7 / 8);
+			now = after_sleep;
+		}
 
-		int diff = min_update_time_ms - update_time_ms;
-		if (diff > 0)	// We have spare cpu cycles
+		// Spin the last part for sub-millisecond accuracy
+		while (next_frame_time > now)
 		{
-			System::sleep(diff);
+			clock->yield();
+			now = clock->get_microseconds();
 		}
 
-		update_time_ms -= min_update_time_ms;		// Subtract by expected time for next iteration
+		// Keep the frame cadence, unless more than a frame behind
+		next_frame_time += frame_duration;
+		if (next_frame_time <= now)
+			next_frame_time = now + frame_duration;
+	}
 
-		if (update_time_ms > min_update_time_ms)		// Limit slow updates, to give a chance to catch up
-			update_time_ms = min_update_time_ms;
+	void GameTime_Impl::add_frame_time(uint64_t frame_time)
+	{
+		if ((int)frame_times.size() < max_frame_times)
+		{
+			frame_times.push_back(frame_time);
+		}
+		else
+		{
+			frame_times[frame_times_pos] = frame_time;
+			frame_times_pos = (frame_times_pos + 1) % max_frame_times;
+		}
+	}
+
+	std::vector<uint64_t> GameTime_Impl::get_sorted_frame_times() const
+	{
+		std::vector<uint64_t> sorted = frame_times;
+		std::sort(sorted.begin(), sorted.end());
+		return sorted;
+	}
+
+	float GameTime_Impl::get_percentile(const std::vector<uint64_t> &sorted_frame_times, float percentile)
+	{
+		if (sorted_frame_times.empty())
+			return 0.0f;
+
+		// Nearest rank
+		int rank = (int)std::ceil(std::max(std::min(percentile, 1.0f), 0.0f) * sorted_frame_times.size());
+		int index = std::max(rank - 1, 0);
+		return sorted_frame_times[index] / 1000.0f;
+	}
+
+	void GameTime_Impl::set_max_updates_per_second(int max_updates_per_second)
+	{
+		frame_duration = max_updates_per_second > 0 ? 1000000 / max_updates_per_second : 0;
+		next_frame_time = 0;
 	}
 
 	void GameTime_Impl::calculate_fps()
@@ -159,21 +273,32 @@ namespace clan
 		impl->reset();
 	}
 
+	void GameTime::set_max_ticks_per_update(int max_ticks)
+	{
+		impl->max_ticks_per_update = max_ticks;
+	}
+
+	void GameTime::set_max_updates_per_second(int max_updates_per_second)
+	{
+		impl->set_max_updates_per_second(max_updates_per_second);
+	}
+
 	void GameTime_Impl::reset()
 	{
-		start_time = System::get_microseconds();
+		start_time = clock->get_microseconds();
 		current_time = start_time;
-		last_tick = 0;
 		time_elapsed = 0.0f;
 		ticks_elapsed = 0;
+		total_ticks = 0;
+		tick_accumulator = 0;
 		tick_interpolation_time = 0.0f;
 		time_elapsed_ms = 0;
 		time_elapsed_ms_microsecond_adjustment = 0;
 		num_updates_in_2_seconds = 0;
 		update_frame_start_time = current_time;
 		current_fps = 0;
-		num_updates_in_2_seconds = 0;
-		update_time_ms = 0;
-
+		next_frame_time = 0;
+		frame_times.clear();
+		frame_times_pos = 0;
 	}
 }
@@ -28,43 +28,61 @@
 
 #pragma once
 
+#include "API/Core/System/game_time.h"
+#include <memory>
+#include <vector>
+
 namespace clan
 {
 	class GameTime_Impl
 	{
 	public:
-		GameTime_Impl(int ticks_per_second, int max_updates_per_second) : ticks_per_second(ticks_per_second)
+		GameTime_Impl(int ticks_per_second, int max_updates_per_second, const std::shared_ptr<GameTimeClock> &clock) : ticks_per_second(ticks_per_second), clock(clock)
 		{
-			if (max_updates_per_second)
-				min_update_time_ms = (1000 / max_updates_per_second);
+			set_max_updates_per_second(max_updates_per_second);
 		}
 
 		void update();
 		void reset();
+		void set_max_updates_per_second(int max_updates_per_second);
+		std::vector<uint64_t> get_sorted_frame_times() const;
+		static float get_percentile(const std::vector<uint64_t> &sorted_frame_times, float percentile);
 
 		int ticks_per_second = 0;
-		int min_update_time_ms = 0;
+		int max_ticks_per_update = 0;
 
 		uint64_t start_time = 0;
 		uint64_t current_time = 0;
 
-		uint64_t last_tick = 0;
-
 		float time_elapsed = 0.0f;
 		int time_elapsed_ms = 0;
 		int time_elapsed_ms_microsecond_adjustment = 0;		// Amount of Microseconds lost due to time_elapsed_ms rounding (to add on for next time)
 
 		int ticks_elapsed = 0;
+		uint64_t total_ticks = 0;
 		float tick_interpolation_time = 0.0f;
 
 		uint64_t update_frame_start_time = 0;
 		float current_fps = 0.0f;
 
+		std::shared_ptr<GameTimeClock> clock;
+
 	private:
 		void calculate_fps();
-		void process_max_fps();
+		void wait_for_next_frame();
+		void add_frame_time(uint64_t frame_time);
+
+		// Time not yet consumed by ticks, in microseconds multiplied by ticks_per_second to keep it exact
+		uint64_t tick_accumulator = 0;
+
+		uint64_t frame_duration = 0;		// Minimum time between updates in microseconds, 0 = Unlimited
+		uint64_t next_frame_time = 0;
+		uint64_t sleep_overshoot = 1000;	// Estimate of how much longer than requested clock->sleep takes
+
+		static const int max_frame_times = 1024;
+		std::vector<uint64_t> frame_times;
+		int frame_times_pos = 0;
 
 		int num_updates_in_2_seconds = 0;
-		int update_time_ms = 0;
 	};
 }
@@ -0,0 +1,156 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/parallel_for.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/System/system.h"
+#include "API/Core/Math/cl_math.h"
+#include "setup_core.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace clan
+{
+	class ParallelForState
+	{
+	public:
+		ParallelForState(int begin, int end, int grain_size, int num_chunks, const std::function<void(int, int)> &func)
+			: begin(begin), end(end), grain_size(grain_size), num_chunks(num_chunks), func(func), next_chunk(0), chunks_done(0), failed(false)
+		{
+		}
+
+		// Processes chunks until there are none left to claim
+		void process_chunks()
+		{
+			int chunks_processed = 0;
+			while (true)
+			{
+				int chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+				if (chunk >= num_chunks)
+					break;
+
+				if (!failed.load(std::memory_order_relaxed))
+				{
+					int chunk_begin = begin + chunk * grain_size;
+					int chunk_end = clan::min(chunk_begin + grain_size, end);
+					try
+					{
+						func(chunk_begin, chunk_end);
+					}
+					catch (...)
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						if (!exception)
+							exception = std::current_exception();
+						failed = true;
+					}
+				}
+				chunks_processed++;
+			}
+
+			if (chunks_processed > 0 && chunks_done.fetch_add(chunks_processed) + chunks_processed == num_chunks)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				lock.unlock();
+				finished_event.notify_all();
+			}
+		}
+
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			finished_event.wait(lock, [&]() { return chunks_done.load() == num_chunks; });
+			if (exception)
+				std::rethrow_exception(exception);
+		}
+
+	private:
+		int begin, end, grain_size, num_chunks;
+		const std::function<void(int, int)> &func;
+
+		std::atomic_int next_chunk;
+		std::atomic_int chunks_done;
+		std::atomic_bool failed;
+		std::exception_ptr exception;
+		std::mutex mutex;
+		std::condition_variable finished_event;
+	};
+
+	class ParallelForWorkItem : public WorkItem
+	{
+	public:
+		ParallelForWorkItem(const std::shared_ptr<ParallelForState> &state) : state(state) { }
+
+		void process_work() override { state->process_chunks(); }
+
+	private:
+		std::shared_ptr<ParallelForState> state;
+	};
+
+	int parallel_grain_size(int begin, int end, int grain_size)
+	{
+		if (grain_size > 0)
+			return grain_size;
+
+		// Aim for a few chunks per core so the load balances when some chunks are slower than others
+		int num_cores = System::get_num_cores();
+		return clan::max((end - begin) / (num_cores * 4), 1);
+	}
+
+	void parallel_for(int begin, int end, int grain_size, const std::function<void(int chunk_begin, int chunk_end)> &func)
+	{
+		if (end <= begin)
+			return;
+
+		grain_size = parallel_grain_size(begin, end, grain_size);
+		int num_chunks = (end - begin + grain_size - 1) / grain_size;
+		int num_cores = System::get_num_cores();
+		if (num_chunks == 1 || num_cores == 1)
+		{
+			func(begin, end);
+			return;
+		}
+
+		WorkQueue &queue = SetupCore::get_parallel_work_queue();
+
+		// Helpers that start after all chunks were claimed return immediately. The state is shared so
+		// they stay valid after this function has returned, but func is only called while we wait.
+		auto state = std::make_shared<ParallelForState>(begin, end, grain_size, num_chunks, func);
+		int num_helpers = clan::min(num_chunks - 1, num_cores - 1);
+		for (int i = 0; i < num_helpers; i++)
+			queue.queue(new ParallelForWorkItem(state));
+
+		state->process_chunks();
+		state->wait();
+
+		// Nobody else calls process_work_completed on the shared queue. Reclaim the finished helper items here.
+		queue.process_work_completed();
+	}
+}
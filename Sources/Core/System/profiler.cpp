@@ -0,0 +1,225 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/thread_local_storage.h"
+#include "API/Core/IOData/file.h"
+#include "API/Core/IOData/iodevice.h"
+#include "API/Core/JSON/json_value.h"
+#include "API/Core/Text/string_help.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <map>
+#include <algorithm>
+
+namespace clan
+{
+	class ProfilerZoneRecord
+	{
+	public:
+		const char *name;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	class ProfilerThread
+	{
+	public:
+		ProfilerThread(int size, int thread_index, const std::string &name) : zones(size), count(0), thread_index(thread_index), name(name)
+		{
+		}
+
+		std::vector<ProfilerZoneRecord> zones;
+		std::atomic<uint64_t> count;
+		int thread_index;
+		std::string name;
+	};
+
+	class Profiler_Impl
+	{
+	public:
+		static ProfilerThread *get_thread(uint64_t session);
+
+		static std::mutex mutex;
+		static std::atomic_bool active;
+		static std::atomic<uint64_t> session;
+		static std::atomic_int active_writers;
+		static int zones_per_thread;
+		static uint64_t start_time;
+		static std::vector<std::unique_ptr<ProfilerThread>> threads;
+		static std::map<std::thread::id, std::string> thread_names;
+
+		static cl_tls_variable ProfilerThread *current_thread;
+		static cl_tls_variable uint64_t current_session;
+	};
+
+	std::mutex Profiler_Impl::mutex;
+	std::atomic_bool Profiler_Impl::active(false);
+	std::atomic<uint64_t> Profiler_Impl::session(0);
+	std::atomic_int Profiler_Impl::active_writers(0);
+	int Profiler_Impl::zones_per_thread = 0;
+	uint64_t Profiler_Impl::start_time = 0;
+	std::vector<std::unique_ptr<ProfilerThread>> Profiler_Impl::threads;
+	std::map<std::thread::id, std::string> Profiler_Impl::thread_names;
+	cl_tls_variable ProfilerThread *Profiler_Impl::current_thread = nullptr;
+	cl_tls_variable uint64_t Profiler_Impl::current_session = 0;
+
+	void Profiler::start(int zones_per_thread)
+	{
+		// Wait for threads still recording into the buffers of the previous recording
+		Profiler_Impl::active.store(false);
+		Profiler_Impl::session++;
+		while (Profiler_Impl::active_writers.load() != 0)
+			std::this_thread::yield();
+
+		std::unique_lock<std::mutex> lock(Profiler_Impl::mutex);
+		Profiler_Impl::threads.clear();
+		Profiler_Impl::zones_per_thread = std::max(zones_per_thread, 1);
+		Profiler_Impl::start_time = System::get_microseconds();
+		Profiler_Impl::active.store(true);
+	}
+
+	void Profiler::stop()
+	{
+		Profiler_Impl::active.store(false);
+	}
+
+	bool Profiler::is_active()
+	{
+		return Profiler_Impl::active.load(std::memory_order_relaxed);
+	}
+
+	void Profiler::set_thread_name(const std::string &name)
+	{
+		std::unique_lock<std::mutex> lock(Profiler_Impl::mutex);
+		Profiler_Impl::thread_names[std::this_thread::get_id()] = name;
+		if (Profiler_Impl::current_thread && Profiler_Impl::current_session == Profiler_Impl::session.load())
+			Profiler_Impl::current_thread->name = name;
+	}
+
+	void Profiler::add_zone(const char *name, uint64_t begin_microseconds, uint64_t end_microseconds)
+	{
+		Profiler_Impl::active_writers++;
+		if (Profiler_Impl::active.load())
+		{
+			ProfilerThread *thread = Profiler_Impl::get_thread(Profiler_Impl::session.load());
+			uint64_t index = thread->count.load(std::memory_order_relaxed);
+			ProfilerZoneRecord &record = thread->zones[index % thread->zones.size()];
+			record.name = name;
+			record.begin = begin_microseconds;
+			record.end = end_microseconds;
+			thread->count.store(index + 1, std::memory_order_release);
+		}
+		Profiler_Impl::active_writers--;
+	}
+
+	std::string Profiler::get_chrome_trace()
+	{
+		std::unique_lock<std::mutex> lock(Profiler_Impl::mutex);
+
+		JsonValue events = JsonValue::array();
+		for (auto &thread : Profiler_Impl::threads)
+		{
+			JsonValue thread_name = JsonValue::object();
+			thread_name.prop("name") = JsonValue::string("thread_name");
+			thread_name.prop("ph") = JsonValue::string("M");
+			thread_name.prop("pid") = JsonValue::number(1);
+			thread_name.prop("tid") = JsonValue::number(thread->thread_index);
+			thread_name.prop("args") = JsonValue::object();
+			thread_name.prop("args").prop("name") = JsonValue::string(thread->name);
+			events.items().push_back(thread_name);
+
+			uint64_t count = thread->count.load(std::memory_order_acquire);
+			uint64_t size = thread->zones.size();
+			for (uint64_t index = count > size ? count - size : 0; index < count; index++)
+			{
+				const ProfilerZoneRecord &record = thread->zones[index % size];
+				JsonValue zone = JsonValue::object();
+				zone.prop("name") = JsonValue::string(record.name);
+				zone.prop("cat") = JsonValue::string("clanlib");
+				zone.prop("ph") = JsonValue::string("X");
+				zone.prop("ts") = JsonValue::number((double)(int64_t)(record.begin - Profiler_Impl::start_time));
+				zone.prop("dur") = JsonValue::number((double)(record.end - record.begin));
+				zone.prop("pid") = JsonValue::number(1);
+				zone.prop("tid") = JsonValue::number(thread->thread_index);
+				events.items().push_back(zone);
+			}
+		}
+
+		JsonValue trace = JsonValue::object();
+		trace.prop("traceEvents") = events;
+		trace.prop("displayTimeUnit") = JsonValue::string("ms");
+		return trace.to_json();
+	}
+
+	void Profiler::save_chrome_trace(IODevice &device)
+	{
+		std::string json = get_chrome_trace();
+		device.write(json.data(), (int)json.length());
+	}
+
+	void Profiler::save_chrome_trace(const std::string &filename)
+	{
+		File file(filename, File::create_always, File::access_write);
+		save_chrome_trace(file);
+	}
+
+	ProfilerThread *Profiler_Impl::get_thread(uint64_t session)
+	{
+		if (current_session != session)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			auto it = thread_names.find(std::this_thread::get_id());
+			std::string name = it != thread_names.end() ? it->second : "Thread " + StringHelp::int_to_text((int)threads.size() + 1);
+			threads.push_back(std::unique_ptr<ProfilerThread>(new ProfilerThread(zones_per_thread, (int)threads.size() + 1, name)));
+			current_thread = threads.back().get();
+			current_session = session;
+		}
+		return current_thread;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	ProfileZone::ProfileZone(const char *name) : name(nullptr), begin_microseconds(0)
+	{
+		if (Profiler::is_active())
+		{
+			this->name = name;
+			begin_microseconds = System::get_microseconds();
+		}
+	}
+
+	ProfileZone::~ProfileZone()
+	{
+		if (name)
+			Profiler::add_zone(name, begin_microseconds, System::get_microseconds());
+	}
+}
@@ -32,6 +32,7 @@
 #include "API/Core/System/exception.h"
 #include "API/Core/System/thread_local_storage.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
 #include "tls_instance.h"
 #include "API/Core/Math/cl_math.h"
 
@@ -67,6 +68,16 @@ namespace clan
 		instance.module_core = clan::make_unique<SetupCore_Impl>();
 	}
 
+	WorkQueue &SetupCore::get_parallel_work_queue()
+	{
+		std::lock_guard<std::recursive_mutex> lock(instance.mutex);
+
+		if (!instance.parallel_work_queue)
+			instance.parallel_work_queue = clan::make_unique<WorkQueue>(false, true);
+
+		return *instance.parallel_work_queue;
+	}
+
 	SetupCore_Impl::SetupCore_Impl()
 	{
 #ifndef CL_DISABLE_SSE2
@@ -37,6 +37,7 @@
 namespace clan
 {
 	class ThreadLocalStorage_Instance;
+	class WorkQueue;
 
 	class SetupModule
 	{
@@ -63,6 +64,9 @@ namespace clan
 		std::unique_ptr<SetupModule> module_sound;
 		std::unique_ptr<SetupModule> module_gl;
 		std::unique_ptr<SetupModule> module_d3d;
+
+		static WorkQueue &get_parallel_work_queue();
+		std::unique_ptr<WorkQueue> parallel_work_queue;
 	};
 
 }
@@ -0,0 +1,319 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/task_graph.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/System/exception.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace clan
+{
+	class TaskGraphTask_Impl
+	{
+	public:
+		std::function<void()> func;
+		std::weak_ptr<TaskGraph_Impl> graph;
+
+		// Unfinished predecessors, plus one until the task has been released
+		std::atomic_int pending;
+
+		std::mutex mutex;
+		bool released = false;
+		bool finished = false;
+		std::vector<std::shared_ptr<TaskGraphTask_Impl>> successors;
+	};
+
+	class TaskGraph_Impl : public std::enable_shared_from_this<TaskGraph_Impl>
+	{
+	public:
+		TaskGraph_Impl(const WorkQueue &queue) : queue(queue), tasks_unfinished(0), failed(false) { }
+
+		std::shared_ptr<TaskGraphTask_Impl> create_task(const std::function<void()> &func);
+		void add_edge(const std::shared_ptr<TaskGraphTask_Impl> &predecessor, const std::shared_ptr<TaskGraphTask_Impl> &successor);
+		void release(const std::shared_ptr<TaskGraphTask_Impl> &task);
+		void run();
+		void wait();
+
+		void schedule(const std::shared_ptr<TaskGraphTask_Impl> &task);
+		void process_task(const std::shared_ptr<TaskGraphTask_Impl> &task);
+
+		WorkQueue queue;
+		std::function<void()> func_finished;
+
+		std::mutex mutex;
+		std::condition_variable finished_event;
+		bool running = false;
+		std::vector<std::shared_ptr<TaskGraphTask_Impl>> unreleased_tasks;
+		std::atomic_int tasks_unfinished;
+		std::exception_ptr exception;
+		std::atomic_bool failed;
+	};
+
+	class TaskGraphWorkItem : public WorkItem
+	{
+	public:
+		TaskGraphWorkItem(const std::shared_ptr<TaskGraph_Impl> &graph, const std::shared_ptr<TaskGraphTask_Impl> &task) : graph(graph), task(task) { }
+
+		void process_work() override
+		{
+			graph->process_task(task);
+
+			// The item waits for process_work_completed after this, and the graph owns the queue. Holding on to the graph
+			// would keep the graph, the queue and its threads alive until the queue is pumped.
+			task.reset();
+			graph.reset();
+		}
+
+	private:
+		std::shared_ptr<TaskGraph_Impl> graph;
+		std::shared_ptr<TaskGraphTask_Impl> task;
+	};
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	TaskGraphTask::TaskGraphTask()
+	{
+	}
+
+	TaskGraphTask::TaskGraphTask(const std::shared_ptr<TaskGraphTask_Impl> &impl) : impl(impl)
+	{
+	}
+
+	bool TaskGraphTask::is_finished() const
+	{
+		if (!impl)
+			return false;
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		return impl->finished;
+	}
+
+	void TaskGraphTask::depends_on(const TaskGraphTask &predecessor)
+	{
+		std::shared_ptr<TaskGraph_Impl> graph = impl ? impl->graph.lock() : std::shared_ptr<TaskGraph_Impl>();
+		if (!graph || !predecessor.impl)
+			throw Exception("TaskGraphTask is null");
+		graph->add_edge(predecessor.impl, impl);
+	}
+
+	TaskGraphTask TaskGraphTask::then(const std::function<void()> &func)
+	{
+		std::shared_ptr<TaskGraph_Impl> graph = impl ? impl->graph.lock() : std::shared_ptr<TaskGraph_Impl>();
+		if (!graph)
+			throw Exception("TaskGraphTask is null");
+
+		std::shared_ptr<TaskGraphTask_Impl> task = graph->create_task(func);
+		graph->add_edge(impl, task);
+		graph->release(task);
+		return TaskGraphTask(task);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	TaskGraph::TaskGraph(const WorkQueue &queue) : impl(std::make_shared<TaskGraph_Impl>(queue))
+	{
+	}
+
+	TaskGraph::~TaskGraph()
+	{
+	}
+
+	TaskGraphTask TaskGraph::add(const std::function<void()> &func)
+	{
+		std::shared_ptr<TaskGraphTask_Impl> task = impl->create_task(func);
+		impl->release(task);
+		return TaskGraphTask(task);
+	}
+
+	TaskGraphTask TaskGraph::add(const std::function<void()> &func, const std::vector<TaskGraphTask> &predecessors)
+	{
+		std::shared_ptr<TaskGraphTask_Impl> task = impl->create_task(func);
+		for (const auto &predecessor : predecessors)
+		{
+			if (!predecessor.impl)
+				throw Exception("TaskGraphTask is null");
+			impl->add_edge(predecessor.impl, task);
+		}
+		impl->release(task);
+		return TaskGraphTask(task);
+	}
+
+	void TaskGraph::run()
+	{
+		impl->run();
+	}
+
+	bool TaskGraph::is_finished() const
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		return impl->running && impl->tasks_unfinished == 0;
+	}
+
+	void TaskGraph::wait()
+	{
+		impl->wait();
+	}
+
+	std::function<void()> &TaskGraph::func_finished()
+	{
+		return impl->func_finished;
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<TaskGraphTask_Impl> TaskGraph_Impl::create_task(const std::function<void()> &func)
+	{
+		auto task = std::make_shared<TaskGraphTask_Impl>();
+		task->func = func;
+		task->graph = shared_from_this();
+		task->pending = 1;
+		++tasks_unfinished;
+		return task;
+	}
+
+	void TaskGraph_Impl::add_edge(const std::shared_ptr<TaskGraphTask_Impl> &predecessor, const std::shared_ptr<TaskGraphTask_Impl> &successor)
+	{
+		std::unique_lock<std::mutex> successor_lock(successor->mutex);
+		if (successor->released)
+			throw Exception("Cannot add a dependency to a task that has already been released");
+		successor_lock.unlock();
+
+		std::unique_lock<std::mutex> predecessor_lock(predecessor->mutex);
+		if (!predecessor->finished)
+		{
+			++successor->pending;
+			predecessor->successors.push_back(successor);
+		}
+	}
+
+	void TaskGraph_Impl::release(const std::shared_ptr<TaskGraphTask_Impl> &task)
+	{
+		std::unique_lock<std::mutex> graph_lock(mutex);
+		if (!running)
+		{
+			// Released by run()
+			unreleased_tasks.push_back(task);
+			return;
+		}
+		graph_lock.unlock();
+
+		std::unique_lock<std::mutex> task_lock(task->mutex);
+		task->released = true;
+		task_lock.unlock();
+
+		if (--task->pending == 0)
+			schedule(task);
+	}
+
+	void TaskGraph_Impl::run()
+	{
+		std::unique_lock<std::mutex> graph_lock(mutex);
+		if (running)
+			return;
+		running = true;
+		std::vector<std::shared_ptr<TaskGraphTask_Impl>> tasks;
+		tasks.swap(unreleased_tasks);
+		bool empty_graph = tasks.empty();
+		graph_lock.unlock();
+
+		for (auto &task : tasks)
+		{
+			std::unique_lock<std::mutex> task_lock(task->mutex);
+			task->released = true;
+		}
+
+		for (auto &task : tasks)
+		{
+			if (--task->pending == 0)
+				schedule(task);
+		}
+
+		if (empty_graph)
+		{
+			finished_event.notify_all();
+			if (func_finished)
+				queue.work_completed(func_finished);
+		}
+	}
+
+	void TaskGraph_Impl::wait()
+	{
+		std::unique_lock<std::mutex> graph_lock(mutex);
+		finished_event.wait(graph_lock, [&]() { return running && tasks_unfinished == 0; });
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	void TaskGraph_Impl::schedule(const std::shared_ptr<TaskGraphTask_Impl> &task)
+	{
+		queue.queue(new TaskGraphWorkItem(shared_from_this(), task));
+	}
+
+	void TaskGraph_Impl::process_task(const std::shared_ptr<TaskGraphTask_Impl> &task)
+	{
+		if (!failed)
+		{
+			try
+			{
+				task->func();
+			}
+			catch (...)
+			{
+				std::unique_lock<std::mutex> graph_lock(mutex);
+				if (!exception)
+					exception = std::current_exception();
+				failed = true;
+			}
+		}
+		task->func = std::function<void()>();
+
+		std::unique_lock<std::mutex> task_lock(task->mutex);
+		task->finished = true;
+		std::vector<std::shared_ptr<TaskGraphTask_Impl>> successors;
+		successors.swap(task->successors);
+		task_lock.unlock();
+
+		for (auto &successor : successors)
+		{
+			if (--successor->pending == 0)
+				schedule(successor);
+		}
+
+		if (--tasks_unfinished == 0)
+		{
+			// Lock to make sure a waiting thread is either before its predicate check or inside wait
+			std::unique_lock<std::mutex> graph_lock(mutex);
+			graph_lock.unlock();
+			finished_event.notify_all();
+			if (func_finished)
+				queue.work_completed(func_finished);
+		}
+	}
+}
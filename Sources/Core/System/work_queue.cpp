@@ -1,214 +1,702 @@
-/*
-**  ClanLib SDK
-**  Copyright (c) 1997-2016 The ClanLib Team
-**
-**  This software is provided 'as-is', without any express or implied
-**  warranty.  In no event will the authors be held liable for any damages
-**  arising from the use of this software.
-**
-**  Permission is granted to anyone to use this software for any purpose,
-**  including commercial applications, and to alter it and redistribute it
-**  freely, subject to the following restrictions:
-**
-**  1. The origin of this software must not be misrepresented; you must not
-**     claim that you wrote the original software. If you use this software
-**     in a product, an acknowledgment in the product documentation would be
-**     appreciated but is not required.
-**  2. Altered source versions must be plainly marked as such, and must not be
-**     misrepresented as being the original software.
-**  3. This notice may not be removed or altered from any source distribution.
-**
-**  Note: Some of the libraries ClanLib may link to may have additional
-**  requirements or restrictions.
-**
-**  File Author(s):
-**
-**    Magnus Norddahl
-*/
-
-#include "Core/precomp.h"
-#include "API/Core/System/work_queue.h"
-#include "API/Core/System/system.h"
-#include <algorithm>
-#include "API/Core/Math/cl_math.h"
-#include <atomic>
-#include <thread>
-#include <condition_variable>
-
-namespace clan
-{
-	class WorkItemProcess : public WorkItem
-	{
-	public:
-		WorkItemProcess(const std::function<void()> &func) : func(func) { }
-
-		void process_work() override { func(); }
-
-	private:
-		std::function<void()> func;
-	};
-
-	class WorkItemWorkCompleted : public WorkItem
-	{
-	public:
-		WorkItemWorkCompleted(const std::function<void()> &func) : func(func) { }
-
-		void process_work() override { }
-		void work_completed() override { func(); }
-
-	private:
-		std::function<void()> func;
-	};
-
-	class WorkQueue_Impl
-	{
-	public:
-		WorkQueue_Impl(bool serial_queue);
-		~WorkQueue_Impl();
-
-		void queue(WorkItem *item); // transfers ownership
-		void work_completed(WorkItem *item); // transfers ownership
-
-		int get_items_queued() const { return items_queued; }
-
-		void process_work_completed();
-
-	private:
-		void worker_main();
-
-		bool serial_queue = false;
-		std::vector<std::thread> threads;
-		std::mutex mutex;
-		std::condition_variable worker_event;
-		bool stop_flag = false;
-		std::vector<WorkItem *> queued_items;
-		std::vector<WorkItem *> finished_items;
-		std::atomic_int items_queued;
-	};
-
-	WorkQueue::WorkQueue(bool serial_queue)
-		: impl(std::make_shared<WorkQueue_Impl>(serial_queue))
-	{
-	}
-
-	WorkQueue::~WorkQueue()
-	{
-	}
-
-	void WorkQueue::queue(WorkItem *item) // transfers ownership
-	{
-		impl->queue(item);
-	}
-
-	void WorkQueue::queue(const std::function<void()> &func)
-	{
-		impl->queue(new WorkItemProcess(func));
-	}
-
-	void WorkQueue::work_completed(const std::function<void()> &func)
-	{
-		impl->work_completed(new WorkItemWorkCompleted(func));
-	}
-
-	int WorkQueue::get_items_queued() const
-	{
-		return impl->get_items_queued();
-	}
-
-	void WorkQueue::process_work_completed()
-	{
-		impl->process_work_completed();
-	}
-
-	/////////////////////////////////////////////////////////////////////////////
-
-	WorkQueue_Impl::WorkQueue_Impl(bool serial_queue)
-		: serial_queue(serial_queue)
-	{
-	}
-
-	WorkQueue_Impl::~WorkQueue_Impl()
-	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		stop_flag = true;
-		mutex_lock.unlock();
-		worker_event.notify_all();
-
-		for (auto & elem : threads)
-			elem.join();
-		for (auto & elem : queued_items)
-			delete elem;
-		for (auto & elem : finished_items)
-			delete elem;
-	}
-
-	void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
-	{
-		if (threads.empty())
-		{
-			int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
-			for (int i = 0; i < num_cores; i++)
-			{
-				threads.push_back(std::thread(&WorkQueue_Impl::worker_main, this));
-			}
-		}
-
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		queued_items.push_back(item);
-		++items_queued;
-		mutex_lock.unlock();
-		worker_event.notify_one();
-	}
-
-	void WorkQueue_Impl::work_completed(WorkItem *item) // transfers ownership
-	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		finished_items.push_back(item);
-		++items_queued;
-	}
-
-	void WorkQueue_Impl::process_work_completed()
-	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		std::vector<WorkItem *> items;
-		items.swap(finished_items);
-		mutex_lock.unlock();
-		for (size_t i = 0; i < items.size(); i++)
-		{
-			try
-			{
-				items[i]->work_completed();
-			}
-			catch (...)
-			{
-				mutex_lock.lock();
-				finished_items.insert(finished_items.begin(), items.begin() + i, items.end());
-				throw;
-			}
-			delete items[i];
-			--items_queued;
-		}
-	}
-
-	void WorkQueue_Impl::worker_main()
-	{
-		while (true)
-		{
-			std::unique_lock<std::mutex> mutex_lock(mutex);
-			worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued_items.empty(); });
-
-			if (stop_flag)
-				break;
-
-			WorkItem *item = queued_items.front();
-			queued_items.erase(queued_items.begin());
-			mutex_lock.unlock();
-
-			item->process_work();
-
-			mutex_lock.lock();
-			finished_items.push_back(item);
-			mutex_lock.unlock();
-		}
-	}
-}
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/thread_local_storage.h"
+#include <algorithm>
+#include "API/Core/Math/cl_math.h"
+#include "work_stealing_deque.h"
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+
+namespace clan
+{
+	class WorkHandle_Impl
+	{
+	public:
+		enum State { state_queued, state_running, state_finished, state_cancelled };
+
+		WorkHandle_Impl(const std::function<void()> &func, WorkPriority priority) : func(func), state(state_queued), priority((int)priority), generation(0) { }
+
+		void run();
+		void set_state(State new_state);
+
+		std::function<void()> func;
+		std::atomic_int state;
+		std::atomic_int priority;
+
+		// Incremented each time the work is re-queued in another lane. Only the entry of the current generation may run it.
+		std::atomic_int generation;
+
+		std::weak_ptr<WorkQueue_Impl> queue;
+
+		std::mutex mutex;
+		std::condition_variable finished_event;
+		std::exception_ptr exception;
+	};
+
+	class WorkItemProcess final : public WorkItem
+	{
+	public:
+		WorkItemProcess(const std::shared_ptr<WorkHandle_Impl> &handle, int generation) : handle(handle), generation(generation) { }
+
+		~WorkItemProcess()
+		{
+			// Work still queued when the WorkQueue is destroyed never runs. Release anyone waiting for it.
+			int expected = WorkHandle_Impl::state_queued;
+			if (handle->generation.load() == generation && handle->state.compare_exchange_strong(expected, WorkHandle_Impl::state_cancelled))
+				handle->set_state(WorkHandle_Impl::state_cancelled);
+		}
+
+		void process_work() override
+		{
+			// Stale entries left behind by set_priority are skipped. The state change makes sure only one entry runs the function.
+			// The lock keeps set_priority from making this entry stale after it started running.
+			std::unique_lock<std::mutex> lock(handle->mutex);
+			if (handle->generation.load() != generation)
+				return;
+			int expected = WorkHandle_Impl::state_queued;
+			if (!handle->state.compare_exchange_strong(expected, WorkHandle_Impl::state_running))
+				return;
+			lock.unlock();
+			handle->run();
+		}
+
+		/// \brief Returns false for stale and cancelled entries, which were removed from the queued items count already
+		bool is_counted() const
+		{
+			return handle->generation.load() == generation && handle->state.load() != WorkHandle_Impl::state_cancelled;
+		}
+
+	private:
+		std::shared_ptr<WorkHandle_Impl> handle;
+		int generation;
+	};
+
+	class WorkItemWorkCompleted : public WorkItem
+	{
+	public:
+		WorkItemWorkCompleted(const std::function<void()> &func) : func(func) { }
+
+		void process_work() override { }
+		void work_completed() override { func(); }
+
+	private:
+		std::function<void()> func;
+	};
+
+	class WorkQueue_Impl;
+
+	class WorkQueueWorker
+	{
+	public:
+		WorkQueue_Impl *owner = nullptr;
+		std::thread::id thread_id;
+		WorkStealingDeque<WorkItem *> deque;
+
+		// Items queued from threads not owning the deque
+		std::mutex inbox_mutex;
+		std::vector<WorkItem *> inbox;
+		std::atomic_int inbox_size;
+
+		unsigned int random_seed = 0;
+	};
+
+	class WorkQueue_Impl
+	{
+	public:
+		WorkQueue_Impl(bool serial_queue, bool work_stealing);
+		~WorkQueue_Impl();
+
+		void queue(WorkItem *item, WorkPriority priority); // transfers ownership
+		void work_completed(WorkItem *item); // transfers ownership
+
+		int get_items_queued() const { return items_queued; }
+
+		/// \brief Removes an entry that will never run from the queued items count
+		void uncount_item() { --items_queued; }
+
+		void process_work_completed();
+
+		/// \brief Deleter of the shared impl
+		///
+		/// The last reference may be released by a work item running on one of the worker threads, such as one
+		/// owning a TaskGraph. That thread can not join itself, so the workers are stopped and the last one to exit deletes the impl.
+		static void destroy(WorkQueue_Impl *impl);
+
+	private:
+		void start_threads();
+		void worker_main();
+		bool is_worker_thread() const;
+		void thread_exit();
+
+		void queue_stealing(WorkItem *item, WorkPriority priority);
+		WorkItem *pop_lane(int lane);
+		void worker_stealing_main(WorkQueueWorker *worker);
+		WorkItem *find_work(WorkQueueWorker *worker);
+		WorkItem *steal_work(WorkQueueWorker *worker);
+		void add_finished_item(WorkItem *item);
+		static bool is_counted(WorkItem *item);
+
+		bool serial_queue = false;
+		bool work_stealing = false;
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable worker_event;
+		bool stop_flag = false;
+		std::deque<WorkItem *> queued_items[3]; // one lane per WorkPriority
+		int num_queued_items = 0;
+		std::vector<WorkItem *> finished_items;
+		std::atomic_int items_queued;
+		std::atomic_int threads_running;
+		std::atomic_bool delete_on_exit;
+
+		// Work stealing mode
+		std::vector<std::unique_ptr<WorkQueueWorker>> workers;
+		std::atomic_uint next_inbox;
+		std::atomic_int items_pending;
+		std::atomic_int workers_sleeping;
+		std::atomic_bool stop_stealing;
+		std::mutex finished_mutex;
+
+		// High and low priority lanes shared by all workers in work stealing mode
+		std::mutex lanes_mutex;
+		std::atomic_int lane_sizes[3];
+
+		static cl_tls_variable WorkQueueWorker *current_worker;
+	};
+
+	cl_tls_variable WorkQueueWorker *WorkQueue_Impl::current_worker = nullptr;
+
+	WorkQueue::WorkQueue(bool serial_queue, bool work_stealing)
+		: impl(new WorkQueue_Impl(serial_queue, work_stealing), &WorkQueue_Impl::destroy)
+	{
+	}
+
+	WorkQueue::~WorkQueue()
+	{
+	}
+
+	void WorkQueue::queue(WorkItem *item, WorkPriority priority) // transfers ownership
+	{
+		impl->queue(item, priority);
+	}
+
+	WorkHandle WorkQueue::queue(const std::function<void()> &func, WorkPriority priority)
+	{
+		auto handle = std::make_shared<WorkHandle_Impl>(func, priority);
+		handle->queue = impl;
+		impl->queue(new WorkItemProcess(handle, 0), priority);
+		return WorkHandle(handle);
+	}
+
+	void WorkQueue::work_completed(const std::function<void()> &func)
+	{
+		impl->work_completed(new WorkItemWorkCompleted(func));
+	}
+
+	int WorkQueue::get_items_queued() const
+	{
+		return impl->get_items_queued();
+	}
+
+	void WorkQueue::process_work_completed()
+	{
+		impl->process_work_completed();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	WorkHandle::WorkHandle()
+	{
+	}
+
+	WorkHandle::WorkHandle(const std::shared_ptr<WorkHandle_Impl> &impl) : impl(impl)
+	{
+	}
+
+	bool WorkHandle::is_finished() const
+	{
+		return impl && impl->state == WorkHandle_Impl::state_finished;
+	}
+
+	bool WorkHandle::is_cancelled() const
+	{
+		return impl && impl->state == WorkHandle_Impl::state_cancelled;
+	}
+
+	WorkPriority WorkHandle::get_priority() const
+	{
+		return impl ? (WorkPriority)impl->priority.load() : WorkPriority::normal;
+	}
+
+	bool WorkHandle::cancel()
+	{
+		if (!impl)
+			return false;
+
+		int expected = WorkHandle_Impl::state_queued;
+		if (!impl->state.compare_exchange_strong(expected, WorkHandle_Impl::state_cancelled))
+			return false;
+
+		impl->set_state(WorkHandle_Impl::state_cancelled);
+
+		std::shared_ptr<WorkQueue_Impl> queue = impl->queue.lock();
+		if (queue)
+			queue->uncount_item();
+		return true;
+	}
+
+	void WorkHandle::wait()
+	{
+		if (!impl)
+			return;
+
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->finished_event.wait(lock, [&]() { int state = impl->state; return state == WorkHandle_Impl::state_finished || state == WorkHandle_Impl::state_cancelled; });
+		if (impl->exception)
+			std::rethrow_exception(impl->exception);
+	}
+
+	void WorkHandle::set_priority(WorkPriority priority)
+	{
+		if (!impl)
+			return;
+
+		std::shared_ptr<WorkQueue_Impl> queue = impl->queue.lock();
+		if (!queue)
+			return;
+
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		if (impl->state != WorkHandle_Impl::state_queued || impl->priority == (int)priority)
+			return;
+
+		// The entry in the old lane stays queued but becomes stale
+		impl->priority = (int)priority;
+		int generation = ++impl->generation;
+		lock.unlock();
+
+		queue->queue(new WorkItemProcess(impl, generation), priority);
+		queue->uncount_item();
+	}
+
+	void WorkHandle_Impl::run()
+	{
+		try
+		{
+			func();
+		}
+		catch (...)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			exception = std::current_exception();
+		}
+		func = std::function<void()>();
+		set_state(state_finished);
+	}
+
+	void WorkHandle_Impl::set_state(State new_state)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		state = new_state;
+		lock.unlock();
+		finished_event.notify_all();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	WorkQueue_Impl::WorkQueue_Impl(bool serial_queue, bool work_stealing)
+		: serial_queue(serial_queue), work_stealing(work_stealing && !serial_queue), items_queued(0), threads_running(0), delete_on_exit(false), next_inbox(0), items_pending(0), workers_sleeping(0), stop_stealing(false)
+	{
+		for (auto & elem : lane_sizes)
+			elem = 0;
+	}
+
+	WorkQueue_Impl::~WorkQueue_Impl()
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		stop_flag = true;
+		stop_stealing = true;
+		mutex_lock.unlock();
+		worker_event.notify_all();
+
+		for (auto & elem : threads)
+		{
+			if (elem.joinable())
+				elem.join();
+		}
+		for (auto & lane : queued_items)
+		{
+			for (auto & elem : lane)
+				delete elem;
+		}
+		for (auto & elem : finished_items)
+			delete elem;
+		for (auto & worker : workers)
+		{
+			WorkItem *item = nullptr;
+			while (worker->deque.steal(item))
+				delete item;
+			for (auto & elem : worker->inbox)
+				delete elem;
+		}
+	}
+
+	void WorkQueue_Impl::destroy(WorkQueue_Impl *impl)
+	{
+		if (!impl->is_worker_thread())
+		{
+			delete impl;
+			return;
+		}
+
+		std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+		impl->stop_flag = true;
+		impl->stop_stealing = true;
+		impl->delete_on_exit = true;
+		mutex_lock.unlock();
+		impl->worker_event.notify_all();
+
+		for (auto & elem : impl->threads)
+			elem.detach();
+	}
+
+	bool WorkQueue_Impl::is_worker_thread() const
+	{
+		std::thread::id id = std::this_thread::get_id();
+		for (auto & elem : threads)
+		{
+			if (elem.get_id() == id)
+				return true;
+		}
+		return false;
+	}
+
+	void WorkQueue_Impl::thread_exit()
+	{
+		// Nothing may touch the impl after the last worker deleted it
+		if (--threads_running == 0 && delete_on_exit)
+			delete this;
+	}
+
+	void WorkQueue_Impl::start_threads()
+	{
+		int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
+
+		if (work_stealing)
+		{
+			for (int i = 0; i < num_cores; i++)
+			{
+				std::unique_ptr<WorkQueueWorker> worker(new WorkQueueWorker());
+				worker->owner = this;
+				worker->inbox_size = 0;
+				worker->random_seed = 0x9e3779b9u * (i + 1);
+				workers.push_back(std::move(worker));
+			}
+			for (int i = 0; i < num_cores; i++)
+			{
+				++threads_running;
+				threads.push_back(std::thread(&WorkQueue_Impl::worker_stealing_main, this, workers[i].get()));
+			}
+		}
+		else
+		{
+			for (int i = 0; i < num_cores; i++)
+			{
+				++threads_running;
+				threads.push_back(std::thread(&WorkQueue_Impl::worker_main, this));
+			}
+		}
+	}
+
+	void WorkQueue_Impl::queue(WorkItem *item, WorkPriority priority) // transfers ownership
+	{
+		if (threads.empty())
+			start_threads();
+
+		if (work_stealing)
+		{
+			++items_queued;
+			queue_stealing(item, priority);
+			return;
+		}
+
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		queued_items[(int)priority].push_back(item);
+		num_queued_items++;
+		++items_queued;
+		mutex_lock.unlock();
+		worker_event.notify_one();
+	}
+
+	void WorkQueue_Impl::work_completed(WorkItem *item) // transfers ownership
+	{
+		std::unique_lock<std::mutex> mutex_lock(work_stealing ? finished_mutex : mutex);
+		finished_items.push_back(item);
+		++items_queued;
+	}
+
+	void WorkQueue_Impl::process_work_completed()
+	{
+		std::unique_lock<std::mutex> mutex_lock(work_stealing ? finished_mutex : mutex);
+		std::vector<WorkItem *> items;
+		items.swap(finished_items);
+		mutex_lock.unlock();
+		for (size_t i = 0; i < items.size(); i++)
+		{
+			bool counted = is_counted(items[i]);
+			try
+			{
+				items[i]->work_completed();
+			}
+			catch (...)
+			{
+				mutex_lock.lock();
+				finished_items.insert(finished_items.begin(), items.begin() + i, items.end());
+				throw;
+			}
+			delete items[i];
+			if (counted)
+				--items_queued;
+		}
+	}
+
+	bool WorkQueue_Impl::is_counted(WorkItem *item)
+	{
+		WorkItemProcess *process = dynamic_cast<WorkItemProcess *>(item);
+		return !process || process->is_counted();
+	}
+
+	void WorkQueue_Impl::worker_main()
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			worker_event.wait(mutex_lock, [&]() { return stop_flag || num_queued_items > 0; });
+
+			if (stop_flag)
+				break;
+
+			WorkItem *item = nullptr;
+			for (auto & lane : queued_items)
+			{
+				if (!lane.empty())
+				{
+					item = lane.front();
+					lane.pop_front();
+					break;
+				}
+			}
+			num_queued_items--;
+			mutex_lock.unlock();
+
+			item->process_work();
+
+			mutex_lock.lock();
+			finished_items.push_back(item);
+			mutex_lock.unlock();
+		}
+
+		thread_exit();
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+	// Work stealing mode:
+	//
+	// Each worker owns a lock-free deque. Items queued from a worker thread of this
+	// queue are pushed onto its own deque without locking. Items queued from any other
+	// thread are distributed round-robin over per-worker inboxes, so the producers only
+	// contend with the one worker they hand the item to. Idle workers steal from the
+	// top of a random victim's deque before going to sleep.
+	//
+	// Only normal priority items go through the deques. High and low priority items
+	// are kept in shared lanes that are checked before and after the deques.
+
+	void WorkQueue_Impl::queue_stealing(WorkItem *item, WorkPriority priority)
+	{
+		// Count the item before it becomes visible, so a worker that takes it can never see a negative count
+		items_pending.fetch_add(1, std::memory_order_seq_cst);
+
+		WorkQueueWorker *worker = current_worker;
+		if (priority != WorkPriority::normal)
+		{
+			std::unique_lock<std::mutex> lanes_lock(lanes_mutex);
+			queued_items[(int)priority].push_back(item);
+			lane_sizes[(int)priority].store((int)queued_items[(int)priority].size(), std::memory_order_release);
+		}
+		else if (worker && worker->owner == this && worker->thread_id == std::this_thread::get_id())
+		{
+			worker->deque.push(item);
+		}
+		else
+		{
+			unsigned int index = next_inbox.fetch_add(1, std::memory_order_relaxed) % workers.size();
+			WorkQueueWorker *target = workers[index].get();
+			std::unique_lock<std::mutex> inbox_lock(target->inbox_mutex);
+			target->inbox.push_back(item);
+			target->inbox_size.store((int)target->inbox.size(), std::memory_order_release);
+		}
+
+		if (workers_sleeping.load(std::memory_order_seq_cst) > 0)
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			mutex_lock.unlock();
+			worker_event.notify_one();
+		}
+	}
+
+	void WorkQueue_Impl::worker_stealing_main(WorkQueueWorker *worker)
+	{
+		worker->thread_id = std::this_thread::get_id();
+		current_worker = worker;
+
+		while (!stop_stealing.load(std::memory_order_relaxed))
+		{
+			WorkItem *item = find_work(worker);
+			if (item)
+			{
+				items_pending.fetch_sub(1, std::memory_order_relaxed);
+				item->process_work();
+				add_finished_item(item);
+				continue;
+			}
+
+			if (items_pending.load(std::memory_order_seq_cst) > 0)
+			{
+				// Work exists but is in flight or was just taken by another worker
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			workers_sleeping.fetch_add(1, std::memory_order_seq_cst);
+			worker_event.wait(mutex_lock, [&]() { return stop_flag || items_pending.load(std::memory_order_seq_cst) > 0; });
+			workers_sleeping.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		current_worker = nullptr;
+		thread_exit();
+	}
+
+	WorkItem *WorkQueue_Impl::pop_lane(int lane)
+	{
+		if (lane_sizes[lane].load(std::memory_order_acquire) == 0)
+			return nullptr;
+
+		std::unique_lock<std::mutex> lanes_lock(lanes_mutex);
+		if (queued_items[lane].empty())
+			return nullptr;
+
+		WorkItem *item = queued_items[lane].front();
+		queued_items[lane].pop_front();
+		lane_sizes[lane].store((int)queued_items[lane].size(), std::memory_order_release);
+		return item;
+	}
+
+	WorkItem *WorkQueue_Impl::find_work(WorkQueueWorker *worker)
+	{
+		WorkItem *item = pop_lane((int)WorkPriority::high);
+		if (item)
+			return item;
+
+		if (worker->deque.pop(item))
+			return item;
+
+		if (worker->inbox_size.load(std::memory_order_acquire) > 0)
+		{
+			std::unique_lock<std::mutex> inbox_lock(worker->inbox_mutex);
+			std::vector<WorkItem *> items;
+			items.swap(worker->inbox);
+			worker->inbox_size.store(0, std::memory_order_release);
+			inbox_lock.unlock();
+
+			if (!items.empty())
+			{
+				// Push in reverse so the bottom of the deque holds the oldest item
+				for (size_t i = items.size() - 1; i > 0; i--)
+					worker->deque.push(items[i]);
+				return items[0];
+			}
+		}
+
+		item = steal_work(worker);
+		if (item)
+			return item;
+
+		return pop_lane((int)WorkPriority::low);
+	}
+
+	WorkItem *WorkQueue_Impl::steal_work(WorkQueueWorker *worker)
+	{
+		size_t num_workers = workers.size();
+		if (num_workers < 2)
+			return nullptr;
+
+		// xorshift random victim selection
+		unsigned int x = worker->random_seed;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		worker->random_seed = x;
+
+		size_t start = x % num_workers;
+		for (size_t i = 0; i < num_workers; i++)
+		{
+			WorkQueueWorker *victim = workers[(start + i) % num_workers].get();
+			if (victim == worker)
+				continue;
+
+			WorkItem *item = nullptr;
+			if (victim->deque.steal(item))
+				return item;
+
+			if (victim->inbox_size.load(std::memory_order_acquire) > 0)
+			{
+				std::unique_lock<std::mutex> inbox_lock(victim->inbox_mutex, std::try_to_lock);
+				if (inbox_lock.owns_lock() && !victim->inbox.empty())
+				{
+					item = victim->inbox.front();
+					victim->inbox.erase(victim->inbox.begin());
+					victim->inbox_size.store((int)victim->inbox.size(), std::memory_order_release);
+					return item;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	void WorkQueue_Impl::add_finished_item(WorkItem *item)
+	{
+		std::unique_lock<std::mutex> mutex_lock(finished_mutex);
+		finished_items.push_back(item);
+	}
+}
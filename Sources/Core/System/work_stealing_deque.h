@@ -0,0 +1,159 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace clan
+{
+	/// \brief Lock-free work stealing deque (Chase-Lev)
+	///
+	/// Only the owning thread may call push and pop. Any thread may call steal.
+	/// Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Nardelli 2013).
+	template<typename T>
+	class WorkStealingDeque
+	{
+	public:
+		WorkStealingDeque(int initial_size = 256) : top(0), bottom(0), array(new Array(initial_size))
+		{
+		}
+
+		~WorkStealingDeque()
+		{
+			delete array.load(std::memory_order_relaxed);
+			for (auto & elem : retired_arrays)
+				delete elem;
+		}
+
+		/// \brief Adds an item to the bottom of the deque (owner thread only)
+		void push(T item)
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+			Array *a = array.load(std::memory_order_relaxed);
+			if (b - t > a->size - 1)
+				a = grow(a, b, t);
+			a->put(b, item);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		/// \brief Removes an item from the bottom of the deque (owner thread only)
+		bool pop(T &out_item)
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			Array *a = array.load(std::memory_order_relaxed);
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			if (t > b)
+			{
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			out_item = a->get(b);
+			if (t == b)
+			{
+				// Last item - race against thieves
+				bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		/// \brief Removes an item from the top of the deque (any thread)
+		///
+		/// Returns false if the deque was empty or another thread won the race for the item.
+		bool steal(T &out_item)
+		{
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+			if (t >= b)
+				return false;
+
+			Array *a = array.load(std::memory_order_acquire);
+			T item = a->get(t);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return false;
+
+			out_item = item;
+			return true;
+		}
+
+		/// \brief Returns an estimate of the number of items in the deque
+		int64_t size_estimate() const
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_relaxed);
+			return b > t ? b - t : 0;
+		}
+
+	private:
+		struct Array
+		{
+			Array(int64_t size) : size(size), mask(size - 1), items(new std::atomic<T>[size]) { }
+			~Array() { delete[] items; }
+
+			T get(int64_t index) const { return items[index & mask].load(std::memory_order_relaxed); }
+			void put(int64_t index, T item) { items[index & mask].store(item, std::memory_order_relaxed); }
+
+			int64_t size;
+			int64_t mask;
+			std::atomic<T> *items;
+		};
+
+		Array *grow(Array *a, int64_t b, int64_t t)
+		{
+			Array *new_array = new Array(a->size * 2);
+			for (int64_t i = t; i < b; i++)
+				new_array->put(i, a->get(i));
+
+			// Thieves may still be reading from the old array. Keep it alive until the deque is destroyed.
+			retired_arrays.push_back(a);
+			array.store(new_array, std::memory_order_release);
+			return new_array;
+		}
+
+		// Keep top (thieves) and bottom (owner) on separate cache lines
+		std::atomic<int64_t> top;
+		char padding[64];
+		std::atomic<int64_t> bottom;
+		std::atomic<Array *> array;
+		std::vector<Array *> retired_arrays;
+
+		WorkStealingDeque(const WorkStealingDeque &) = delete;
+		WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+	};
+}
@@ -0,0 +1,443 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/Text/async_logger.h"
+#include "API/Core/Text/logger.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/System/thread_local_storage.h"
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+namespace clan
+{
+	class AsyncLogRecord
+	{
+	public:
+		std::string type;
+		std::string text;
+		std::function<std::string()> format_func;
+	};
+
+	/// \brief Ring of log records written by a single thread and read by the logging thread
+	class AsyncLogRing
+	{
+	public:
+		AsyncLogRing(int size) : records(size), abandoned(false), head(0), tail(0)
+		{
+		}
+
+		std::vector<AsyncLogRecord> records;
+
+		// Set when the owning thread exits or moves to a newer logger. The logging thread then drains and frees the ring.
+		std::atomic_bool abandoned;
+
+		// Next record the logging thread reads
+		std::atomic<uint64_t> head;
+
+		// Keep head and tail in separate cache lines
+		char padding[64];
+
+		// Next record the owning thread writes
+		std::atomic<uint64_t> tail;
+	};
+
+	/// \brief Keeps the ring of each thread alive until the thread exits, and then marks it as abandoned
+	class AsyncLogThreadRing
+	{
+	public:
+		AsyncLogThreadRing()
+		{
+#ifdef WIN32
+			key = FlsAlloc(&AsyncLogThreadRing::thread_exit);
+#else
+			pthread_key_create(&key, &AsyncLogThreadRing::thread_exit);
+#endif
+		}
+
+		// The key is never deleted, as threads may still exit after static destruction
+
+		void set(const std::shared_ptr<AsyncLogRing> &ring)
+		{
+#ifdef WIN32
+			auto holder = static_cast<std::shared_ptr<AsyncLogRing> *>(FlsGetValue(key));
+#else
+			auto holder = static_cast<std::shared_ptr<AsyncLogRing> *>(pthread_getspecific(key));
+#endif
+			if (holder)
+			{
+				(*holder)->abandoned.store(true, std::memory_order_release);
+				*holder = ring;
+			}
+			else
+			{
+				holder = new std::shared_ptr<AsyncLogRing>(ring);
+#ifdef WIN32
+				FlsSetValue(key, holder);
+#else
+				pthread_setspecific(key, holder);
+#endif
+			}
+		}
+
+	private:
+#ifdef WIN32
+		static void WINAPI thread_exit(void *value)
+#else
+		static void thread_exit(void *value)
+#endif
+		{
+			auto holder = static_cast<std::shared_ptr<AsyncLogRing> *>(value);
+			if (holder)
+			{
+				(*holder)->abandoned.store(true, std::memory_order_release);
+				delete holder;
+			}
+		}
+
+#ifdef WIN32
+		DWORD key;
+#else
+		pthread_key_t key;
+#endif
+	};
+
+	class AsyncLogger_Impl
+	{
+	public:
+		AsyncLogger_Impl(int buffer_size, AsyncLogOverflow overflow, int flush_interval_ms)
+			: events_logged(0), events_dropped(0), events_blocked(0), batches_written(0),
+			buffer_size(buffer_size), overflow(overflow), flush_interval_ms(flush_interval_ms), id(++next_id), wakeup_requested(false)
+		{
+		}
+
+		void log(const std::string &type, const std::string &text, std::function<std::string()> &format_func);
+		void flush();
+		void stop();
+
+		static bool log_active(const std::string &type, const std::string &text, std::function<std::string()> &format_func);
+
+		std::thread thread;
+		std::thread::id thread_id;
+
+		std::atomic<uint64_t> events_logged;
+		std::atomic<uint64_t> events_dropped;
+		std::atomic<uint64_t> events_blocked;
+		std::atomic<uint64_t> batches_written;
+
+		static std::atomic<AsyncLogger_Impl *> active;
+		static std::atomic_int active_callers;
+
+	private:
+		void thread_main();
+		AsyncLogRing *get_ring();
+		void wakeup();
+		void write_pending();
+
+		const int buffer_size;
+		const AsyncLogOverflow overflow;
+		const int flush_interval_ms;
+		const uint64_t id;
+
+		std::mutex mutex;
+		std::condition_variable wakeup_event;
+		std::condition_variable flushed_event;
+		bool stop_flag = false;
+		bool wakeup_flag = false;
+		uint64_t flush_requested = 0;
+		uint64_t flush_completed = 0;
+		std::vector<std::shared_ptr<AsyncLogRing>> rings;
+		std::atomic_bool wakeup_requested;
+
+		// Only used by the logging thread
+		std::vector<AsyncLogRing *> current_rings;
+		std::vector<AsyncLogRing *> drained_rings;
+		std::vector<LogEntry> batch;
+
+		static std::atomic<uint64_t> next_id;
+		static cl_tls_variable AsyncLogRing *current_ring;
+		static cl_tls_variable uint64_t current_ring_id;
+		static AsyncLogThreadRing thread_ring;
+
+		friend class AsyncLogger;
+	};
+
+	std::atomic<AsyncLogger_Impl *> AsyncLogger_Impl::active(nullptr);
+	std::atomic_int AsyncLogger_Impl::active_callers(0);
+	std::atomic<uint64_t> AsyncLogger_Impl::next_id(0);
+	cl_tls_variable AsyncLogRing *AsyncLogger_Impl::current_ring = nullptr;
+	cl_tls_variable uint64_t AsyncLogger_Impl::current_ring_id = 0;
+	AsyncLogThreadRing AsyncLogger_Impl::thread_ring;
+
+	AsyncLogger::AsyncLogger(int buffer_size, AsyncLogOverflow overflow, int flush_interval_ms)
+	{
+		if (buffer_size < 1)
+			throw Exception("Invalid async logger buffer size");
+
+		impl = std::make_shared<AsyncLogger_Impl>(buffer_size, overflow, flush_interval_ms);
+		impl->thread = std::thread(&AsyncLogger_Impl::thread_main, impl.get());
+		impl->thread_id = impl->thread.get_id();
+
+		AsyncLogger_Impl *expected = nullptr;
+		if (!AsyncLogger_Impl::active.compare_exchange_strong(expected, impl.get()))
+		{
+			impl->stop();
+			throw Exception("Only one AsyncLogger can be active at a time");
+		}
+	}
+
+	AsyncLogger::~AsyncLogger()
+	{
+		// Wait for threads that are still placing events in the buffers
+		AsyncLogger_Impl::active.store(nullptr);
+		while (AsyncLogger_Impl::active_callers.load() != 0)
+			std::this_thread::yield();
+
+		impl->stop();
+	}
+
+	void AsyncLogger::flush()
+	{
+		impl->flush();
+	}
+
+	AsyncLoggerStats AsyncLogger::get_stats() const
+	{
+		AsyncLoggerStats stats;
+		stats.events_logged = impl->events_logged.load();
+		stats.events_dropped = impl->events_dropped.load();
+		stats.events_blocked = impl->events_blocked.load();
+		stats.batches_written = impl->batches_written.load();
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		stats.thread_buffers = impl->rings.size();
+		return stats;
+	}
+
+	bool AsyncLogger::is_enabled()
+	{
+		return AsyncLogger_Impl::active.load(std::memory_order_relaxed) != nullptr;
+	}
+
+	bool AsyncLogger::log(const std::string &type, const std::string &text)
+	{
+		std::function<std::string()> format_func;
+		return AsyncLogger_Impl::log_active(type, text, format_func);
+	}
+
+	bool AsyncLogger::log_deferred(const std::string &type, std::function<std::string()> format_func)
+	{
+		return AsyncLogger_Impl::log_active(type, std::string(), format_func);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	bool AsyncLogger_Impl::log_active(const std::string &type, const std::string &text, std::function<std::string()> &format_func)
+	{
+		active_callers++;
+		AsyncLogger_Impl *impl = active.load();
+		if (impl)
+			impl->log(type, text, format_func);
+		active_callers--;
+		return impl != nullptr;
+	}
+
+	void AsyncLogger_Impl::log(const std::string &type, const std::string &text, std::function<std::string()> &format_func)
+	{
+		AsyncLogRing *ring = get_ring();
+		uint64_t size = ring->records.size();
+		uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+		if (tail - ring->head.load(std::memory_order_acquire) >= size)
+		{
+			// The logging thread cannot wait for itself
+			if (overflow == AsyncLogOverflow::drop || std::this_thread::get_id() == thread_id)
+			{
+				events_dropped++;
+				return;
+			}
+
+			events_blocked++;
+			do
+			{
+				wakeup();
+				std::this_thread::yield();
+			} while (tail - ring->head.load(std::memory_order_acquire) >= size);
+		}
+
+		AsyncLogRecord &record = ring->records[tail % size];
+		record.type = type;
+		record.text = text;
+		record.format_func = std::move(format_func);
+		ring->tail.store(tail + 1, std::memory_order_release);
+
+		if (tail + 1 - ring->head.load(std::memory_order_relaxed) >= size / 2)
+			wakeup();
+	}
+
+	AsyncLogRing *AsyncLogger_Impl::get_ring()
+	{
+		if (current_ring_id != id)
+		{
+			auto ring = std::make_shared<AsyncLogRing>(buffer_size);
+			std::unique_lock<std::mutex> lock(mutex);
+			rings.push_back(ring);
+			lock.unlock();
+			thread_ring.set(ring);
+			current_ring = ring.get();
+			current_ring_id = id;
+		}
+		return current_ring;
+	}
+
+	void AsyncLogger_Impl::wakeup()
+	{
+		if (!wakeup_requested.exchange(true))
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeup_flag = true;
+			wakeup_event.notify_one();
+		}
+	}
+
+	void AsyncLogger_Impl::flush()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		uint64_t flush_id = ++flush_requested;
+		wakeup_event.notify_one();
+		flushed_event.wait(lock, [&]() { return flush_completed >= flush_id; });
+	}
+
+	void AsyncLogger_Impl::stop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop_flag = true;
+		wakeup_event.notify_one();
+		lock.unlock();
+		thread.join();
+	}
+
+	void AsyncLogger_Impl::thread_main()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			wakeup_event.wait_for(lock, std::chrono::milliseconds(flush_interval_ms), [&]() { return stop_flag || wakeup_flag || flush_requested != flush_completed; });
+			wakeup_flag = false;
+			bool stopping = stop_flag;
+			uint64_t flush_id = flush_requested;
+			current_rings.clear();
+			for (auto &ring : rings)
+				current_rings.push_back(ring.get());
+			lock.unlock();
+
+			wakeup_requested.store(false);
+			write_pending();
+
+			lock.lock();
+			if (!drained_rings.empty())
+			{
+				auto is_drained = [&](const std::shared_ptr<AsyncLogRing> &ring) { return std::find(drained_rings.begin(), drained_rings.end(), ring.get()) != drained_rings.end(); };
+				rings.erase(std::remove_if(rings.begin(), rings.end(), is_drained), rings.end());
+				drained_rings.clear();
+			}
+			flush_completed = flush_id;
+			flushed_event.notify_all();
+			if (stopping)
+				break;
+		}
+	}
+
+	void AsyncLogger_Impl::write_pending()
+	{
+		for (AsyncLogRing *ring : current_rings)
+		{
+			// Checked before reading the tail, so nothing can be added after the final drain
+			bool abandoned = ring->abandoned.load(std::memory_order_acquire);
+
+			uint64_t size = ring->records.size();
+			uint64_t head = ring->head.load(std::memory_order_relaxed);
+			uint64_t tail = ring->tail.load(std::memory_order_acquire);
+			while (head != tail)
+			{
+				AsyncLogRecord &record = ring->records[head % size];
+				LogEntry entry;
+				entry.type.swap(record.type);
+				if (record.format_func)
+				{
+					try
+					{
+						entry.text = record.format_func();
+					}
+					catch (...)
+					{
+						entry.text = "Unable to format log event";
+					}
+					record.format_func = std::function<std::string()>();
+				}
+				else
+				{
+					entry.text.swap(record.text);
+				}
+				batch.push_back(std::move(entry));
+
+				head++;
+				ring->head.store(head, std::memory_order_release);
+			}
+
+			if (abandoned)
+				drained_rings.push_back(ring);
+		}
+
+		if (batch.empty())
+			return;
+
+		std::unique_lock<std::recursive_mutex> logger_lock(Logger::mutex);
+		for (auto &instance : Logger::instances)
+		{
+			// The application has no way of handling errors thrown on this thread
+			try
+			{
+				instance->log_batch(batch);
+			}
+			catch (...)
+			{
+			}
+		}
+		logger_lock.unlock();
+
+		events_logged += batch.size();
+		batches_written++;
+		batch.clear();
+	}
+}
@@ -52,4 +52,14 @@ namespace clan
 		file->seek(0, File::seek_end);
 		file->write(log_line.data(), (int)log_line.length());
 	}
+
+	void FileLogger::log_batch(const std::vector<LogEntry> &entries)
+	{
+		std::string log_lines;
+		for (auto &entry : entries)
+			log_lines += get_log_string(entry.type, entry.text).get_result();
+
+		file->seek(0, File::seek_end);
+		file->write(log_lines.data(), (int)log_lines.length());
+	}
 }
@@ -63,6 +63,12 @@ namespace clan
 			instances.erase(il);
 	}
 
+	void Logger::log_batch(const std::vector<LogEntry> &entries)
+	{
+		for (auto &entry : entries)
+			log(entry.type, entry.text);
+	}
+
 	StringFormat Logger::get_log_string(const std::string &type, const std::string &text)
 	{
 		std::string months[] =
@@ -115,6 +121,9 @@ namespace clan
 
 	void log_event(const std::string &type, const std::string &text)
 	{
+		if (AsyncLogger::is_enabled() && AsyncLogger::log(type, text))
+			return;
+
 		std::unique_lock<std::recursive_mutex> mutex_lock(Logger::mutex);
 		if (Logger::instances.empty())
 			return;
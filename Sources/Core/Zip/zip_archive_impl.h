@@ -31,20 +31,54 @@
 #include "API/Core/Zip/zip_file_entry.h"
 #include "API/Core/IOData/iodevice.h"
 #include "zip_flags.h"
+#include <unordered_map>
 
 namespace clan
 {
 	class ZipArchive_Impl
 	{
 	public:
+		ZipArchive_Impl() : case_insensitive(false), seek_index_interval(1024 * 1024) { build_index(); }
+
+		struct DirectoryChild
+		{
+			DirectoryChild(const std::string &name, int file_index) : name(name), file_index(file_index) { }
+
+			std::string name;
+			int file_index;	// -1 for subdirectories
+		};
+
+		/// \brief Children of a directory, in the order they first appear in the archive
+		struct DirectoryNode
+		{
+			std::vector<DirectoryChild> children;
+		};
+
 		std::vector<ZipFileEntry> files;
 		IODevice input;
 
+		bool case_insensitive;
+		int64_t seek_index_interval;
+
+		/// \brief Entry index by filename, without a leading slash. Folded to lower case if case_insensitive is set.
+		std::unordered_map<std::string, int> file_index;
+
+		/// \brief Directory tree by directory path, without leading and trailing slashes. The root is "".
+		std::unordered_map<std::string, DirectoryNode> directories;
+
+		std::string make_key(const std::string &filename) const;
+		int find_file(const std::string &filename) const;
+		const DirectoryNode *find_directory(const std::string &path) const;
+
+		void build_index();
+		void add_to_index(int index);
+		DirectoryNode &add_directory(const std::string &path);
+
 		static uint32_t calc_crc32(const void *data, int64_t size, uint32_t crc = ZIP_CRC_START_VALUE, bool last_block = true);
-		static void calc_time_and_date(int16_t &out_date, int16_t &out_time);
 
-	private:
-		// crc32_table_quotient = 0xdebb20e3
-		static uint32_t crc32_table[256];
+		/// \brief Returns the CRC-32 of two blocks joined together, given the final CRC-32 of each block and the size of the second
+		static uint32_t combine_crc32(uint32_t crc1, uint32_t crc2, int64_t size2);
+
+		static void calc_time_and_date(int16_t &out_date, int16_t &out_time);
 	};
 }
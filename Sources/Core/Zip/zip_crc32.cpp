@@ -0,0 +1,309 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/System/system.h"
+#include "zip_archive_impl.h"
+
+#ifndef CL_DISABLE_SSE2
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#define CL_ZIP_CRC32_PCLMUL
+// GCC and Clang only allow PCLMULQDQ instructions in functions marked for it, unless -mpclmul is passed
+#if defined(__GNUC__) && !defined(__PCLMUL__)
+#define CL_ZIP_CRC32_PCLMUL_FUNC __attribute__((target("pclmul,sse4.1")))
+#else
+#define CL_ZIP_CRC32_PCLMUL_FUNC
+#endif
+#endif
+
+namespace clan
+{
+	namespace
+	{
+		// crc32_table_quotient = 0xdebb20e3
+		const uint32_t crc32_table[256] =
+		{
+			0x00000000, 0x77073096, 0xee0e612c, 0x990951ba,
+			0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
+			0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
+			0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91,
+			0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de,
+			0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
+			0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec,
+			0x14015c4f, 0x63066cd9, 0xfa0f3d63, 0x8d080df5,
+			0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
+			0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b,
+			0x35b5a8fa, 0x42b2986c, 0xdbbbc9d6, 0xacbcf940,
+			0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
+			0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116,
+			0x21b4f4b5, 0x56b3c423, 0xcfba9599, 0xb8bda50f,
+			0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
+			0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d,
+			0x76dc4190, 0x01db7106, 0x98d220bc, 0xefd5102a,
+			0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
+			0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818,
+			0x7f6a0dbb, 0x086d3d2d, 0x91646c97, 0xe6635c01,
+			0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
+			0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457,
+			0x65b0d9c6, 0x12b7e950, 0x8bbeb8ea, 0xfcb9887c,
+			0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
+			0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2,
+			0x4adfa541, 0x3dd895d7, 0xa4d1c46d, 0xd3d6f4fb,
+			0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
+			0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9,
+			0x5005713c, 0x270241aa, 0xbe0b1010, 0xc90c2086,
+			0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
+			0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4,
+			0x59b33d17, 0x2eb40d81, 0xb7bd5c3b, 0xc0ba6cad,
+			0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
+			0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683,
+			0xe3630b12, 0x94643b84, 0x0d6d6a3e, 0x7a6a5aa8,
+			0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
+			0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe,
+			0xf762575d, 0x806567cb, 0x196c3671, 0x6e6b06e7,
+			0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
+			0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5,
+			0xd6d6a3e8, 0xa1d1937e, 0x38d8c2c4, 0x4fdff252,
+			0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
+			0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60,
+			0xdf60efc3, 0xa867df55, 0x316e8eef, 0x4669be79,
+			0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
+			0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f,
+			0xc5ba3bbe, 0xb2bd0b28, 0x2bb45a92, 0x5cb36a04,
+			0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
+			0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a,
+			0x9c0906a9, 0xeb0e363f, 0x72076785, 0x05005713,
+			0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
+			0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21,
+			0x86d3d2d4, 0xf1d4e242, 0x68ddb3f8, 0x1fda836e,
+			0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
+			0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c,
+			0x8f659eff, 0xf862ae69, 0x616bffd3, 0x166ccf45,
+			0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
+			0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db,
+			0xaed16a4a, 0xd9d65adc, 0x40df0b66, 0x37d83bf0,
+			0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
+			0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6,
+			0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf,
+			0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
+			0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
+		};
+
+		// Tables for processing 8 bytes per step: crc32_slice_table[k][n] is the CRC of byte n followed by k zero bytes
+		class Crc32SliceTables
+		{
+		public:
+			Crc32SliceTables()
+			{
+				for (int n = 0; n < 256; n++)
+					table[0][n] = crc32_table[n];
+				for (int k = 1; k < 8; k++)
+				{
+					for (int n = 0; n < 256; n++)
+						table[k][n] = (table[k - 1][n] >> 8) ^ crc32_table[table[k - 1][n] & 0xff];
+				}
+			}
+
+			uint32_t table[8][256];
+		};
+
+		const Crc32SliceTables crc32_slice_tables;
+
+		uint32_t crc32_slice8(const unsigned char *d, int64_t size, uint32_t crc)
+		{
+			const uint32_t (&t)[8][256] = crc32_slice_tables.table;
+			while (size >= 8)
+			{
+				// Assembled byte by byte so big endian systems get the same result
+				uint32_t one = crc ^ (d[0] | (d[1] << 8) | (d[2] << 16) | ((uint32_t)d[3] << 24));
+				uint32_t two = d[4] | (d[5] << 8) | (d[6] << 16) | ((uint32_t)d[7] << 24);
+				crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^ t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^
+					t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^ t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+				d += 8;
+				size -= 8;
+			}
+
+			while (size-- > 0)
+				crc = (crc >> 8) ^ crc32_table[(crc ^ *(d++)) & 0xff];
+			return crc;
+		}
+
+#ifdef CL_ZIP_CRC32_PCLMUL
+		const bool has_pclmulqdq = System::detect_cpu_extension(System::pclmulqdq);
+
+		// Folds 64 bytes per step with carry-less multiplication, as described in Intel's paper
+		// "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+		// size must be at least 64 and a multiple of 16.
+		CL_ZIP_CRC32_PCLMUL_FUNC uint32_t crc32_pclmul(const unsigned char *d, int64_t size, uint32_t crc)
+		{
+			// Bit-reflected constants for the CRC-32 polynomial, as pairs of 64 bit values
+			const __m128i k1k2 = _mm_setr_epi32(0x54442bd4, 0x00000001, 0xc6e41596, 0x00000001);
+			const __m128i k3k4 = _mm_setr_epi32(0x751997d0, 0x00000001, 0xccaa009e, 0x00000000);
+			const __m128i k5k0 = _mm_setr_epi32(0x63cd6124, 0x00000001, 0x00000000, 0x00000000);
+			const __m128i poly = _mm_setr_epi32(0xdb710641, 0x00000001, 0xf7011641, 0x00000001);
+			const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+			__m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x00));
+			__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x10));
+			__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x20));
+			__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x30));
+			x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+			d += 64;
+			size -= 64;
+
+			// Fold four 128 bit lanes in parallel
+			while (size >= 64)
+			{
+				__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+				__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+				__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+				__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+				x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+				x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+				x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+				x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x00)));
+				x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x10)));
+				x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x20)));
+				x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + 0x30)));
+				d += 64;
+				size -= 64;
+			}
+
+			// Fold the lanes into one
+			__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x2), x5);
+			x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x3), x5);
+			x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), x4), x5);
+
+			// Fold the remaining 16 byte blocks
+			while (size >= 16)
+			{
+				x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+				x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k3k4, 0x11), _mm_loadu_si128(reinterpret_cast<const __m128i*>(d))), x5);
+				d += 16;
+				size -= 16;
+			}
+
+			// Fold 128 bits to 64 bits
+			x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+			x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+			x2 = _mm_srli_si128(x1, 4);
+			x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k5k0, 0x00), x2);
+
+			// Barrett reduction to 32 bits
+			x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), poly, 0x10);
+			x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask32), poly, 0x00);
+			x1 = _mm_xor_si128(x1, x2);
+			return (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+		}
+#endif
+
+		uint32_t gf2_matrix_times(const uint32_t *matrix, uint32_t vector)
+		{
+			uint32_t sum = 0;
+			while (vector)
+			{
+				if (vector & 1)
+					sum ^= *matrix;
+				vector >>= 1;
+				matrix++;
+			}
+			return sum;
+		}
+
+		void gf2_matrix_square(uint32_t *square, const uint32_t *matrix)
+		{
+			for (int n = 0; n < 32; n++)
+				square[n] = gf2_matrix_times(matrix, matrix[n]);
+		}
+	}
+
+	uint32_t ZipArchive_Impl::calc_crc32(const void *data, int64_t size, uint32_t crc, bool last_block)
+	{
+		const unsigned char *d = static_cast<const unsigned char *>(data);
+
+#ifdef CL_ZIP_CRC32_PCLMUL
+		if (has_pclmulqdq && size >= 64)
+		{
+			int64_t folded_size = size & ~(int64_t)15;
+			crc = crc32_pclmul(d, folded_size, crc);
+			d += folded_size;
+			size -= folded_size;
+		}
+#endif
+
+		crc = crc32_slice8(d, size, crc);
+
+		if (last_block)
+			return ~crc;
+		else
+			return crc;
+	}
+
+	uint32_t ZipArchive_Impl::combine_crc32(uint32_t crc1, uint32_t crc2, int64_t size2)
+	{
+		// Appends size2 zero bytes to crc1 by repeated squaring of the CRC shift operator, as zlib's crc32_combine does
+		if (size2 <= 0)
+			return crc1;
+
+		uint32_t even[32]; // operator for an even power of two zero bits
+		uint32_t odd[32]; // operator for an odd power of two zero bits
+
+		odd[0] = 0xedb88320;
+		uint32_t row = 1;
+		for (int n = 1; n < 32; n++)
+		{
+			odd[n] = row;
+			row <<= 1;
+		}
+
+		gf2_matrix_square(even, odd); // 2 zero bits
+		gf2_matrix_square(odd, even); // 4 zero bits
+
+		do
+		{
+			gf2_matrix_square(even, odd);
+			if (size2 & 1)
+				crc1 = gf2_matrix_times(even, crc1);
+			size2 >>= 1;
+			if (size2 == 0)
+				break;
+
+			gf2_matrix_square(odd, even);
+			if (size2 & 1)
+				crc1 = gf2_matrix_times(odd, crc1);
+			size2 >>= 1;
+		} while (size2 != 0);
+
+		return crc1 ^ crc2;
+	}
+}
@@ -31,14 +31,16 @@
 #include "zip_file_entry_impl.h"
 #include "zip_compression_method.h"
 #include "zip_flags.h"
+#include "zip_archive_impl.h"
 #include "API/Core/IOData/file.h"
 #include "API/Core/Math/cl_math.h"
 #include "API/Core/Text/string_format.h"
+#include <algorithm>
 
 namespace clan
 {
-	ZipIODevice_FileEntry::ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry)
-		: iodevice(iodevice), file_entry(entry), zstream_open(false), peeked_data(0)
+	ZipIODevice_FileEntry::ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry, int64_t seek_index_interval)
+		: iodevice(iodevice), file_entry(entry), zstream_open(false), zstream_state_size(0), peeked_data(0), data_offset(0), seek_index_interval(seek_index_interval)
 	{
 		init();
 	}
@@ -58,6 +60,16 @@ namespace clan
 		return (int)pos;
 	}
 
+	int64_t ZipIODevice_FileEntry::get_size64() const
+	{
+		return file_header.uncompressed_size;
+	}
+
+	int64_t ZipIODevice_FileEntry::get_position64() const
+	{
+		return pos;
+	}
+
 	int ZipIODevice_FileEntry::send(const void *data, int len, bool send_all)
 	{
 		throw Exception("Read-only device.");
@@ -107,6 +119,11 @@ namespace clan
 	}
 
 	bool ZipIODevice_FileEntry::seek(int seek_pos, IODevice::SeekMode mode)
+	{
+		return seek64(seek_pos, mode);
+	}
+
+	bool ZipIODevice_FileEntry::seek64(int64_t seek_pos, IODevice::SeekMode mode)
 	{
 		int64_t absolute_pos = 0;
 		switch (mode)
@@ -127,24 +144,37 @@ namespace clan
 		switch (file_header.compression_method)
 		{
 		case zip_compress_store: // no compression
-			iodevice.seek(int(absolute_pos - pos), IODevice::seek_cur);
+			if (absolute_pos == pos)
+				break;
+			if (!iodevice.seek64(absolute_pos - pos, IODevice::seek_cur))
+				return false;
+			pos = absolute_pos;
+			crc32_valid = false; // Skipped data can no longer be verified
 			break;
 
 		case zip_compress_deflate:
-			// if backward seeking, restart at beginning of stream.
-			if (absolute_pos < pos)
+		{
+			// Resume from the closest checkpoint if that is nearer than the current position.
+			// Without one, a backward seek restarts at the beginning of the stream.
+			const InflateCheckpoint *checkpoint = find_checkpoint(absolute_pos);
+			if (checkpoint && (absolute_pos < pos || checkpoint->pos > pos))
+			{
+				restore_checkpoint(*checkpoint);
+			}
+			else if (absolute_pos < pos)
 			{
 				deinit();
 				init();
 			}
 
-			char buffer[1024];
+			char buffer[16 * 1024];
 			while (absolute_pos > pos)
 			{
-				int received = receive(buffer, int(min(absolute_pos - pos, (int64_t)1024)), true);
+				int received = receive(buffer, int(min(absolute_pos - pos, (int64_t)sizeof(buffer))), true);
 				if (received == 0) break;
 			}
 			break;
+		}
 
 		case zip_compress_shrunk:
 		case zip_compress_expand_factor_1:
@@ -162,7 +192,7 @@ namespace clan
 
 	IODeviceProvider *ZipIODevice_FileEntry::duplicate()
 	{
-		ZipIODevice_FileEntry *new_provider = new ZipIODevice_FileEntry(this, file_entry);
+		ZipIODevice_FileEntry *new_provider = new ZipIODevice_FileEntry(this, file_entry, seek_index_interval);
 		return new_provider;
 	}
 
@@ -180,8 +210,11 @@ namespace clan
 			file_header.uncompressed_size = file_entry.get_uncompressed_size();
 		}
 
+		data_offset = iodevice.get_position64();
 		pos = 0;
 		compressed_pos = 0;
+		crc32 = ZIP_CRC_START_VALUE;
+		crc32_valid = true;
 
 		// Initialize decompression:
 		int result = 0;
@@ -194,9 +227,9 @@ namespace clan
 			memset(&zs, 0, sizeof(mz_stream));
 			zs.next_in = nullptr;
 			zs.avail_in = 0;
-			zs.zalloc = nullptr;
-			zs.zfree = nullptr;
-			zs.opaque = nullptr;
+			zs.zalloc = &ZipIODevice_FileEntry::inflate_alloc;
+			zs.zfree = &ZipIODevice_FileEntry::inflate_free;
+			zs.opaque = this;
 			//result = inflateInit(&zs);
 			result = mz_inflateInit2(&zs, -15); // Undocumented: if wbits is negative, zlib skips header check
 			if (result != MZ_OK) throw Exception("Zlib inflateInit failed for zip index!");
@@ -251,45 +284,33 @@ namespace clan
 		case zip_compress_store: // no compression
 		{
 			int received = iodevice.receive(data, int(min((int64_t)size, file_header.uncompressed_size - pos)), read_all);
-			pos += received;
+			update_crc32(data, received);
 			return received;
 		}
 		break;
 
 		case zip_compress_deflate:
-			zs.next_out = (unsigned char *)data;
-			zs.avail_out = size;
-			// Continue feeding zlib data until we get our data:
-			while (zs.avail_out > 0)
+		{
+			int total = 0;
+			while (total < size)
 			{
-				// zlib needs more data:
-				if (zs.avail_in == 0 && compressed_pos < file_header.compressed_size)
-				{
-					// Read some compressed data:
-					int received_input = 0;
-					while (received_input < 16 * 1024)
-					{
-						received_input += iodevice.receive(zbuffer, int(min((int64_t)16 * 1024, file_header.compressed_size - compressed_pos)), true);
-						if (compressed_pos + received_input == file_header.compressed_size) break;
-					}
-					compressed_pos += received_input;
-
-					zs.next_in = (unsigned char *)zbuffer;
-					zs.avail_in = received_input;
-				}
-
-				// Decompress data:
-				int result = mz_inflate(&zs, 0);
-				if (result == MZ_STREAM_END) break;
-				if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
-				if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
-				if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
-				if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
-				if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
-				if (result != MZ_OK) throw Exception("Zlib inflate failed while decompressing zip file!");
+				// Stop at the next checkpoint position so the decompressor state can be saved there
+				int chunk = size - total;
+				int64_t next_checkpoint = get_next_checkpoint_position();
+				if (next_checkpoint != -1 && next_checkpoint - pos < chunk)
+					chunk = (int)(next_checkpoint - pos);
+
+				int received = inflate((char *)data + total, chunk);
+				update_crc32((char *)data + total, received);
+				total += received;
+
+				if (pos == next_checkpoint)
+					save_checkpoint();
+				if (received < chunk)
+					break;
 			}
-			pos += size - zs.avail_out;
-			return size - zs.avail_out;
+			return total;
+		}
 
 		case zip_compress_shrunk:
 		case zip_compress_expand_factor_1:
@@ -305,4 +326,110 @@ namespace clan
 
 		return 0;
 	}
+
+	int ZipIODevice_FileEntry::inflate(void *data, int size)
+	{
+		zs.next_out = (unsigned char *)data;
+		zs.avail_out = size;
+		// Continue feeding zlib data until we get our data:
+		while (zs.avail_out > 0)
+		{
+			// zlib needs more data:
+			if (zs.avail_in == 0 && compressed_pos < file_header.compressed_size)
+			{
+				// Read some compressed data:
+				int received_input = 0;
+				while (received_input < 16 * 1024)
+				{
+					received_input += iodevice.receive(zbuffer, int(min((int64_t)16 * 1024, file_header.compressed_size - compressed_pos)), true);
+					if (compressed_pos + received_input == file_header.compressed_size) break;
+				}
+				compressed_pos += received_input;
+
+				zs.next_in = (unsigned char *)zbuffer;
+				zs.avail_in = received_input;
+			}
+
+			// Decompress data:
+			int result = mz_inflate(&zs, 0);
+			if (result == MZ_STREAM_END) break;
+			if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
+			if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
+			if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
+			if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
+			if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
+			if (result != MZ_OK) throw Exception("Zlib inflate failed while decompressing zip file!");
+		}
+		return size - zs.avail_out;
+	}
+
+	void ZipIODevice_FileEntry::update_crc32(const void *data, int size)
+	{
+		pos += size;
+		if (!crc32_valid || size == 0)
+			return;
+
+		crc32 = ZipArchive_Impl::calc_crc32(data, size, crc32, false);
+		if (pos == file_header.uncompressed_size)
+		{
+			crc32_valid = false;
+			if (~crc32 != file_entry.impl->record.crc32)
+				throw Exception(string_format("Zip file entry %1 failed its CRC check", file_entry.get_archive_filename()));
+		}
+	}
+
+	int64_t ZipIODevice_FileEntry::get_next_checkpoint_position() const
+	{
+		if (seek_index_interval <= 0)
+			return -1;
+
+		int64_t next_checkpoint = checkpoints.empty() ? seek_index_interval : checkpoints.back().pos + seek_index_interval;
+		if (next_checkpoint < pos || next_checkpoint >= file_header.uncompressed_size)
+			return -1;
+		return next_checkpoint;
+	}
+
+	const ZipIODevice_FileEntry::InflateCheckpoint *ZipIODevice_FileEntry::find_checkpoint(int64_t position) const
+	{
+		auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), position, [](int64_t position, const InflateCheckpoint &checkpoint) { return position < checkpoint.pos; });
+		if (it == checkpoints.begin())
+			return nullptr;
+		return &*(it - 1);
+	}
+
+	void ZipIODevice_FileEntry::save_checkpoint()
+	{
+		InflateCheckpoint checkpoint;
+		checkpoint.pos = pos;
+		checkpoint.compressed_pos = compressed_pos - zs.avail_in;
+		checkpoint.crc32 = crc32;
+		checkpoint.crc32_valid = crc32_valid;
+		checkpoint.state = DataBuffer(zs.state, (unsigned int)zstream_state_size);
+		checkpoints.push_back(checkpoint);
+	}
+
+	void ZipIODevice_FileEntry::restore_checkpoint(const InflateCheckpoint &checkpoint)
+	{
+		memcpy(zs.state, checkpoint.state.get_data(), checkpoint.state.get_size());
+		zs.next_in = nullptr;
+		zs.avail_in = 0;
+		compressed_pos = checkpoint.compressed_pos;
+		iodevice.seek64(data_offset + compressed_pos, IODevice::seek_set);
+		pos = checkpoint.pos;
+		crc32 = checkpoint.crc32;
+		crc32_valid = checkpoint.crc32_valid;
+	}
+
+	// miniz keeps all inflate state in the single block allocated by mz_inflateInit2.
+	// Recording its size allows the state to be copied into a checkpoint.
+	void *ZipIODevice_FileEntry::inflate_alloc(void *opaque, size_t items, size_t size)
+	{
+		static_cast<ZipIODevice_FileEntry *>(opaque)->zstream_state_size = items * size;
+		return malloc(items * size);
+	}
+
+	void ZipIODevice_FileEntry::inflate_free(void *opaque, void *address)
+	{
+		free(address);
+	}
 }
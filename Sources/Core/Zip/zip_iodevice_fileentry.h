@@ -40,17 +40,20 @@ namespace clan
 	class ZipIODevice_FileEntry : public IODeviceProvider
 	{
 	public:
-		ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry);
+		ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry, int64_t seek_index_interval);
 		~ZipIODevice_FileEntry();
 
 		virtual int get_size() const override;
 		virtual int get_position() const override;
+		virtual int64_t get_size64() const override;
+		virtual int64_t get_position64() const override;
 
 		virtual int send(const void *data, int len, bool send_all) override;
 		virtual int receive(void *data, int len, bool receive_all) override;
 		virtual int peek(void *data, int len) override;
 
 		virtual bool seek(int position, IODevice::SeekMode mode) override;
+		virtual bool seek64(int64_t position, IODevice::SeekMode mode) override;
 
 		IODeviceProvider *duplicate() override;
 
@@ -58,14 +61,41 @@ namespace clan
 		void init();
 		void deinit();
 		int lowlevel_read(void *buffer, int size, bool read_all);
+		int inflate(void *buffer, int size);
+		void update_crc32(const void *data, int size);
+
+		/// \brief Decompressor state saved at a position in the uncompressed data
+		struct InflateCheckpoint
+		{
+			int64_t pos;
+			int64_t compressed_pos;	// Offset of the next compressed byte not yet fed to the decompressor
+			uint32_t crc32;
+			bool crc32_valid;
+			DataBuffer state;
+		};
+
+		int64_t get_next_checkpoint_position() const;
+		const InflateCheckpoint *find_checkpoint(int64_t position) const;
+		void save_checkpoint();
+		void restore_checkpoint(const InflateCheckpoint &checkpoint);
+
+		static void *inflate_alloc(void *opaque, size_t items, size_t size);
+		static void inflate_free(void *opaque, void *address);
 
 		IODevice iodevice;
 		ZipFileEntry file_entry;
 		ZipLocalFileHeader file_header;
 		int64_t pos, compressed_pos;
+		uint32_t crc32;
+		bool crc32_valid;
 		mz_stream zs;
 		char zbuffer[16 * 1024];
 		bool zstream_open;
+		size_t zstream_state_size;
 		DataBuffer peeked_data;
+
+		int64_t data_offset;
+		int64_t seek_index_interval;
+		std::vector<InflateCheckpoint> checkpoints;
 	};
 }
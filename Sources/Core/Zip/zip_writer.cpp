@@ -29,6 +29,9 @@
 #include "Core/precomp.h"
 #include "API/Core/Zip/zip_writer.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/System/system.h"
+#include "API/Core/System/work_queue.h"
+#include "API/Core/Math/cl_math.h"
 #include "zip_archive_impl.h"
 #include "zip_local_file_header.h"
 #include "zip_compression_method.h"
@@ -36,6 +39,7 @@
 #include "zip_end_of_central_directory_record.h"
 #include "zip_flags.h"
 #include "Core/Zip/miniz.h"
+#include <deque>
 
 namespace clan
 {
@@ -50,7 +54,7 @@ namespace clan
 
 		~ZipWriter_Impl()
 		{
-			if (file_begun && compress)
+			if (file_begun && compress && !queue)
 			{
 				mz_deflateEnd(&zs);
 			}
@@ -62,6 +66,43 @@ namespace clan
 			int64_t local_header_offset;
 		};
 
+		/// \brief File whose blocks are being compressed on the work queue
+		struct PendingFile
+		{
+			PendingFile() : local_header_offset(-1) { }
+
+			ZipLocalFileHeader local_header;
+			int64_t local_header_offset;	// -1 until the local header has been written
+		};
+
+		/// \brief Part of a file compressed and checksummed on a worker thread
+		struct Block
+		{
+			Block() : compress(false), last_block(false), crc32(0) { }
+
+			void process();
+
+			std::shared_ptr<PendingFile> file;
+			DataBuffer input;
+			DataBuffer output;
+			bool compress;
+			bool last_block;
+			uint32_t crc32;
+		};
+
+		struct QueuedBlock
+		{
+			std::shared_ptr<Block> block;
+			WorkHandle handle;
+		};
+
+		static const int block_size = 1024 * 1024;
+
+		std::shared_ptr<Block> create_block();
+		void queue_block(bool last_block);
+		void write_finished_blocks(bool wait_all);
+		void write_block(Block &block);
+
 		IODevice output;
 		bool storeFilenamesAsUTF8;
 		bool file_begun;
@@ -74,6 +115,11 @@ namespace clan
 		mz_stream zs;
 		char zbuffer[16 * 1024];
 		std::vector<FileEntry> written_files;
+
+		std::unique_ptr<WorkQueue> queue;
+		std::shared_ptr<PendingFile> pending_file;
+		std::shared_ptr<Block> current_block;
+		std::deque<QueuedBlock> queued_blocks;
 	};
 
 	ZipWriter::ZipWriter(IODevice &output, bool storeFilenamesAsUTF8)
@@ -81,6 +127,12 @@ namespace clan
 	{
 	}
 
+	ZipWriter::ZipWriter(IODevice &output, bool storeFilenamesAsUTF8, const WorkQueue &queue)
+		: impl(std::make_shared<ZipWriter_Impl>(output, storeFilenamesAsUTF8))
+	{
+		impl->queue.reset(new WorkQueue(queue));
+	}
+
 	void ZipWriter::begin_file(const std::string &filename, bool compress)
 	{
 		if (impl->file_begun)
@@ -92,7 +144,6 @@ namespace clan
 		impl->compress = compress;
 		impl->crc32 = ZIP_CRC_START_VALUE;
 
-		impl->local_header_offset = impl->output.get_position();
 		impl->local_header = ZipLocalFileHeader();
 		impl->local_header.version_needed_to_extract = 20;
 		if (impl->storeFilenamesAsUTF8)
@@ -128,6 +179,16 @@ namespace clan
 			impl->local_header.extra_field = unicode_path;
 		}
 
+		if (impl->queue)
+		{
+			// The local header is written once the blocks before it are done
+			impl->pending_file = std::make_shared<ZipWriter_Impl::PendingFile>();
+			impl->pending_file->local_header = impl->local_header;
+			impl->current_block = impl->create_block();
+			return;
+		}
+
+		impl->local_header_offset = impl->output.get_position();
 		impl->local_header.save(impl->output);
 
 		if (compress)
@@ -144,6 +205,25 @@ namespace clan
 		if (!impl->file_begun)
 			throw Exception("ZipWriter::begin_file not called prior ZipWriter::write_file_data");
 
+		if (impl->queue)
+		{
+			const char *input = static_cast<const char *>(data);
+			while (size > 0)
+			{
+				DataBuffer &block_input = impl->current_block->input;
+				unsigned int block_pos = block_input.get_size();
+				unsigned int count = (unsigned int)min(size, (int64_t)(ZipWriter_Impl::block_size - block_pos));
+				block_input.set_size(block_pos + count);
+				memcpy(block_input.get_data() + block_pos, input, count);
+				input += count;
+				size -= count;
+
+				if (block_input.get_size() == ZipWriter_Impl::block_size)
+					impl->queue_block(false);
+			}
+			return;
+		}
+
 		impl->uncompressed_length += size;
 
 		if (impl->compress)
@@ -185,6 +265,15 @@ namespace clan
 		if (!impl->file_begun)
 			return;
 
+		if (impl->queue)
+		{
+			impl->queue_block(true);
+			impl->pending_file.reset();
+			impl->compress = false;
+			impl->file_begun = false;
+			return;
+		}
+
 		if (impl->compress)
 		{
 			impl->zs.next_in = nullptr;
@@ -237,6 +326,9 @@ namespace clan
 		if (impl->file_begun)
 			throw Exception("Cannot write zip TOC when already writing a file entry");
 
+		if (impl->queue)
+			impl->write_finished_blocks(true);
+
 		int64_t offset_start_central_dir = impl->output.get_position();
 
 		// write central directory entries.
@@ -282,4 +374,101 @@ namespace clan
 		central_dir_end.file_comment = "";
 		central_dir_end.save(impl->output);
 	}
+
+	std::shared_ptr<ZipWriter_Impl::Block> ZipWriter_Impl::create_block()
+	{
+		auto block = std::make_shared<Block>();
+		block->file = pending_file;
+		block->compress = compress;
+		block->input.set_capacity(block_size);
+		return block;
+	}
+
+	void ZipWriter_Impl::queue_block(bool last_block)
+	{
+		std::shared_ptr<Block> block = current_block;
+		block->last_block = last_block;
+
+		QueuedBlock queued;
+		queued.block = block;
+		queued.handle = queue->queue([block]() { block->process(); });
+		queued_blocks.push_back(queued);
+
+		current_block = last_block ? std::shared_ptr<Block>() : create_block();
+		write_finished_blocks(false);
+	}
+
+	void ZipWriter_Impl::write_finished_blocks(bool wait_all)
+	{
+		// Enough blocks to keep every worker busy, without buffering all of the input
+		const size_t max_queued_blocks = System::get_num_cores() * 2;
+
+		while (!queued_blocks.empty())
+		{
+			QueuedBlock &queued = queued_blocks.front();
+			if (!wait_all && queued_blocks.size() <= max_queued_blocks && !queued.handle.is_finished())
+				break;
+
+			queued.handle.wait();
+			std::shared_ptr<Block> block = queued.block;
+			queued_blocks.pop_front();
+			write_block(*block);
+		}
+	}
+
+	void ZipWriter_Impl::write_block(Block &block)
+	{
+		PendingFile &file = *block.file;
+		if (file.local_header_offset == -1)
+		{
+			file.local_header_offset = output.get_position64();
+			file.local_header.save(output);
+		}
+
+		const DataBuffer &data = block.compress ? block.output : block.input;
+		output.write(data.get_data(), data.get_size());
+		file.local_header.uncompressed_size += block.input.get_size();
+		file.local_header.compressed_size += data.get_size();
+		file.local_header.crc32 = ZipArchive_Impl::combine_crc32(file.local_header.crc32, block.crc32, block.input.get_size());
+
+		if (block.last_block)
+		{
+			int64_t current_offset = output.get_position64();
+			output.seek64(file.local_header_offset);
+			file.local_header.save(output);
+			output.seek64(current_offset);
+
+			FileEntry file_entry;
+			file_entry.local_header = file.local_header;
+			file_entry.local_header_offset = file.local_header_offset;
+			written_files.push_back(file_entry);
+		}
+	}
+
+	void ZipWriter_Impl::Block::process()
+	{
+		crc32 = ZipArchive_Impl::calc_crc32(input.get_data(), input.get_size());
+		if (!compress)
+			return;
+
+		mz_stream zs;
+		memset(&zs, 0, sizeof(mz_stream));
+		int result = mz_deflateInit2(&zs, MZ_DEFAULT_COMPRESSION, MZ_DEFLATED, -15, 8, MZ_DEFAULT_STRATEGY);
+		if (result != MZ_OK)
+			throw Exception("Zlib deflateInit failed for zip index!");
+
+		// Each block is a deflate stream of its own. All but the last block end with a sync flush, which
+		// byte aligns the data without marking it as final, so the blocks of a file join into one stream.
+		output.set_size(mz_deflateBound(&zs, input.get_size()) + 16);
+		zs.next_in = (const unsigned char *)input.get_data();
+		zs.avail_in = input.get_size();
+		zs.next_out = (unsigned char *)output.get_data();
+		zs.avail_out = output.get_size();
+		result = mz_deflate(&zs, last_block ? MZ_FINISH : MZ_SYNC_FLUSH);
+		mz_deflateEnd(&zs);
+
+		if (result != (last_block ? MZ_STREAM_END : MZ_OK) || zs.avail_in != 0 || zs.avail_out == 0)
+			throw Exception("Zlib deflate failed while compressing zip file!");
+		output.set_size(output.get_size() - zs.avail_out);
+	}
 }
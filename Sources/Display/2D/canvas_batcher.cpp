@@ -32,6 +32,7 @@
 #include "API/Display/Render/render_batcher.h"
 #include "API/Display/Render/shared_gc_data.h"
 #include "API/Display/TargetProviders/graphic_context_provider.h"
+#include "API/Core/System/profiler.h"
 
 namespace clan
 {
@@ -147,6 +148,7 @@ namespace clan
 
 	void CanvasBatcher::flush()
 	{
+		CL_PROFILE_SCOPE("CanvasBatcher::flush");
 		impl->flush();
 	}
 
@@ -32,6 +32,7 @@
 #include "API/Display/Render/texture_1d.h"
 #include "API/Display/2D/subtexture.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/profiler.h"
 #include <algorithm>
 
 #if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
@@ -195,6 +196,7 @@ namespace clan
 
 	void PathFillRenderer::flush(GraphicContext &gc)
 	{
+		CL_PROFILE_SCOPE("PathFillRenderer::flush");
 		if (mask_blocks.next_block == 0) // Nothing to flush
 			return;
 
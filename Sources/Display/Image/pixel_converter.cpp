@@ -31,6 +31,8 @@
 #include "API/Display/Image/pixel_converter.h"
 #include "API/Core/System/databuffer.h"
 #include "API/Core/System/system.h"
+#include "API/Core/System/parallel_for.h"
+#include "API/Core/Math/cl_math.h"
 #include "pixel_converter_impl.h"
 #include "pixel_reader_cast.h"
 #include "pixel_reader_half_float.h"
@@ -54,6 +56,7 @@
 #include "pixel_filter_premultiply_alpha.h"
 #include "pixel_filter_swizzle.h"
 #include "pixel_filter_rgb_to_ycrcb.h"
+#include "API/Core/System/profiler.h"
 
 namespace clan
 {
@@ -133,6 +136,7 @@ namespace clan
 
 	void PixelConverter::convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height)
 	{
+		CL_PROFILE_SCOPE("PixelConverter::convert");
 		bool sse2 = System::detect_cpu_extension(System::sse2);
 		bool sse4 = System::detect_cpu_extension(System::sse4_1);
 
@@ -140,19 +144,27 @@ namespace clan
 		std::unique_ptr<PixelWriter> writer = impl->create_writer(output_format, sse2, sse4);
 		std::vector<std::shared_ptr<PixelFilter> > filters = impl->create_filters(sse2);
 
-		DataBuffer work_buffer(width * sizeof(Vec4f));
-		Vec4f *temp = work_buffer.get_data<Vec4f>();
-		for (int input_y = 0; input_y < height; input_y++)
+		// Split the image into bands of roughly 64k pixels each. Readers, writers and filters are stateless,
+		// so the bands only need their own work buffer.
+		int rows_per_band = clan::max(65536 / clan::max(width, 1), 1);
+		bool flip_vertical = impl->flip_vertical;
+
+		parallel_for(0, height, rows_per_band, [&](int band_begin, int band_end)
 		{
-			int output_y = impl->flip_vertical ? (height - 1 - input_y) : input_y;
-
-			const char *input_line = static_cast<const char*>(input)+input_pitch * input_y;
-			char *output_line = static_cast<char*>(output)+output_pitch * output_y;
-			reader->read(input_line, temp, width);
-			for (auto & filter : filters)
-				filter->filter(temp, width);
-			writer->write(output_line, temp, width);
-		}
+			DataBuffer work_buffer(width * sizeof(Vec4f));
+			Vec4f *temp = work_buffer.get_data<Vec4f>();
+			for (int input_y = band_begin; input_y < band_end; input_y++)
+			{
+				int output_y = flip_vertical ? (height - 1 - input_y) : input_y;
+
+				const char *input_line = static_cast<const char*>(input)+input_pitch * input_y;
+				char *output_line = static_cast<char*>(output)+output_pitch * output_y;
+				reader->read(input_line, temp, width);
+				for (auto & filter : filters)
+					filter->filter(temp, width);
+				writer->write(output_line, temp, width);
+			}
+		});
 	}
 
 	std::unique_ptr<PixelReader> PixelConverter_Impl::create_reader(TextureFormat format, bool sse2)
@@ -32,12 +32,16 @@
 #include "jpeg_huffman_decoder.h"
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_rgb_decoder.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/IOData/buffered_iodevice.h"
 
 namespace clan
 {
 	PixelBuffer JPEGLoader::load(IODevice iodevice, bool srgb)
 	{
-		JPEGLoader loader(iodevice);
+		CL_PROFILE_SCOPE("JPEGLoader::load");
+		BufferedIODevice buffered(iodevice);
+		JPEGLoader loader(buffered);
 		JPEGMCUDecoder mcu_decoder(&loader);
 		JPEGRGBDecoder rgb_decoder(&loader);
 
@@ -32,12 +32,16 @@
 #include "API/Core/Zip/zlib_compression.h"
 #include "API/Core/System/system.h"
 #include "Display/ImageProviders/PNGWriter/png_writer.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/IOData/buffered_iodevice.h"
 
 namespace clan
 {
 	PixelBuffer PNGLoader::load(IODevice iodevice, bool srgb)
 	{
-		PNGLoader loader(iodevice, srgb);
+		CL_PROFILE_SCOPE("PNGLoader::load");
+		BufferedIODevice buffered(iodevice);
+		PNGLoader loader(buffered, srgb);
 		return loader.image;
 	}
 
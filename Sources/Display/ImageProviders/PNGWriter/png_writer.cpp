@@ -29,13 +29,16 @@
 #include "Display/precomp.h"
 #include "png_writer.h"
 #include "API/Core/Zip/zlib_compression.h"
+#include "API/Core/IOData/buffered_iodevice.h"
 
 namespace clan
 {
 	void PNGWriter::save(IODevice iodevice, PixelBuffer image)
 	{
-		PNGWriter writer(iodevice, image);
+		BufferedIODevice buffered(iodevice);
+		PNGWriter writer(buffered, image);
 		writer.save();
+		buffered.flush();
 	}
 	
 	PNGWriter::PNGWriter(IODevice iodevice, PixelBuffer src_image) : device(iodevice)
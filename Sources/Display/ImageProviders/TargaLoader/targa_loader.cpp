@@ -29,12 +29,16 @@
 #include "Display/precomp.h"
 #include "targa_loader.h"
 #include "API/Display/Image/pixel_buffer_lock.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/IOData/buffered_iodevice.h"
 
 namespace clan
 {
 	PixelBuffer TargaLoader::load(IODevice iodevice, bool srgb)
 	{
-		TargaLoader loader(iodevice, srgb);
+		CL_PROFILE_SCOPE("TargaLoader::load");
+		BufferedIODevice buffered(iodevice);
+		TargaLoader loader(buffered, srgb);
 		return loader.image;
 	}
 
@@ -34,6 +34,8 @@
 #include "API/Display/Image/pixel_buffer.h"
 #include "API/Core/System/exception.h"
 #include "API/Core/Text/string_help.h"
+#include "API/Core/System/profiler.h"
+#include "API/Core/IOData/buffered_iodevice.h"
 
 namespace clan
 {
@@ -51,8 +53,11 @@ namespace clan
 		return load(filename, vfs);
 	}
 
-	PixelBufferSet DDSProvider::load(IODevice &file)
+	PixelBufferSet DDSProvider::load(IODevice &device)
 	{
+		CL_PROFILE_SCOPE("DDSProvider::load");
+		BufferedIODevice file(device);
+
 #define fourccvalue(a,b,c,d) ((static_cast<unsigned int>(a)) | (static_cast<unsigned int>(b) << 8) | (static_cast<unsigned int>(c) << 16) | (static_cast<unsigned int>(d) << 24))
 #define isbitmask(r,g,b,a) (format_red_bit_mask == (r) && format_green_bit_mask == (g) && format_blue_bit_mask == (b) && format_alpha_bit_mask == (a))
 
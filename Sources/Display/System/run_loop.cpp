@@ -50,16 +50,18 @@ namespace clan
 	void RunLoop::main_thread_async(std::function<void()> func)
 	{
 		RunLoopImpl *impl = RunLoopImpl::get_instance();
-		
-		std::unique_lock<std::mutex> lock(impl->mutex);
-		bool needs_notify = impl->async_work.empty();
-		impl->async_work.push_back(func);
-		lock.unlock();
 
-		if (needs_notify)
+		// Only wake up the platform loop when the queue goes from empty to non-empty
+		impl->async_work.post(std::move(func));
+		if (!impl->async_work_pending.exchange(true))
 			impl->post_async_work_needed();
 	}
 
+	TaskExecutor RunLoop::resume_on_main()
+	{
+		return TaskExecutor([](const std::function<void()> &work) { RunLoop::main_thread_async(work); });
+	}
+
 	/////////////////////////////////////////////////////////////////////////
 
 	RunLoopImpl *RunLoopImpl::get_instance()
@@ -69,7 +71,7 @@ namespace clan
 		return instance;
 	}
 
-	RunLoopImpl::RunLoopImpl()
+	RunLoopImpl::RunLoopImpl() : async_work_pending(false)
 	{
 		instance = this;
 	}
@@ -81,16 +83,9 @@ namespace clan
 
 	void RunLoopImpl::process_async_work()
 	{
-		std::vector<std::function<void()>> current_async_work;
-
-		std::unique_lock<std::mutex> lock(mutex);
-		current_async_work.swap(async_work);
-		lock.unlock();
-
-		for (auto &work : current_async_work)
-		{
-			work();
-		}
+		// Clear the flag before draining, so work posted while processing wakes up the loop again
+		async_work_pending.store(false);
+		async_work.process();
 	}
 
 	RunLoopImpl *RunLoopImpl::instance = 0;
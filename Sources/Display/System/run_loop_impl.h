@@ -28,8 +28,8 @@
 
 #pragma once
 
-#include <mutex>
-#include <vector>
+#include "API/Core/Signals/signal_queue.h"
+#include <atomic>
 #include <functional>
 
 namespace clan
@@ -50,8 +50,8 @@ namespace clan
 		static RunLoopImpl *get_instance();
 
 	private:
-		std::mutex mutex;
-		std::vector<std::function<void()>> async_work;
+		SignalQueue async_work;
+		std::atomic_bool async_work_pending;
 		static RunLoopImpl *instance;
 
 		friend class RunLoop;
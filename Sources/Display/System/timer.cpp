@@ -31,13 +31,13 @@
 #include "API/Display/System/timer.h"
 #include "API/Core/System/system.h"
 #include "API/Display/System/run_loop.h"
-#include <map>
+#include "timer_wheel.h"
 #include <thread>
 #include <algorithm>
 
 namespace clan
 {
-	class ActiveTimer
+	class ActiveTimer : public TimerWheelNode
 	{
 	public:
 		ActiveTimer(std::weak_ptr<TimerImpl> impl) : timer_impl(std::move(impl)) { }
@@ -45,7 +45,6 @@ namespace clan
 		std::weak_ptr<TimerImpl> timer_impl;
 		bool is_repeating = false;
 		int timeout = 0;
-		std::chrono::steady_clock::time_point next_awake_time;
 		std::function<void()> func_expired;
 	};
 
@@ -60,25 +59,31 @@ namespace clan
 		std::function<void()> func_expired;
 	};
 
+	/// \brief Runs all timers from one thread, using a timer wheel with a millisecond tick
+	///
+	/// A timer in the wheel is always owned by the active field of its TimerImpl, as the TimerImpl destructor removes it.
 	class TimerThread
 	{
 	public:
+		TimerThread() : start_time(std::chrono::steady_clock::now())
+		{
+		}
+
 		void start(std::shared_ptr<TimerImpl> timer)
 		{
 			std::unique_lock<std::mutex> lock(mutex);
 
 			if (!timer->active)
-			{
-				auto active = std::make_shared<ActiveTimer>(timer);
-				timers.push_back(active);
-				timer->active = active;
-			}
+				timer->active = std::make_shared<ActiveTimer>(timer);
 
 			// Copy timer fields to keep TimerImpl fields updateable outside the mutex lock
 			timer->active->timeout = timer->timeout;
 			timer->active->is_repeating = timer->is_repeating;
 			timer->active->func_expired = timer->func_expired;
-			timer->active->next_awake_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(timer->timeout);
+
+			// The tick in progress has already partially passed, so wait one extra tick to never fire early
+			uint64_t now_tick = get_tick(std::chrono::steady_clock::now());
+			wheel.add(timer->active.get(), now_tick + timer->timeout + 1, now_tick);
 			stop_flag = false;
 
 			lock.unlock();
@@ -97,13 +102,11 @@ namespace clan
 
 			if (timer->active)
 			{
-				auto it = std::find(timers.begin(), timers.end(), timer->active);
-				if (it != timers.end())
-					timers.erase(it);
+				wheel.remove(timer->active.get());
 				timer->active.reset();
 			}
 
-			bool no_timers = timers.empty();
+			bool no_timers = wheel.is_empty();
 			if (no_timers)
 				stop_flag = true;
 
@@ -125,79 +128,55 @@ namespace clan
 			{
 				fire_timers();
 
-				if (timers.empty())
+				if (wheel.is_empty())
 					timers_changed_event.wait(lock);
 				else
-					timers_changed_event.wait_until(lock, next_awake_time());
+					timers_changed_event.wait_until(lock, start_time + std::chrono::milliseconds(wheel.get_next_tick()));
 			}
 		}
 
 		void fire_timers()
 		{
-			auto cur_time = std::chrono::steady_clock::now();
-			for (auto it = timers.begin(); it != timers.end();)
+			uint64_t cur_tick = get_tick(std::chrono::steady_clock::now());
+			wheel.advance(cur_tick, [&](TimerWheelNode *node)
 			{
-				auto &timer = *it;
-				bool remove = false;
+				ActiveTimer *timer = static_cast<ActiveTimer*>(node);
 
-				if (timer->next_awake_time < cur_time)
+				if (timer->func_expired)
 				{
-					if (timer->func_expired)
-					{
-						// Copy timer fields to detach them from the mutex lock
-						auto timer_impl = timer->timer_impl;
-						auto func_expired = timer->func_expired;
-
-						RunLoop::main_thread_async([=]()
-						{
-							// Only fire the timer if it is still valid when we reached the main thread
-							if (timer_impl.lock())
-								func_expired();
-						});
-					}
-
-					if (timer->is_repeating)
-					{
-						while (timer->next_awake_time < cur_time)
-							timer->next_awake_time += std::chrono::milliseconds(timer->timeout);
-					}
-					else
+					// Copy timer fields to detach them from the mutex lock
+					auto timer_impl = timer->timer_impl;
+					auto func_expired = timer->func_expired;
+
+					RunLoop::main_thread_async([=]()
 					{
-						remove = true;
-					}
+						// Only fire the timer if it is still valid when we reached the main thread
+						if (timer_impl.lock())
+							func_expired();
+					});
 				}
 
-				if (remove)
+				if (timer->is_repeating)
+				{
+					uint64_t interval = std::max(timer->timeout, 1);
+					uint64_t expire_tick = timer->get_expire_tick();
+					while (expire_tick <= cur_tick)
+						expire_tick += interval;
+					wheel.add(timer, expire_tick, cur_tick);
+				}
+				else
 				{
 					// Since the timer is now stopping, we must notify the implementation that the timer is no longer active, else we will not be able to restart it
 					auto timer_impl = timer->timer_impl.lock();
 					if (timer_impl)
 						timer_impl->active.reset();
-					it = timers.erase(it);
 				}
-				else
-					++it;
-			}
+			});
 		}
 
-		std::chrono::steady_clock::time_point next_awake_time()
+		uint64_t get_tick(std::chrono::steady_clock::time_point time) const
 		{
-			std::chrono::steady_clock::time_point t;
-			bool first = true;
-			for (auto &timer : timers)
-			{
-				if (first)
-				{
-					t = timer->next_awake_time;
-					first = false;
-				}
-				else
-				{
-					if (t > timer->next_awake_time)
-						t = timer->next_awake_time;
-				}
-			}
-			return t;
+			return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(time - start_time).count();
 		}
 
 		bool thread_created = false;
@@ -205,7 +184,8 @@ namespace clan
 		std::mutex mutex;
 		std::condition_variable timers_changed_event;
 		bool stop_flag = false;
-		std::vector<std::shared_ptr<ActiveTimer>> timers;
+		std::chrono::steady_clock::time_point start_time;
+		TimerWheel wheel;
 	};
 
 	TimerThread timer_thread;
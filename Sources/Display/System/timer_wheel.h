@@ -0,0 +1,277 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace clan
+{
+	/// \brief Entry in a timer wheel
+	class TimerWheelNode
+	{
+	public:
+		bool is_linked() const { return slot != nullptr; }
+		uint64_t get_expire_tick() const { return expire_tick; }
+
+	private:
+		TimerWheelNode *prev = nullptr;
+		TimerWheelNode *next = nullptr;
+		TimerWheelNode **slot = nullptr;
+		uint64_t expire_tick = 0;
+
+		friend class TimerWheel;
+	};
+
+	/// \brief Hierarchical timer wheel
+	///
+	/// Adding, removing and expiring a timer are constant time operations. The first level has a
+	/// slot per tick for the next 256 ticks. Each following level has 64 slots, each covering a
+	/// whole revolution of the level below. Timers are moved down a level when the wheel reaches
+	/// their slot, so they expire exactly on their tick.
+	class TimerWheel
+	{
+	public:
+		TimerWheel(uint64_t start_tick = 0) : current_tick(start_tick)
+		{
+			for (int i = 0; i < first_level_slots; i++)
+				first_level[i] = nullptr;
+			for (int level = 0; level < num_upper_levels; level++)
+			{
+				for (int i = 0; i < upper_level_slots; i++)
+					upper_levels[level][i] = nullptr;
+			}
+		}
+
+		TimerWheel(const TimerWheel &) = delete;
+		TimerWheel &operator=(const TimerWheel &) = delete;
+
+		/// \brief Returns true if no timers are in the wheel
+		bool is_empty() const { return num_timers == 0; }
+
+		/// \brief Returns the number of timers in the wheel
+		int get_size() const { return num_timers; }
+
+		/// \brief Returns the next tick the wheel will process
+		uint64_t get_current_tick() const { return current_tick; }
+
+		/// \brief Adds a timer expiring at the specified tick, moving it if it already was in the wheel
+		///
+		/// \param now_tick The tick in progress. An empty wheel has nothing to process up to it, so it skips there directly.
+		void add(TimerWheelNode *node, uint64_t expire_tick, uint64_t now_tick)
+		{
+			if (node->is_linked())
+				remove(node);
+			if (num_timers == 0 && now_tick > current_tick)
+				current_tick = now_tick;
+			node->expire_tick = expire_tick;
+			link(node);
+			num_timers++;
+		}
+
+		/// \brief Removes a timer from the wheel
+		void remove(TimerWheelNode *node)
+		{
+			if (!node->is_linked())
+				return;
+			unlink(node);
+			num_timers--;
+		}
+
+		/// \brief Processes all ticks up to and including the specified tick
+		///
+		/// Expired timers are removed from the wheel before expired(node) is called for them.
+		/// The callback may add and remove timers.
+		template<typename ExpiredFunc>
+		void advance(uint64_t tick, ExpiredFunc expired)
+		{
+			while (current_tick <= tick)
+			{
+				if (num_timers == 0)
+				{
+					current_tick = tick + 1;
+					break;
+				}
+
+				int index = (int)(current_tick & first_level_mask);
+				if (index == 0)
+				{
+					cascade();
+				}
+				else if (num_first_level == 0)
+				{
+					// Nothing can expire before the upper levels cascade again
+					uint64_t end_tick = (current_tick | first_level_mask) + 1;
+					if (end_tick > tick)
+					{
+						current_tick = tick + 1;
+						break;
+					}
+					current_tick = end_tick;
+					continue;
+				}
+
+				// Move the slot to a local list so the callback can remove any of its timers
+				TimerWheelNode *pending = first_level[index];
+				first_level[index] = nullptr;
+				for (TimerWheelNode *node = pending; node; node = node->next)
+				{
+					node->slot = &pending;
+					num_first_level--;
+				}
+				current_tick++;
+
+				while (pending)
+				{
+					TimerWheelNode *node = pending;
+					unlink(node);
+					if (node->expire_tick < current_tick)
+					{
+						num_timers--;
+						expired(node);
+					}
+					else
+					{
+						link(node);	// Only happens for timers too far ahead for the top level
+					}
+				}
+			}
+		}
+
+		/// \brief Returns the tick at which advance has to be called next
+		///
+		/// This is either the tick of the next timer to expire, or the tick where timers from the upper
+		/// levels move down to the first level. Returns the current tick if the wheel is empty.
+		uint64_t get_next_tick() const
+		{
+			if (num_timers == 0 || (current_tick & first_level_mask) == 0)
+				return current_tick;
+
+			uint64_t end_tick = (current_tick | first_level_mask) + 1;
+			if (num_first_level == 0)
+				return end_tick;
+			for (uint64_t t = current_tick; t < end_tick; t++)
+			{
+				if (first_level[t & first_level_mask])
+					return t;
+			}
+			return end_tick;
+		}
+
+	private:
+		static const int first_level_bits = 8;
+		static const int first_level_slots = 1 << first_level_bits;
+		static const uint64_t first_level_mask = first_level_slots - 1;
+		static const int upper_level_bits = 6;
+		static const int upper_level_slots = 1 << upper_level_bits;
+		static const uint64_t upper_level_mask = upper_level_slots - 1;
+		static const int num_upper_levels = 4;
+
+		static int get_shift(int level) { return first_level_bits + level * upper_level_bits; }
+
+		void link(TimerWheelNode *node)
+		{
+			TimerWheelNode **slot;
+			if (node->expire_tick < current_tick + first_level_slots)
+			{
+				// Timers already expired go in the slot processed next
+				uint64_t tick = node->expire_tick < current_tick ? current_tick : node->expire_tick;
+				slot = &first_level[tick & first_level_mask];
+				num_first_level++;
+			}
+			else
+			{
+				int level = 0;
+				while (level < num_upper_levels - 1 && (node->expire_tick >> get_shift(level)) - (current_tick >> get_shift(level)) >= upper_level_slots)
+					level++;
+
+				uint64_t position = node->expire_tick >> get_shift(level);
+				uint64_t last_position = (current_tick >> get_shift(level)) + upper_level_slots - 1;
+				if (position > last_position)
+					position = last_position;	// Beyond the wheel, linked again when its slot is reached
+				slot = &upper_levels[level][position & upper_level_mask];
+			}
+
+			node->slot = slot;
+			node->prev = nullptr;
+			node->next = *slot;
+			if (node->next)
+				node->next->prev = node;
+			*slot = node;
+		}
+
+		void unlink(TimerWheelNode *node)
+		{
+			if (is_first_level(node->slot))
+				num_first_level--;
+			if (node->prev)
+				node->prev->next = node->next;
+			else
+				*node->slot = node->next;
+			if (node->next)
+				node->next->prev = node->prev;
+			node->prev = nullptr;
+			node->next = nullptr;
+			node->slot = nullptr;
+		}
+
+		bool is_first_level(TimerWheelNode **slot) const
+		{
+			return slot >= first_level && slot < first_level + first_level_slots;
+		}
+
+		void cascade()
+		{
+			for (int level = 0; level < num_upper_levels; level++)
+			{
+				int index = (int)((current_tick >> get_shift(level)) & upper_level_mask);
+
+				TimerWheelNode *node = upper_levels[level][index];
+				upper_levels[level][index] = nullptr;
+				while (node)
+				{
+					TimerWheelNode *next = node->next;
+					node->prev = nullptr;
+					node->next = nullptr;
+					node->slot = nullptr;
+					link(node);
+					node = next;
+				}
+
+				if (index != 0)
+					break;
+			}
+		}
+
+		uint64_t current_tick;
+		int num_timers = 0;
+		int num_first_level = 0;
+		TimerWheelNode *first_level[first_level_slots];
+		TimerWheelNode *upper_levels[num_upper_levels][upper_level_slots];
+	};
+}
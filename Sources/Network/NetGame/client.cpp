@@ -88,33 +88,31 @@ namespace clan
 
 	void NetGameClient::add_network_event(const NetGameNetworkEvent &e)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		impl->events.push_back(e);
+		NetGameClient_Impl *client_impl = impl.get();
+		impl->events.post([client_impl, e]() { client_impl->process_event(e); });
 	}
 
 	void NetGameClient_Impl::process()
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
-		std::vector<NetGameNetworkEvent> new_events;
-		new_events.swap(events);
-		mutex_lock.unlock();
-		for (auto & new_event : new_events)
+		events.process();
+	}
+
+	void NetGameClient_Impl::process_event(const NetGameNetworkEvent &new_event)
+	{
+		switch (new_event.type)
 		{
-			switch (new_event.type)
-			{
-			case NetGameNetworkEvent::client_connected:
-				sig_game_connected();
-				break;
-			case NetGameNetworkEvent::event_received:
-				sig_game_event_received(new_event.game_event);
-				break;
-			case NetGameNetworkEvent::client_disconnected:
-				sig_game_disconnected();
-				connection.reset();
-				break;
-			default:
-				throw Exception("Unknown server event type");
-			}
+		case NetGameNetworkEvent::client_connected:
+			sig_game_connected();
+			break;
+		case NetGameNetworkEvent::event_received:
+			sig_game_event_received(new_event.game_event);
+			break;
+		case NetGameNetworkEvent::client_disconnected:
+			sig_game_disconnected();
+			connection.reset();
+			break;
+		default:
+			throw Exception("Unknown server event type");
 		}
 	}
 }
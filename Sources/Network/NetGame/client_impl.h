@@ -29,7 +29,6 @@
 #pragma once
 
 #include <memory>
-#include <mutex>
 
 namespace clan
 {
@@ -37,9 +36,9 @@ namespace clan
 	{
 	public:
 		void process();
+		void process_event(const NetGameNetworkEvent &e);
 
-		std::recursive_mutex mutex;
-		std::vector<NetGameNetworkEvent> events;
+		SignalQueue events;
 
 		std::unique_ptr<NetGameConnection> connection;
 		Signal<void(const NetGameEvent &)> sig_game_event_received;
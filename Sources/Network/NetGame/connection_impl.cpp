@@ -34,6 +34,7 @@
 #include "network_event.h"
 #include "network_data.h"
 #include "connection_impl.h"
+#include "API/Core/System/profiler.h"
 
 namespace clan
 {
@@ -201,10 +202,13 @@ namespace clan
 
 			while (true)
 			{
-				if (read_connection_data(receive_buffer, bytes_received))
-					break;
-				if (write_connection_data(send_buffer, bytes_sent, send_graceful_close))
-					break;
+				{
+					CL_PROFILE_SCOPE("NetGameConnection_Impl::connection_main");
+					if (read_connection_data(receive_buffer, bytes_received))
+						break;
+					if (write_connection_data(send_buffer, bytes_sent, send_graceful_close))
+						break;
+				}
 
 				std::unique_lock<std::mutex> lock(mutex);
 				if (stop_flag)
@@ -46,8 +46,7 @@ namespace clan
 			if (size >= 2 + payload_size)
 			{
 				out_bytes_consumed = 2 + payload_size;
-				DataBuffer buffer(static_cast<const char*>(data)+2, payload_size);
-				return decode_event(buffer);
+				return decode_event(static_cast<const unsigned char*>(data) + 2, payload_size);
 			}
 		}
 
@@ -65,8 +64,11 @@ namespace clan
 
 	NetGameEvent NetGameNetworkData::decode_event(const DataBuffer &data)
 	{
-		const unsigned char *d = data.get_data<unsigned char>();
-		unsigned int length = data.get_size();
+		return decode_event(data.get_data<unsigned char>(), data.get_size());
+	}
+
+	NetGameEvent NetGameNetworkData::decode_event(const unsigned char *d, unsigned int length)
+	{
 		if (length < 3)
 			throw Exception("Invalid network data");
 
@@ -44,6 +44,7 @@ namespace clan
 
 	private:
 		static NetGameEvent decode_event(const DataBuffer &data);
+		static NetGameEvent decode_event(const unsigned char *d, unsigned int length);
 		static DataBuffer encode_event(const NetGameEvent &e);
 
 		static unsigned int get_encoded_length(const NetGameEventValue &value);
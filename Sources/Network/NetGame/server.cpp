@@ -54,8 +54,8 @@ namespace clan
 
 	void NetGameServer::add_network_event(const NetGameNetworkEvent &e)
 	{
-		std::unique_lock<std::mutex> mutex_lock(impl->mutex);
-		impl->events.push_back(e);
+		NetGameServer_Impl *server_impl = impl.get();
+		impl->events.post([server_impl, e]() { server_impl->process_event(e); });
 	}
 
 	void NetGameServer::send_event(const NetGameEvent &game_event)
@@ -142,42 +142,39 @@ namespace clan
 
 	void NetGameServer_Impl::process()
 	{
-		std::unique_lock<std::mutex> mutex_lock(mutex);
-		std::vector<NetGameNetworkEvent> new_events;
-		new_events.swap(events);
-		mutex_lock.unlock();
+		events.process();
+	}
 
-		for (auto & new_event : new_events)
+	void NetGameServer_Impl::process_event(const NetGameNetworkEvent &new_event)
+	{
+		switch (new_event.type)
 		{
-			switch (new_event.type)
-			{
-			case NetGameNetworkEvent::client_connected:
-				sig_game_client_connected(new_event.connection);
-				break;
-			case NetGameNetworkEvent::event_received:
-				sig_game_event_received(new_event.connection, new_event.game_event);
-				break;
-			case NetGameNetworkEvent::client_disconnected:
-			{
-				std::string reason = new_event.game_event.get_name();
-				sig_game_client_disconnected(new_event.connection, reason);
-			}
+		case NetGameNetworkEvent::client_connected:
+			sig_game_client_connected(new_event.connection);
+			break;
+		case NetGameNetworkEvent::event_received:
+			sig_game_event_received(new_event.connection, new_event.game_event);
+			break;
+		case NetGameNetworkEvent::client_disconnected:
+		{
+			std::string reason = new_event.game_event.get_name();
+			sig_game_client_disconnected(new_event.connection, reason);
+		}
 
-			// Destroy connection object
+		// Destroy connection object
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			std::vector<NetGameConnection *>::iterator connection_it;
+			connection_it = std::find(connections.begin(), connections.end(), new_event.connection);
+			if (connection_it != connections.end())
 			{
-				std::unique_lock<std::mutex> mutex_lock(mutex);
-				std::vector<NetGameConnection *>::iterator connection_it;
-				connection_it = std::find(connections.begin(), connections.end(), new_event.connection);
-				if (connection_it != connections.end())
-				{
-					connections.erase(connection_it);
-				}
-				delete new_event.connection;
-			}
-			break;
-			default:
-				throw Exception("Unknown server event type");
+				connections.erase(connection_it);
 			}
+			delete new_event.connection;
+		}
+		break;
+		default:
+			throw Exception("Unknown server event type");
 		}
 	}
 }
@@ -39,6 +39,7 @@ namespace clan
 	{
 	public:
 		void process();
+		void process_event(const NetGameNetworkEvent &e);
 
 		std::unique_ptr<TCPListen> tcp_listen;
 		std::thread listen_thread;
@@ -47,7 +48,7 @@ namespace clan
 		std::mutex mutex;
 		bool stop_flag = false;
 		std::vector<NetGameConnection *> connections;
-		std::vector<NetGameNetworkEvent> events;
+		SignalQueue events;
 
 		Signal<void(NetGameConnection *)> sig_game_client_connected;
 		Signal<void(NetGameConnection *, const std::string &)> sig_game_client_disconnected;
@@ -30,6 +30,7 @@
 #include "API/Sound/SoundProviders/soundprovider_vorbis.h"
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/IOData/file_system.h"
+#include "API/Core/IOData/file.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/IOData/path_help.h"
 #include "soundprovider_vorbis_impl.h"
@@ -51,11 +52,7 @@ namespace clan
 		const std::string &fullname, bool stream)
 		: impl(std::make_shared<SoundProvider_Vorbis_Impl>())
 	{
-		std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
-		std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
-		FileSystem vfs(path);
-		IODevice input = vfs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-		impl->load(input);
+		impl->mapping = File::map(fullname, FileMapping::access_sequential);
 	}
 
 	SoundProvider_Vorbis::SoundProvider_Vorbis(
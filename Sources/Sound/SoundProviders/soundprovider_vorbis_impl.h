@@ -30,6 +30,7 @@
 
 #include "API/Sound/soundformat.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/IOData/file_mapping.h"
 #include <string>
 
 namespace clan
@@ -39,6 +40,12 @@ namespace clan
 	public:
 		void load(IODevice &input);
 
+		// stb_vorbis only reads the data, but its pushdata functions take non-const pointers
+		unsigned char *get_data() const { return const_cast<unsigned char*>(mapping.is_null() ? buffer.get_data<unsigned char>() : mapping.get_data<unsigned char>()); }
+		int get_size() const { return mapping.is_null() ? (int)buffer.get_size() : (int)mapping.get_size(); }
+
+		// Files are decoded straight from the mapping when possible, else from a copy in buffer
+		FileMapping mapping;
 		DataBuffer buffer;
 	};
 }
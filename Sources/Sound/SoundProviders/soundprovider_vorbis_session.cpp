@@ -40,7 +40,7 @@ namespace clan
 		source(source), position(0), stream_eof(false), handle(nullptr), stream_byte_offset(0), pcm(nullptr), pcm_position(0), pcm_samples(0)
 	{
 		int error = 0;
-		handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
+		handle = stb_vorbis_open_pushdata(source.impl->get_data(), source.impl->get_size(), &stream_byte_offset, &error, nullptr);
 		if (handle == nullptr)
 			throw Exception("Unable to read ogg file");
 
@@ -98,7 +98,7 @@ namespace clan
 		stream_byte_offset = 0;
 
 		int error = 0;
-		handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
+		handle = stb_vorbis_open_pushdata(source.impl->get_data(), source.impl->get_size(), &stream_byte_offset, &error, nullptr);
 		if (handle == nullptr)
 			throw Exception("Unable to read ogg file");
 
@@ -117,9 +117,9 @@ namespace clan
 				pcm = nullptr;
 				pcm_position = 0;
 				pcm_samples = 0;
-				int bytes_used = stb_vorbis_decode_frame_pushdata(handle, source.impl->buffer.get_data<unsigned char>() + stream_byte_offset, source.impl->buffer.get_size() - stream_byte_offset, nullptr, &pcm, &pcm_samples);
+				int bytes_used = stb_vorbis_decode_frame_pushdata(handle, source.impl->get_data() + stream_byte_offset, source.impl->get_size() - stream_byte_offset, nullptr, &pcm, &pcm_samples);
 				stream_byte_offset += bytes_used;
-				if (bytes_used == 0 || stream_byte_offset == source.impl->buffer.get_size())
+				if (bytes_used == 0 || stream_byte_offset == source.impl->get_size())
 				{
 					stream_eof = true;
 					break;
@@ -32,11 +32,12 @@
 #include "API/Core/Text/string_help.h"
 #include "API/Core/IOData/path_help.h"
 #include "API/Core/IOData/iodevice.h"
-#include "API/Core/IOData/cl_endian.h"
+#include "API/Core/IOData/buffered_iodevice.h"
 #include "API/Core/Text/string_format.h"
 #include "API/Core/Text/logger.h"
 #include "soundprovider_wave_impl.h"
 #include "soundprovider_wave_session.h"
+#include <algorithm>
 
 namespace clan
 {
@@ -81,8 +82,9 @@ namespace clan
 		delete session;
 	}
 
-	void SoundProvider_Wave_Impl::load(IODevice &source)
+	void SoundProvider_Wave_Impl::load(IODevice &device)
 	{
+		BufferedIODevice source(device);
 		source.set_little_endian_mode();
 
 		char chunk_id[4];
@@ -116,7 +118,24 @@ namespace clan
 		uint32_t subchunk2_size = find_subchunk("data", source, subchunk_pos, chunk_size);
 
 		data = new char[subchunk2_size];
-		source.read(data, subchunk2_size);
+
+		// A truncated data chunk is loaded as far as it goes
+		uint32_t data_size = subchunk2_size;
+		int64_t file_size = source.get_size64();
+		if (file_size >= 0)
+			data_size = (uint32_t)std::min<int64_t>(data_size, std::max<int64_t>(file_size - source.get_position64(), 0));
+
+		// Samples are stored little endian, read_uint16_array swaps them in bulk on big endian systems
+		if (format == sf_16bit_signed)
+		{
+			source.read_uint16_array(reinterpret_cast<uint16_t *>(data), data_size / 2);
+			data_size &= ~1;
+		}
+		else
+		{
+			source.read(data, data_size);
+		}
+		memset(data + data_size, 0, subchunk2_size - data_size);
 
 		num_samples = subchunk2_size / block_align;
 	}
@@ -48,6 +48,7 @@
 #include "view_action_impl.h"
 #include "flex_layout.h"
 #include "custom_layout.h"
+#include "API/Core/System/profiler.h"
 #include <algorithm>
 
 namespace clan
@@ -961,6 +962,7 @@ namespace clan
 
 	void ViewImpl::update_style_cascade() const
 	{
+		CL_PROFILE_SCOPE("ViewImpl::update_style_cascade");
 		std::vector<std::pair<Style *, size_t>> matches;
 
 		for (auto it : styles)
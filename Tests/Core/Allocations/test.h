@@ -23,47 +23,33 @@
 **
 **  File Author(s):
 **
-**    Mark Page
+**    Magnus Norddahl
 */
 
 #pragma once
 
-#include "tests.h"
+#include <ClanLib/core.h>
+#include <cstddef>
 
-class App : public clan::Application
+using namespace clan;
+
+/// \brief Heap allocations made through operator new between begin and end
+class AllocationCounter
 {
 public:
-	App();
-	bool update() override;
+	static void begin();
+	static void end();
 
-private:
-	void on_input_up(const clan::InputEvent &key);
-	void on_window_close();
-	void initial_pause();
-	void initialise_1();
-	void initialise_2();
-	void write_result();
-	void test();
-	void draw_info(const std::string &text);
-	int64_t run_test();
-	uint64_t get_start_time() const;
-private:
-	bool quit;
-	std::function<void()> cb_main;
-	std::function<void()> cb_test;
-	clan::DisplayWindow window;
-	clan::Canvas canvas;
-	clan::Font font;
-	clan::GameTime game_time;
-	Tests tests;
-	uint64_t num_iterations;
-	uint64_t base_line;
-	int testlist_offset;
-	std::vector<TestInfo> testlist;
-	uint64_t tests_run_length_microseconds;
-	float target_test_run_length_seconds;
-	std::string priority_class;
-	clan::SlotContainer sc;
+	static int get_count();
+	static size_t get_total_size();
+};
 
+class TestApp
+{
+public:
+	int main();
+private:
+	void test_databuffer();
 
+	void fail(void);
 };
@@ -0,0 +1,76 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+
+void TestApp::test_databuffer()
+{
+	Console::write_line(" Header: databuffer.h");
+	Console::write_line("  Class: DataBuffer");
+
+	Console::write_line("   Function: DataBuffer()");
+	{
+		AllocationCounter::begin();
+		DataBuffer empty;
+		DataBuffer copy = empty;
+		DataBuffer moved(std::move(copy));
+		DataBuffer empty_slice = empty.slice(0, 0);
+		AllocationCounter::end();
+		if (AllocationCounter::get_count() != 0) fail();
+	}
+
+	Console::write_line("   Function: DataBuffer(const void *data, unsigned int size)");
+	{
+		// Small payloads are stored with the reference counted impl
+		AllocationCounter::begin();
+		DataBuffer small("0123456789", 10);
+		AllocationCounter::end();
+		if (AllocationCounter::get_count() != 1) fail();
+		size_t small_impl_size = AllocationCounter::get_total_size();
+
+		// Larger buffers do not carry the inline storage
+		AllocationCounter::begin();
+		DataBuffer large(100000);
+		AllocationCounter::end();
+		if (AllocationCounter::get_count() != 1) fail();
+		size_t large_impl_size = AllocationCounter::get_total_size();
+		if (large_impl_size + 64 > small_impl_size) fail();
+		Console::write_line("    Impl allocation: %1 bytes small, %2 bytes large", (int)small_impl_size, (int)large_impl_size);
+	}
+
+	Console::write_line("   Function: slice()");
+	{
+		DataBuffer buffer("0123456789", 10);
+		AllocationCounter::begin();
+		DataBuffer slice = buffer.slice(2, 6);
+		DataBuffer copy = slice;
+		DataBuffer moved(std::move(copy));
+		AllocationCounter::end();
+		if (AllocationCounter::get_count() != 1) fail();
+	}
+}
@@ -0,0 +1,203 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "precomp.h"
+#include "benchmark.h"
+#include <algorithm>
+
+void BenchmarkRunner::add(const std::string &name, std::function<void()> func, uint64_t bytes_per_call)
+{
+	cases.push_back(BenchmarkCase(name, std::move(func), bytes_per_call));
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(const BenchmarkSettings &settings) const
+{
+	std::vector<BenchmarkResult> results;
+	for (const auto &benchmark : cases)
+	{
+		if (!settings.filter.empty() && benchmark.name.find(settings.filter) == std::string::npos)
+			continue;
+
+		clan::Console::write_line("Running: %1", benchmark.name);
+		results.push_back(run_case(benchmark, settings));
+	}
+	return results;
+}
+
+BenchmarkResult BenchmarkRunner::run_case(const BenchmarkCase &benchmark, const BenchmarkSettings &settings)
+{
+	// Warm up caches, branch predictors and the CPU clock frequency
+	uint64_t warmup_end = clan::System::get_microseconds() + (uint64_t)settings.warmup_ms * 1000;
+	do
+	{
+		benchmark.func();
+	} while (clan::System::get_microseconds() < warmup_end);
+
+	// Find the number of calls needed for a sample to take sample_ms
+	uint64_t sample_us = std::max(settings.sample_ms, 1) * (uint64_t)1000;
+	uint64_t num_calls = 1;
+	uint64_t elapsed_us = time_calls(benchmark, num_calls);
+	while (elapsed_us < sample_us / 8)
+	{
+		num_calls *= 2;
+		elapsed_us = time_calls(benchmark, num_calls);
+	}
+	num_calls = std::max((uint64_t)1, num_calls * sample_us / std::max(elapsed_us, (uint64_t)1));
+
+	std::vector<double> samples;
+	for (int i = 0; i < std::max(settings.repetitions, 1); i++)
+		samples.push_back(time_calls(benchmark, num_calls) * 1000.0 / num_calls);
+	std::sort(samples.begin(), samples.end());
+
+	BenchmarkResult result;
+	result.name = benchmark.name;
+	result.calls_per_sample = num_calls;
+	result.num_samples = (int)samples.size();
+	result.min_ns = samples.front();
+	result.max_ns = samples.back();
+
+	size_t middle = samples.size() / 2;
+	result.median_ns = (samples.size() % 2) ? samples[middle] : (samples[middle - 1] + samples[middle]) * 0.5;
+
+	double sum = 0.0;
+	for (double sample : samples)
+		sum += sample;
+	result.mean_ns = sum / samples.size();
+
+	double variance = 0.0;
+	for (double sample : samples)
+		variance += (sample - result.mean_ns) * (sample - result.mean_ns);
+	result.stddev_ns = std::sqrt(variance / samples.size());
+
+	if (benchmark.bytes_per_call && result.median_ns > 0.0)
+		result.megabytes_per_second = benchmark.bytes_per_call * 1000.0 / result.median_ns;
+
+	return result;
+}
+
+uint64_t BenchmarkRunner::time_calls(const BenchmarkCase &benchmark, uint64_t num_calls)
+{
+	uint64_t start_time = clan::System::get_microseconds();
+	for (uint64_t i = 0; i < num_calls; i++)
+		benchmark.func();
+	return clan::System::get_microseconds() - start_time;
+}
+
+int BenchmarkRunner::compare_baseline(std::vector<BenchmarkResult> &results, const std::string &filename, const BenchmarkSettings &settings)
+{
+	clan::JsonValue baseline = clan::JsonValue::parse(clan::File::read_text(filename));
+
+	std::map<std::string, double> baseline_medians;
+	for (const auto &item : baseline.prop("results").items())
+		baseline_medians[item.prop("name").to_string()] = item.prop("median_ns").to_double();
+
+	int num_regressions = 0;
+	for (auto &result : results)
+	{
+		auto it = baseline_medians.find(result.name);
+		if (it == baseline_medians.end() || it->second <= 0.0)
+			continue;
+
+		result.baseline_median_ns = it->second;
+		result.change_percent = (result.median_ns - it->second) * 100.0 / it->second;
+		if (result.change_percent > settings.regression_threshold)
+			num_regressions++;
+	}
+	return num_regressions;
+}
+
+std::string BenchmarkRunner::to_json(const std::vector<BenchmarkResult> &results, const BenchmarkSettings &settings)
+{
+	clan::JsonValue json = clan::JsonValue::object();
+	json.prop("warmup_ms") = clan::JsonValue::number(settings.warmup_ms);
+	json.prop("sample_ms") = clan::JsonValue::number(settings.sample_ms);
+	json.prop("repetitions") = clan::JsonValue::number(settings.repetitions);
+
+	clan::JsonValue &items = json.prop("results");
+	items = clan::JsonValue::array();
+	for (const auto &result : results)
+	{
+		clan::JsonValue item = clan::JsonValue::object();
+		item.prop("name") = clan::JsonValue::string(result.name);
+		item.prop("calls_per_sample") = clan::JsonValue::number((double)result.calls_per_sample);
+		item.prop("samples") = clan::JsonValue::number(result.num_samples);
+		item.prop("mean_ns") = clan::JsonValue::number(result.mean_ns);
+		item.prop("median_ns") = clan::JsonValue::number(result.median_ns);
+		item.prop("min_ns") = clan::JsonValue::number(result.min_ns);
+		item.prop("max_ns") = clan::JsonValue::number(result.max_ns);
+		item.prop("stddev_ns") = clan::JsonValue::number(result.stddev_ns);
+		if (result.megabytes_per_second > 0.0)
+			item.prop("megabytes_per_second") = clan::JsonValue::number(result.megabytes_per_second);
+		if (result.baseline_median_ns > 0.0)
+		{
+			item.prop("baseline_median_ns") = clan::JsonValue::number(result.baseline_median_ns);
+			item.prop("change_percent") = clan::JsonValue::number(result.change_percent);
+		}
+		items.items().push_back(item);
+	}
+	return json.to_json();
+}
+
+std::string BenchmarkRunner::to_csv(const std::vector<BenchmarkResult> &results)
+{
+	std::string csv = "name,calls_per_sample,samples,mean_ns,median_ns,min_ns,max_ns,stddev_ns,megabytes_per_second,baseline_median_ns,change_percent\n";
+	for (const auto &result : results)
+	{
+		// Quote the name, as names are code snippets that may contain commas
+		std::string name = result.name;
+		for (size_t pos = name.find('"'); pos != std::string::npos; pos = name.find('"', pos + 2))
+			name.insert(pos, 1, '"');
+
+		csv += clan::string_format("\"%1\",%2,%3,", name, clan::StringHelp::ull_to_text(result.calls_per_sample), result.num_samples);
+		csv += clan::string_format("%1,%2,%3,%4,%5,",
+			clan::StringHelp::double_to_text(result.mean_ns, 2), clan::StringHelp::double_to_text(result.median_ns, 2),
+			clan::StringHelp::double_to_text(result.min_ns, 2), clan::StringHelp::double_to_text(result.max_ns, 2),
+			clan::StringHelp::double_to_text(result.stddev_ns, 2));
+		csv += clan::string_format("%1,%2,%3\n",
+			clan::StringHelp::double_to_text(result.megabytes_per_second, 2),
+			clan::StringHelp::double_to_text(result.baseline_median_ns, 2),
+			clan::StringHelp::double_to_text(result.change_percent, 2));
+	}
+	return csv;
+}
+
+void BenchmarkRunner::print(const std::vector<BenchmarkResult> &results)
+{
+	clan::Console::write_line("");
+	clan::Console::write_line("Median ns (+- stddev) : Benchmark");
+	for (const auto &result : results)
+	{
+		std::string line = clan::string_format("%1 (+- %2) : %3", clan::StringHelp::double_to_text(result.median_ns, 1), clan::StringHelp::double_to_text(result.stddev_ns, 1), result.name);
+		if (result.megabytes_per_second > 0.0)
+			line += clan::string_format(" [%1 MB/s]", clan::StringHelp::double_to_text(result.megabytes_per_second, 1));
+		if (result.baseline_median_ns > 0.0)
+			line += clan::string_format(" [%1%2% vs baseline]", result.change_percent >= 0.0 ? "+" : "", clan::StringHelp::double_to_text(result.change_percent, 1));
+		clan::Console::write_line(line);
+	}
+}
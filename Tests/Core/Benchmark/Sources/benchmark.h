@@ -0,0 +1,103 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+/// \brief A registered benchmark
+class BenchmarkCase
+{
+public:
+	BenchmarkCase(const std::string &name, std::function<void()> func, uint64_t bytes_per_call) : name(name), func(std::move(func)), bytes_per_call(bytes_per_call) { }
+
+	std::string name;
+	std::function<void()> func;
+	uint64_t bytes_per_call;
+};
+
+/// \brief Timings of one benchmark, all in nanoseconds per call
+class BenchmarkResult
+{
+public:
+	std::string name;
+	uint64_t calls_per_sample = 0;
+	int num_samples = 0;
+	double mean_ns = 0.0;
+	double median_ns = 0.0;
+	double min_ns = 0.0;
+	double max_ns = 0.0;
+	double stddev_ns = 0.0;
+	double megabytes_per_second = 0.0;	// Zero if the benchmark does not process a known amount of data
+
+	double baseline_median_ns = 0.0;	// Zero if the benchmark is not in the baseline
+	double change_percent = 0.0;		// Median change relative to the baseline, positive is slower
+};
+
+class BenchmarkSettings
+{
+public:
+	int warmup_ms = 200;
+	int sample_ms = 50;
+	int repetitions = 15;
+	std::string filter;				// Only run benchmarks with names containing this text
+	double regression_threshold = 5.0;	// Percent slower than the baseline before a result counts as a regression
+};
+
+/// \brief Runs registered benchmarks without any display or window
+class BenchmarkRunner
+{
+public:
+	/// \brief Registers a benchmark
+	///
+	/// \param bytes_per_call = Data processed by each call, used to report throughput
+	void add(const std::string &name, std::function<void()> func, uint64_t bytes_per_call = 0);
+
+	const std::vector<BenchmarkCase> &get_cases() const { return cases; }
+
+	/// \brief Runs all benchmarks matching the filter, writing progress to the console
+	std::vector<BenchmarkResult> run(const BenchmarkSettings &settings) const;
+
+	/// \brief Fills in the baseline fields of the results from a JSON file written by to_json
+	///
+	/// \return Number of results slower than the baseline by more than the regression threshold
+	static int compare_baseline(std::vector<BenchmarkResult> &results, const std::string &filename, const BenchmarkSettings &settings);
+
+	static std::string to_json(const std::vector<BenchmarkResult> &results, const BenchmarkSettings &settings);
+	static std::string to_csv(const std::vector<BenchmarkResult> &results);
+
+	static void print(const std::vector<BenchmarkResult> &results);
+
+private:
+	static BenchmarkResult run_case(const BenchmarkCase &benchmark, const BenchmarkSettings &settings);
+	static uint64_t time_calls(const BenchmarkCase &benchmark, uint64_t num_calls);
+
+	std::vector<BenchmarkCase> cases;
+};
+
+/// \brief Registers benchmarks of ClanLib library hot paths
+void add_library_benchmarks(BenchmarkRunner &runner);
@@ -0,0 +1,206 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "precomp.h"
+#include "benchmark.h"
+
+// NetGameNetworkData is internal to clanNetwork, so the ClanLib Sources directory must be in the include path
+#include "Network/NetGame/network_data.h"
+
+namespace
+{
+	std::string create_text(int size)
+	{
+		const char *words[] = { "ClanLib ", "game ", "sdk ", "render ", "sound ", "network ", "the ", "canvas ", "sprite ", "font " };
+		std::string text;
+		unsigned int seed = 12345;
+		while ((int)text.size() < size)
+		{
+			seed = seed * 1103515245 + 12345;
+			text += words[(seed >> 16) % 10];
+		}
+		text.resize(size);
+		return text;
+	}
+
+	std::string create_json(int num_items)
+	{
+		clan::JsonValue json = clan::JsonValue::object();
+		json.prop("name") = clan::JsonValue::string("benchmark");
+		clan::JsonValue &items = json.prop("items");
+		items = clan::JsonValue::array();
+		for (int i = 0; i < num_items; i++)
+		{
+			clan::JsonValue item = clan::JsonValue::object();
+			item.prop("id") = clan::JsonValue::number(i);
+			item.prop("position") = clan::JsonValue::number(i * 0.25);
+			item.prop("visible") = clan::JsonValue::boolean(i % 2 == 0);
+			item.prop("label") = clan::JsonValue::string(clan::string_format("Item %1", i));
+			items.items().push_back(item);
+		}
+		return json.to_json();
+	}
+
+	std::string create_xml(int num_items)
+	{
+		std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<resources>\n";
+		for (int i = 0; i < num_items; i++)
+			xml += clan::string_format("\t<sprite name=\"sprite%1\" x=\"%2\" y=\"%3\">\n\t\t<image file=\"images/sprite%1.png\" />\n\t</sprite>\n", i, i * 16, i * 8);
+		xml += "</resources>\n";
+		return xml;
+	}
+
+	void add_math_benchmarks(BenchmarkRunner &runner)
+	{
+		struct State
+		{
+			clan::Mat4f a = clan::Mat4f::rotate(clan::Angle(10.0f, clan::angle_degrees), 0.0f, 1.0f, 0.0f);
+			clan::Mat4f b = clan::Mat4f::translate(1.0f, 2.0f, 3.0f);
+			clan::Mat4f result;
+		};
+		auto state = std::make_shared<State>();
+		runner.add("Mat4f::multiply", [=]() { state->result = clan::Mat4f::multiply(state->a, state->b); state->a.matrix[12] = state->result.matrix[0]; });
+		runner.add("Mat4f::inverse", [=]() { state->result = clan::Mat4f::inverse(state->a); });
+	}
+
+	void add_pixel_converter_benchmarks(BenchmarkRunner &runner)
+	{
+		const int width = 256;
+		const int height = 256;
+
+		struct State
+		{
+			clan::PixelConverter converter;
+			std::vector<unsigned char> input;
+			std::vector<unsigned char> output;
+		};
+		auto state = std::make_shared<State>();
+		state->input.resize(width * height * 4);
+		state->output.resize(width * height * 4);
+		for (size_t i = 0; i < state->input.size(); i++)
+			state->input[i] = (unsigned char)(i * 7);
+
+		runner.add("PixelConverter::convert rgba8 to bgra8 (256x256)", [=]()
+		{
+			state->converter.convert(state->output.data(), width * 4, clan::tf_bgra8, state->input.data(), width * 4, clan::tf_rgba8, width, height);
+		}, width * height * 4);
+
+		runner.add("PixelConverter::convert rgb8 to rgba8 (256x256)", [=]()
+		{
+			state->converter.convert(state->output.data(), width * 4, clan::tf_rgba8, state->input.data(), width * 3, clan::tf_rgb8, width, height);
+		}, width * height * 3);
+	}
+
+	void add_zlib_benchmarks(BenchmarkRunner &runner)
+	{
+		std::string text = create_text(64 * 1024);
+		clan::DataBuffer data(text.data(), text.size());
+		clan::DataBuffer compressed = clan::ZLibCompression::compress(data);
+
+		runner.add("ZLibCompression::compress (64 KB)", [=]() { clan::ZLibCompression::compress(data); }, data.get_size());
+		runner.add("ZLibCompression::decompress (64 KB)", [=]() { clan::ZLibCompression::decompress(compressed); }, data.get_size());
+	}
+
+	void add_crypto_benchmarks(BenchmarkRunner &runner)
+	{
+		std::string text = create_text(64 * 1024);
+		clan::DataBuffer data(text.data(), text.size());
+
+		runner.add("SHA1 (64 KB)", [=]()
+		{
+			clan::SHA1 sha1;
+			sha1.add(data);
+			sha1.calculate();
+		}, data.get_size());
+
+		runner.add("SHA256 (64 KB)", [=]()
+		{
+			clan::SHA256 sha256;
+			sha256.add(data);
+			sha256.calculate();
+		}, data.get_size());
+
+		runner.add("AES128_Encrypt (64 KB)", [=]()
+		{
+			const unsigned char key[clan::AES128_Encrypt::key_size] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+			const unsigned char iv[clan::AES128_Encrypt::iv_size] = { 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 };
+			clan::AES128_Encrypt aes;
+			aes.set_key(key);
+			aes.set_iv(iv);
+			aes.add(data);
+			aes.calculate();
+		}, data.get_size());
+	}
+
+	void add_text_benchmarks(BenchmarkRunner &runner)
+	{
+		std::string json = create_json(500);
+		runner.add("JsonValue::parse (500 objects)", [=]() { clan::JsonValue::parse(json); }, json.size());
+
+		clan::JsonValue value = clan::JsonValue::parse(json);
+		runner.add("JsonValue::to_json (500 objects)", [=]() { value.to_json(); }, json.size());
+
+		std::string xml = create_xml(500);
+		runner.add("DomDocument load (500 elements)", [=]()
+		{
+			clan::DataBuffer buffer(xml.data(), xml.size());
+			clan::MemoryDevice device(buffer);
+			clan::DomDocument document(device);
+		}, xml.size());
+	}
+
+	void add_network_benchmarks(BenchmarkRunner &runner)
+	{
+		clan::NetGameEvent event("player-moved");
+		event.add_argument(42);
+		event.add_argument(10.5f);
+		event.add_argument(-3.25f);
+		event.add_argument("walking");
+		event.add_argument(clan::NetGameEventValue(true));
+
+		runner.add("NetGameNetworkData::send_data (5 arguments)", [=]() { clan::NetGameNetworkData::send_data(event); });
+
+		clan::DataBuffer packet = clan::NetGameNetworkData::send_data(event);
+		runner.add("NetGameNetworkData::receive_data (5 arguments)", [=]()
+		{
+			int bytes_consumed = 0;
+			clan::NetGameNetworkData::receive_data(packet.get_data(), packet.get_size(), bytes_consumed);
+		}, packet.get_size());
+	}
+}
+
+void add_library_benchmarks(BenchmarkRunner &runner)
+{
+	add_math_benchmarks(runner);
+	add_pixel_converter_benchmarks(runner);
+	add_zlib_benchmarks(runner);
+	add_crypto_benchmarks(runner);
+	add_text_benchmarks(runner);
+	add_network_benchmarks(runner);
+}
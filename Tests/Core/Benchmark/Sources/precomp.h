@@ -1,9 +1,8 @@
 #pragma once
 
 #include <ClanLib/core.h>
-#include <ClanLib/application.h>
 #include <ClanLib/display.h>
-#include <ClanLib/gl.h>
+#include <ClanLib/network.h>
+#include <ClanLib/xml.h>
 #include <cmath>
 
-
@@ -0,0 +1,146 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "precomp.h"
+#include "benchmark.h"
+#include "tests.h"
+
+namespace
+{
+	void print_usage()
+	{
+		clan::Console::write_line("Usage: benchmark [options]");
+		clan::Console::write_line("  --list                List the benchmarks and exit");
+		clan::Console::write_line("  --filter <text>       Only run benchmarks with names containing text");
+		clan::Console::write_line("  --warmup-ms <n>       Time each benchmark runs before measuring (default 200)");
+		clan::Console::write_line("  --sample-ms <n>       Length of each measured repetition (default 50)");
+		clan::Console::write_line("  --repetitions <n>     Number of measured repetitions (default 15)");
+		clan::Console::write_line("  --json <file>         Write results as JSON, usable as a baseline");
+		clan::Console::write_line("  --csv <file>          Write results as CSV");
+		clan::Console::write_line("  --baseline <file>     Compare against results from an earlier --json run");
+		clan::Console::write_line("  --threshold <percent> Slowdown counted as a regression (default 5)");
+		clan::Console::write_line("Returns 1 if any benchmark regressed against the baseline.");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	try
+	{
+		BenchmarkSettings settings;
+		std::string json_filename, csv_filename, baseline_filename;
+		bool list_only = false;
+
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+			if (arg == "--list")
+			{
+				list_only = true;
+				continue;
+			}
+
+			if (i + 1 == argc || arg.compare(0, 2, "--") != 0)
+			{
+				print_usage();
+				return 2;
+			}
+
+			std::string value = argv[++i];
+			if (arg == "--filter")
+				settings.filter = value;
+			else if (arg == "--warmup-ms")
+				settings.warmup_ms = clan::StringHelp::text_to_int(value);
+			else if (arg == "--sample-ms")
+				settings.sample_ms = clan::StringHelp::text_to_int(value);
+			else if (arg == "--repetitions")
+				settings.repetitions = clan::StringHelp::text_to_int(value);
+			else if (arg == "--json")
+				json_filename = value;
+			else if (arg == "--csv")
+				csv_filename = value;
+			else if (arg == "--baseline")
+				baseline_filename = value;
+			else if (arg == "--threshold")
+				settings.regression_threshold = clan::StringHelp::text_to_double(value);
+			else
+			{
+				print_usage();
+				return 2;
+			}
+		}
+
+		Tests tests;
+		std::vector<TestInfo> testlist;
+		Tests::Init(testlist);
+
+		BenchmarkRunner runner;
+		for (const auto &info : testlist)
+		{
+			auto func = info.func;
+			runner.add(info.name, [&tests, func]() { (tests.*func)(); });
+		}
+		add_library_benchmarks(runner);
+
+		if (list_only)
+		{
+			for (const auto &benchmark : runner.get_cases())
+				clan::Console::write_line(benchmark.name);
+			return 0;
+		}
+
+		clan::Console::write_line("ClanLib Benchmark Utility");
+		clan::Console::write_line("Warmup %1 ms, %2 repetitions of %3 ms", settings.warmup_ms, settings.repetitions, settings.sample_ms);
+
+		std::vector<BenchmarkResult> results = runner.run(settings);
+
+		int num_regressions = 0;
+		if (!baseline_filename.empty())
+			num_regressions = BenchmarkRunner::compare_baseline(results, baseline_filename, settings);
+
+		BenchmarkRunner::print(results);
+
+		if (!json_filename.empty())
+			clan::File::write_text(json_filename, BenchmarkRunner::to_json(results, settings));
+		if (!csv_filename.empty())
+			clan::File::write_text(csv_filename, BenchmarkRunner::to_csv(results));
+
+		if (num_regressions > 0)
+		{
+			clan::Console::write_line("%1 benchmark(s) regressed by more than %2%", num_regressions, clan::StringHelp::double_to_text(settings.regression_threshold, 1));
+			return 1;
+		}
+		return 0;
+	}
+	catch (clan::Exception &error)
+	{
+		clan::Console::write_line("Exception caught: %1", error.message);
+		return 2;
+	}
+}
@@ -74,8 +74,8 @@ public:
 	void test_double_multiply();
 	void test_double_divide();
 
-	void Tests::test_pointer_index();
-	void Tests::test_shared_index();
+	void test_pointer_index();
+	void test_shared_index();
 
 	void test_create_string_from_15chars();
 	void test_create_new_string_from_15chars();
@@ -0,0 +1,111 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <thread>
+
+static Task<int> coroutine_pipeline(WorkQueue queue, TaskExecutor main_thread, std::thread::id main_thread_id, bool &switched)
+{
+	co_await resume_on_worker(queue);
+	bool on_worker = std::this_thread::get_id() != main_thread_id;
+	DataBuffer data = co_await File::read_bytes_async(queue, "test.cpp");
+	int size = data.get_size();
+	co_await main_thread;
+	switched = on_worker && std::this_thread::get_id() == main_thread_id;
+	co_return size;
+}
+
+static Task<void> coroutine_failing(WorkQueue queue)
+{
+	co_await resume_on_worker(queue);
+	throw Exception("failed");
+}
+
+static Task<int> coroutine_ready(int &steps)
+{
+	// Awaiting a task that is already ready does not suspend
+	int value = co_await Task<int>::from_value(20);
+	steps++;
+	co_await Task<void>::from_value();
+	steps++;
+	co_return value + 1;
+}
+
+void TestApp::test_task()
+{
+	Console::write_line(" Header: task.h");
+	Console::write_line("  Class: Task");
+
+	WorkQueue queue;
+
+	// Stand-in for RunLoop::resume_on_main, which lives in clanDisplay
+	TaskExecutor main_thread([&](const std::function<void()> &work) { queue.work_completed(work); });
+	std::thread::id main_thread_id = std::this_thread::get_id();
+
+	Console::write_line("   Function: co_await");
+	{
+		bool switched = false;
+		Task<int> task = coroutine_pipeline(queue, main_thread, main_thread_id, switched);
+		while (!task.is_ready())
+		{
+			queue.process_work_completed();
+			System::sleep(1);
+		}
+		if (task.get() != (int)File::read_bytes("test.cpp").get_size()) fail();
+		if (!switched) fail();
+	}
+
+	Console::write_line("   Function: co_await on ready tasks");
+	{
+		int steps = 0;
+		Task<int> task = coroutine_ready(steps);
+		if (!task.is_ready() || steps != 2) fail();
+		if (task.get() != 21) fail();
+	}
+
+	Console::write_line("   Function: exceptions thrown in a coroutine");
+	{
+		Task<void> task = coroutine_failing(queue);
+		bool thrown = false;
+		try
+		{
+			task.get();
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+	}
+
+	while (queue.get_items_queued() > 0)
+	{
+		queue.process_work_completed();
+		System::sleep(1);
+	}
+}
@@ -78,6 +78,11 @@ int TestApp::main()
 		test_directory_scanner();
 		test_iodevice();
 		test_iodevice_memory();
+		test_buffered_iodevice();
+		test_file_mapping();
+		test_iodevice_64();
+		test_async_file_reader();
+		test_overlay_file_system();
 		test_virtual_directory_part2();
 		
 		Console::write_line("All Tests Complete");
@@ -66,6 +66,11 @@ private:
 	void test_datatypes(void);
 	void test_directory_scanner(void);
 	void test_iodevice_memory(void);
+	void test_buffered_iodevice(void);
+	void test_file_mapping(void);
+	void test_iodevice_64(void);
+	void test_async_file_reader(void);
+	void test_overlay_file_system(void);
 	void test_iodevice(void);
 	void test_virtual_directory_part2(void);
 	void fail(void);
@@ -0,0 +1,159 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+namespace
+{
+	// Provider that is not on disk, so FileSystem::read_async goes through the worker threads
+	class MemoryFileSystemProvider : public FileSystemProvider
+	{
+	public:
+		MemoryFileSystemProvider(const DataBuffer &contents) : contents(contents) { }
+
+		IODevice open_file(const std::string &filename, File::OpenMode mode, unsigned int access, unsigned int share, unsigned int flags) override
+		{
+			if (filename != "memory.bin")
+				throw Exception("File not found");
+			DataBuffer copy(contents);
+			return MemoryDevice(copy);
+		}
+
+		bool initialize_directory_listing(const std::string &path) override { return false; }
+		bool next_file(DirectoryListingEntry &entry) override { return false; }
+		std::string get_path() const override { return std::string(); }
+		std::string get_identifier() const override { return "memory"; }
+
+	private:
+		DataBuffer contents;
+	};
+}
+
+void TestApp::test_async_file_reader(void)
+{
+	Console::write_line(" Header: async_file_reader.h");
+	Console::write_line("  Class: AsyncFileReader");
+
+	const std::string filename = "test_async_file_reader.tmp";
+	DataBuffer contents(300000);
+	for (unsigned int i = 0; i < contents.get_size(); i++)
+		contents[i] = (char)(i * 7);
+	File::write_bytes(filename, contents);
+
+	std::vector<AsyncFileReader::Backend> backends;
+	backends.push_back(AsyncFileReader::backend_thread_pool);
+	if (AsyncFileReader(AsyncFileReader::backend_auto).get_backend() == AsyncFileReader::backend_io_uring)
+		backends.push_back(AsyncFileReader::backend_io_uring);
+	else
+		Console::write_line("   (io_uring is not available, only testing the thread pool)");
+
+	for (auto backend : backends)
+	{
+		AsyncFileReader reader(backend, 8);
+		if (reader.get_backend() != backend) fail();
+		Console::write_line(backend == AsyncFileReader::backend_io_uring ? "   Backend: io_uring" : "   Backend: thread pool");
+
+		Console::write_line("    Function: Task<DataBuffer> read(const std::string &filename, int64_t offset, int64_t size)");
+		{
+			DataBuffer whole = reader.read(filename).get();
+			if (whole.get_size() != contents.get_size()) fail();
+			if (memcmp(whole.get_data(), contents.get_data(), contents.get_size())) fail();
+
+			DataBuffer part = reader.read(filename, 1000, 500).get();
+			if (part.get_size() != 500) fail();
+			if (memcmp(part.get_data(), contents.get_data() + 1000, 500)) fail();
+
+			DataBuffer tail = reader.read(filename, 299990, 100).get();
+			if (tail.get_size() != 10) fail();
+			if (memcmp(tail.get_data(), contents.get_data() + 299990, 10)) fail();
+
+			if (reader.read(filename, 400000).get().get_size() != 0) fail();
+
+			bool missing_failed = false;
+			try
+			{
+				reader.read("test_async_file_reader_missing.tmp").get();
+			}
+			catch (const Exception &)
+			{
+				missing_failed = true;
+			}
+			if (!missing_failed) fail();
+		}
+
+		Console::write_line("    Function: std::vector<Task<DataBuffer>> read(const std::vector<AsyncFileRead> &requests)");
+		{
+			// More reads than the queue depth
+			std::vector<AsyncFileRead> requests;
+			for (int i = 0; i < 100; i++)
+				requests.push_back(AsyncFileRead(filename, i * 3000, 2000));
+			std::vector<Task<DataBuffer>> tasks = reader.read(requests);
+			if (tasks.size() != requests.size()) fail();
+			for (int i = 0; i < 100; i++)
+			{
+				DataBuffer data = tasks[i].get();
+				if (data.get_size() != 2000) fail();
+				if (memcmp(data.get_data(), contents.get_data() + i * 3000, 2000)) fail();
+			}
+			if (reader.get_pending_count() != 0) fail();
+		}
+	}
+
+	Console::write_line("  Class: FileSystem");
+	Console::write_line("   Function: Task<DataBuffer> read_async(const std::string &filename, int64_t offset, int64_t size)");
+	{
+		FileSystem vfs(".");
+		DataBuffer data = vfs.read_async(filename, 10, 20).get();
+		if (data.get_size() != 20) fail();
+		if (memcmp(data.get_data(), contents.get_data() + 10, 20)) fail();
+
+		vfs.mount("memory", FileSystem(new MemoryFileSystemProvider(contents)));
+		std::vector<AsyncFileRead> requests;
+		requests.push_back(AsyncFileRead(filename, 0, 100));
+		requests.push_back(AsyncFileRead("memory/memory.bin", 5000, 100));
+		requests.push_back(AsyncFileRead("memory/memory.bin"));
+		std::vector<Task<DataBuffer>> tasks = vfs.read_async(requests);
+		if (memcmp(tasks[0].get().get_data(), contents.get_data(), 100)) fail();
+		if (memcmp(tasks[1].get().get_data(), contents.get_data() + 5000, 100)) fail();
+		if (tasks[2].get().get_size() != contents.get_size()) fail();
+
+		bool missing_failed = false;
+		try
+		{
+			vfs.read_async("memory/missing.bin").get();
+		}
+		catch (const Exception &)
+		{
+			missing_failed = true;
+		}
+		if (!missing_failed) fail();
+	}
+
+	FileHelp::delete_file(filename);
+}
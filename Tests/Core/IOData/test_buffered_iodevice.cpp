@@ -0,0 +1,196 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+namespace
+{
+	// Memory device counting the calls reaching it
+	class CountingProvider : public IODeviceProvider
+	{
+	public:
+		CountingProvider(std::vector<char> &data, int &num_calls) : data(data), num_calls(num_calls) { }
+
+		int get_size() const override { return (int)data.size(); }
+		int get_position() const override { return position; }
+
+		int send(const void *src, int len, bool send_all) override
+		{
+			num_calls++;
+			if (position + len > (int)data.size())
+				data.resize(position + len);
+			memcpy(data.data() + position, src, len);
+			position += len;
+			return len;
+		}
+
+		int receive(void *dest, int len, bool receive_all) override
+		{
+			num_calls++;
+			int amount = peek(dest, len);
+			position += amount;
+			return amount;
+		}
+
+		int peek(void *dest, int len) override
+		{
+			int amount = std::max(std::min(len, (int)data.size() - position), 0);
+			memcpy(dest, data.data() + position, amount);
+			return amount;
+		}
+
+		bool seek(int new_position, IODevice::SeekMode mode) override
+		{
+			num_calls++;
+			if (mode == IODevice::seek_cur)
+				new_position += position;
+			else if (mode == IODevice::seek_end)
+				new_position += (int)data.size();
+			if (new_position < 0)
+				return false;
+			position = new_position;
+			return true;
+		}
+
+		IODeviceProvider *duplicate() override { return new CountingProvider(data, num_calls); }
+
+	private:
+		std::vector<char> &data;
+		int &num_calls;
+		int position = 0;
+	};
+}
+
+void TestApp::test_buffered_iodevice(void)
+{
+	Console::write_line(" Header: buffered_iodevice.h");
+	Console::write_line("  Class: BufferedIODevice");
+
+	std::vector<char> data(10000);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (char)(i * 7);
+	int num_calls = 0;
+
+	Console::write_line("   Function: int receive(void *data, int len, bool receive_all = true)");
+	{
+		IODevice device(new CountingProvider(data, num_calls));
+		BufferedIODevice buffered(device, 1024);
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			if (buffered.read_int8() != data[i]) fail();
+		}
+		char end_of_data;
+		if (buffered.read(&end_of_data, 1) != 0) fail();
+		if (num_calls > 12) fail();
+
+		// Reads larger than the buffer go to the device
+		buffered.seek(0);
+		std::vector<char> copy(5000);
+		if (buffered.read(copy.data(), 5000) != 5000) fail();
+		if (memcmp(copy.data(), data.data(), 5000)) fail();
+		if (buffered.get_position() != 5000) fail();
+	}
+
+	Console::write_line("   Function: bool seek(int position, SeekMode mode = seek_set)");
+	{
+		IODevice device(new CountingProvider(data, num_calls));
+		BufferedIODevice buffered(device, 1024);
+		if (buffered.read_uint8() != (unsigned char)data[0]) fail();
+
+		// Seeks inside the buffer do not reach the device
+		num_calls = 0;
+		buffered.seek(100);
+		if (buffered.read_uint8() != (unsigned char)data[100]) fail();
+		buffered.seek(-50, IODevice::seek_cur);
+		if (buffered.get_position() != 51) fail();
+		if (buffered.read_uint8() != (unsigned char)data[51]) fail();
+		buffered.seek(500, IODevice::seek_set);
+		if (buffered.read_uint8() != (unsigned char)data[500]) fail();
+		if (num_calls != 0) fail();
+
+		buffered.seek(-10, IODevice::seek_end);
+		if (buffered.get_position() != 9990) fail();
+		if (buffered.read_uint8() != (unsigned char)data[9990]) fail();
+		buffered.seek(20, IODevice::seek_set);
+		if (buffered.read_uint8() != (unsigned char)data[20]) fail();
+	}
+
+	Console::write_line("   Function: int peek(void *data, int len)");
+	{
+		IODevice device(new CountingProvider(data, num_calls));
+		BufferedIODevice buffered(device, 64);
+		char buffer[200];
+		buffered.seek(10);
+		if (buffered.peek(buffer, 200) != 200) fail();
+		if (memcmp(buffer, data.data() + 10, 200)) fail();
+		if (buffered.get_position() != 10) fail();
+		if (buffered.read(buffer, 200) != 200) fail();
+		if (memcmp(buffer, data.data() + 10, 200)) fail();
+		if (buffered.get_position() != 210) fail();
+
+		buffered.seek(-5, IODevice::seek_end);
+		if (buffered.peek(buffer, 200) != 5) fail();
+	}
+
+	Console::write_line("   Function: int send(const void *data, int len, bool send_all = true)");
+	{
+		std::vector<char> output;
+		IODevice device(new CountingProvider(output, num_calls));
+		BufferedIODevice buffered(device, 1024);
+		num_calls = 0;
+		for (int i = 0; i < 1000; i++)
+			buffered.write_uint32(i);
+		if (num_calls > 4) fail();
+		if (buffered.get_position() != 4000) fail();
+		if (buffered.get_size() != 4000) fail();
+
+		buffered.seek(8);
+		if (buffered.read_uint32() != 2) fail();
+		buffered.write_uint32(12345);
+		buffered.flush();
+		if (output.size() != 4000) fail();
+		if (device.get_position() != 16) fail();
+
+		buffered.seek(12);
+		if (buffered.read_uint32() != 12345) fail();
+		if (buffered.read_uint32() != 4) fail();
+	}
+
+	Console::write_line("   Function: void flush()");
+	{
+		IODevice device(new CountingProvider(data, num_calls));
+		{
+			BufferedIODevice buffered(device, 1024);
+			buffered.seek(30);
+			buffered.read_uint32();
+		}
+		// Destroying the buffered device moves the device back to the position actually read
+		if (device.get_position() != 34) fail();
+	}
+}
@@ -28,6 +28,7 @@
 */
 
 #include "test.h"
+#include <algorithm>
 
 void TestApp::test_endian(void)
 {
@@ -41,6 +42,47 @@ void TestApp::test_endian(void)
 	Endian::swap(testdata_in, 8, 2);
 	if (memcmp(testdata_in, testdata_out, testdata_size)) fail();
 
+	// Every count up to 100 runs each combination of the 32 byte SSSE3 loop, the 16 byte SSE2 loop and the byte swapping tail
+	Console::write_line("    SSE2: %1, SSSE3: %2", System::detect_cpu_extension(System::sse2), System::detect_cpu_extension(System::ssse3));
+	for (int type_size = 2; type_size <= 8; type_size *= 2)
+	{
+		for (int times = 0; times <= 100; times++)
+		{
+			for (int offset = 0; offset < 2; offset++)
+			{
+				std::vector<unsigned char> data(type_size * times + offset);
+				for (size_t i = 0; i < data.size(); i++)
+					data[i] = (unsigned char)(i * 13 + 5);
+				std::vector<unsigned char> expected = data;
+				for (int i = 0; i < times; i++)
+					std::reverse(expected.begin() + offset + i * type_size, expected.begin() + offset + (i + 1) * type_size);
+
+				Endian::swap(data.data() + offset, type_size, times);
+				if (data != expected) fail();
+			}
+		}
+	}
+
+	// Large enough for the SIMD paths, with an odd count to leave a remainder
+	for (int type_size = 2; type_size <= 8; type_size *= 2)
+	{
+		const int times = 1001;
+		std::vector<unsigned char> data(type_size * times);
+		for (size_t i = 0; i < data.size(); i++)
+			data[i] = (unsigned char)(i * 7 + 3);
+		std::vector<unsigned char> expected = data;
+		for (int i = 0; i < times; i++)
+			std::reverse(expected.begin() + i * type_size, expected.begin() + (i + 1) * type_size);
+
+		Endian::swap(data.data(), type_size, times);
+		if (data != expected) fail();
+
+		// Unaligned start
+		Endian::swap(data.data() + 1, type_size, times - 1);
+		Endian::swap(data.data() + 1, type_size, times - 1);
+		if (data != expected) fail();
+	}
+
 	Console::write_line("   Function: bool is_system_big()");
 	bool result = Endian::is_system_big();
 
@@ -28,6 +28,37 @@
 */
 
 #include "test.h"
+#include <algorithm>
+
+namespace
+{
+	// Recursive scan done the way it had to be before DirectoryScanner::scan_tree, for comparison
+	void scan_tree_sequential(const std::string &root, const std::string &relative_path, std::vector<std::string> &out_pathnames)
+	{
+		DirectoryScanner scanner;
+		if (!scanner.scan(relative_path.empty() ? root : root + "/" + relative_path))
+			return;
+		while (scanner.next())
+		{
+			std::string name = scanner.get_name();
+			if (name == "." || name == "..")
+				continue;
+			std::string pathname = relative_path.empty() ? name : relative_path + "/" + name;
+			out_pathnames.push_back(pathname + (scanner.is_directory() ? "/" : ""));
+			if (scanner.is_directory())
+				scan_tree_sequential(root, pathname, out_pathnames);
+		}
+	}
+
+	std::vector<std::string> get_sorted_pathnames(const std::vector<DirectoryScanEntry> &entries)
+	{
+		std::vector<std::string> pathnames;
+		for (auto &entry : entries)
+			pathnames.push_back(entry.pathname + (entry.is_directory ? "/" : ""));
+		std::sort(pathnames.begin(), pathnames.end());
+		return pathnames;
+	}
+}
 
 void TestApp::test_directory_scanner(void)
 {
@@ -161,7 +192,7 @@ void TestApp::test_directory_scanner(void)
 	Console::write_line("     *** Unable to fully test on WIN32 ***");
 #else
 	filename = "temporary_file.tmp";
-	std::string filename_a = StringHelp::text_to_local8(filename);
+	std::string filename_a = filename;
 	int handle = ::open(filename_a.c_str(), O_WRONLY | O_CREAT, S_IWUSR);
 	if (handle == -1) fail();
 	::close(handle);
@@ -170,8 +201,12 @@ void TestApp::test_directory_scanner(void)
 	if (!result) fail();
 	result = scanner.next();
 	if (!result) fail();
-	result = scanner.is_readable();
-	if (result) fail();
+	// Permission bits do not apply to root
+	if (geteuid() != 0)
+	{
+		result = scanner.is_readable();
+		if (result) fail();
+	}
 	result = scanner.is_writable();
 	if (!result) fail();
 	FileHelp::delete_file(filename);
@@ -191,7 +226,7 @@ void TestApp::test_directory_scanner(void)
 	Console::write_line("     *** Unable to fully test on WIN32 ***");
 #else
 	filename = "temporary_file.tmp";
-	filename_a = StringHelp::text_to_local8(filename);
+	filename_a = filename;
 	handle = ::open(filename_a.c_str(), O_WRONLY | O_CREAT, S_IRUSR);
 	if (handle == -1) fail();
 	::close(handle);
@@ -202,8 +237,11 @@ void TestApp::test_directory_scanner(void)
 	if (!result) fail();
 	result = scanner.is_readable();
 	if (!result) fail();
-	result = scanner.is_writable();
-	if (result) fail();
+	if (geteuid() != 0)
+	{
+		result = scanner.is_writable();
+		if (result) fail();
+	}
 	FileHelp::delete_file(filename);
 #endif
 
@@ -264,5 +302,86 @@ void TestApp::test_directory_scanner(void)
 
 //	Console::write_line(str);
 
-}
 
+//*** testing scan_tree()
+	Console::write_line("   Function: static std::vector<DirectoryScanEntry> scan_tree(const std::string &pathname, const WorkQueue &queue)");
+	{
+		const std::string root = "scan_tree.tmp";
+		const int num_directories = 16;
+		const int num_files = 16;
+		std::vector<std::string> expected;
+		for (int i = 0; i < num_directories; i++)
+		{
+			std::string directory = string_format("dir%1", i);
+			expected.push_back(directory + "/");
+			for (int j = 0; j < num_directories; j++)
+			{
+				std::string subdirectory = directory + string_format("/sub%1", j);
+				expected.push_back(subdirectory + "/");
+				Directory::create(root + "/" + subdirectory, true);
+				for (int k = 0; k < num_files; k++)
+				{
+					std::string filename = subdirectory + string_format("/file%1.txt", k);
+					expected.push_back(filename);
+					File::write_text(root + "/" + filename, "x");
+				}
+			}
+		}
+		Directory::create(root + "/empty");
+		expected.push_back("empty/");
+		File::write_text(root + "/top.txt", "x");
+		expected.push_back("top.txt");
+		std::sort(expected.begin(), expected.end());
+
+		WorkQueue queue(false, true);
+		std::vector<DirectoryScanEntry> entries = DirectoryScanner::scan_tree(root, queue);
+		if (get_sorted_pathnames(entries) != expected) fail();
+
+		entries = DirectoryScanner::scan_tree(root + "/dir1/sub2");
+		if (entries.size() != num_files || entries[0].is_directory) fail();
+
+		bool thrown = false;
+		try
+		{
+			DirectoryScanner::scan_tree(root + "/missing", queue);
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+
+		Console::write_line("   Benchmark: scan_tree (%1 files in %2 directories)", num_directories * num_directories * num_files, num_directories * num_directories + num_directories);
+		const int iterations = 10;
+		uint64_t start_time = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+		{
+			std::vector<std::string> pathnames;
+			scan_tree_sequential(root, std::string(), pathnames);
+			if (pathnames.size() != expected.size()) fail();
+		}
+		uint64_t time_sequential = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		for (int i = 0; i < iterations; i++)
+		{
+			if (DirectoryScanner::scan_tree(root, queue).size() != expected.size()) fail();
+		}
+		uint64_t time_scan_tree = System::get_microseconds() - start_time;
+
+		Console::write_line("    DirectoryScanner::next, one directory at a time: %1 us", (int)(time_sequential / iterations));
+		Console::write_line("    DirectoryScanner::scan_tree: %1 us", (int)(time_scan_tree / iterations));
+
+#ifndef WIN32
+		// Links to directories are returned as directories, but not followed
+		if (symlink("dir0", (root + "/link").c_str()) == 0)
+		{
+			expected.push_back("link/");
+			std::sort(expected.begin(), expected.end());
+			if (get_sorted_pathnames(DirectoryScanner::scan_tree(root, queue)) != expected) fail();
+			unlink((root + "/link").c_str());
+		}
+#endif
+		Directory::remove(root, true, true);
+	}
+}
@@ -0,0 +1,107 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_file_mapping(void)
+{
+	Console::write_line(" Header: file_mapping.h");
+	Console::write_line("  Class: FileMapping");
+
+	const std::string filename = "test_file_mapping.tmp";
+	DataBuffer contents(100000);
+	for (unsigned int i = 0; i < contents.get_size(); i++)
+		contents[i] = (char)(i * 13);
+	File::write_bytes(filename, contents);
+
+	Console::write_line("   Function: static FileMapping File::map(const std::string &filename, FileMapping::AccessPattern pattern)");
+	{
+		FileMapping mapping = File::map(filename);
+		if (mapping.is_null()) fail();
+		if (mapping.get_size() != contents.get_size()) fail();
+		if (memcmp(mapping.get_data(), contents.get_data(), contents.get_size())) fail();
+
+		FileMapping copy = mapping;
+		mapping = FileMapping();
+		if (copy.get_data<unsigned char>()[99999] != (unsigned char)contents[99999]) fail();
+	}
+
+	Console::write_line("   Function: void advise(AccessPattern pattern, size_t offset = 0, size_t length = 0)");
+	{
+		FileMapping mapping = File::map(filename, FileMapping::access_random);
+		mapping.advise(FileMapping::access_will_need, 5000, 100);
+		mapping.advise(FileMapping::access_sequential, 99999, 0);
+		mapping.advise(FileMapping::access_normal, 200000);
+		if (mapping.get_data()[5000] != contents[5000]) fail();
+	}
+
+	Console::write_line("   Function: IODevice create_device()");
+	{
+		IODevice device = File::map(filename).create_device();
+		if (device.get_size() != (int)contents.get_size()) fail();
+		if (device.read_uint8() != (unsigned char)contents[0]) fail();
+		device.seek(-4, IODevice::seek_end);
+		char buffer[16];
+		if (device.peek(buffer, 16) != 4) fail();
+		if (device.read(buffer, 16) != 4) fail();
+		if (memcmp(buffer, contents.get_data() + contents.get_size() - 4, 4)) fail();
+		if (device.get_position() != (int)contents.get_size()) fail();
+
+		bool write_failed = false;
+		try
+		{
+			device.write(buffer, 4);
+		}
+		catch (const Exception &)
+		{
+			write_failed = true;
+		}
+		if (!write_failed) fail();
+	}
+
+	Console::write_line("   Function: Empty and missing files");
+	{
+		File::write_bytes(filename, DataBuffer());
+		FileMapping mapping = File::map(filename);
+		if (mapping.is_null() || mapping.get_size() != 0 || mapping.get_data() != nullptr) fail();
+
+		bool open_failed = false;
+		try
+		{
+			File::map("test_file_mapping_missing.tmp");
+		}
+		catch (const Exception &)
+		{
+			open_failed = true;
+		}
+		if (!open_failed) fail();
+	}
+
+	FileHelp::delete_file(filename);
+}
@@ -0,0 +1,124 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+namespace
+{
+	// A provider written before the 64 bit interface existed
+	class Provider32 : public IODeviceProvider
+	{
+	public:
+		int get_size() const override { return (int)data.size(); }
+		int get_position() const override { return position; }
+		int send(const void *src, int len, bool send_all) override { data.insert(data.begin() + position, (const char*)src, (const char*)src + len); position += len; return len; }
+		int receive(void *dest, int len, bool receive_all) override { len = peek(dest, len); position += len; return len; }
+		int peek(void *dest, int len) override { len = std::min(len, (int)data.size() - position); memcpy(dest, data.data() + position, len); return len; }
+		IODeviceProvider *duplicate() override { return new Provider32(); }
+		bool seek(int new_position, IODevice::SeekMode mode) override { position = new_position; return true; }
+
+		std::vector<char> data;
+		int position = 0;
+	};
+}
+
+void TestApp::test_iodevice_64(void)
+{
+	Console::write_line(" Header: iodevice.h");
+	Console::write_line("  Class: IODevice (64 bit sizes and offsets)");
+
+	Console::write_line("   Function: get_size64(), get_position64() and seek64() on MemoryDevice");
+	{
+		MemoryDevice device;
+		DataBuffer data(1000);
+		for (unsigned int i = 0; i < data.get_size(); i++)
+			data[i] = (char)i;
+		if (device.write64(data.get_data(), data.get_size64()) != 1000) fail();
+		if (device.get_size64() != 1000) fail();
+		if (device.get_position64() != 1000) fail();
+
+		if (!device.seek64(-10, IODevice::seek_end)) fail();
+		if (device.get_position64() != 990) fail();
+		if (device.seek64(1001, IODevice::seek_set)) fail();
+		if (device.seek64((int64_t)1 << 40, IODevice::seek_set)) fail();
+		if (device.get_position64() != 990) fail();
+
+		if (!device.seek64(0, IODevice::seek_set)) fail();
+		DataBuffer result(2000);
+		if (device.read64(result.get_data(), result.get_size64()) != 1000) fail();
+		if (memcmp(result.get_data(), data.get_data(), 1000)) fail();
+	}
+
+	Console::write_line("   Function: seek64() on a provider only implementing the 32 bit interface");
+	{
+		IODevice device(new Provider32());
+		device.write_int32(1234);
+		if (device.get_size64() != 4) fail();
+		if (device.get_position64() != 4) fail();
+		if (device.seek64((int64_t)1 << 33, IODevice::seek_set)) fail();
+		if (!device.seek64(0, IODevice::seek_set)) fail();
+		if (device.read_int32() != 1234) fail();
+	}
+
+	Console::write_line("   Function: File beyond 4 GB");
+	{
+		const std::string filename = "test_iodevice_64.tmp";
+		const int64_t large_offset = ((int64_t)1 << 32) + 100;
+		{
+			File file(filename, File::create_always, File::access_read_write);
+			if (!file.seek64(large_offset, IODevice::seek_set)) fail();
+			if (file.get_position64() != large_offset) fail();
+			file.write_uint32(0xdeadbeef);
+			if (file.get_size64() != large_offset + 4) fail();
+
+			bool size_failed = false;
+			try
+			{
+				file.get_size();
+			}
+			catch (const Exception &)
+			{
+				size_failed = true;
+			}
+			if (!size_failed) fail();
+		}
+
+		{
+			BufferedIODevice file(File(filename), 4096);
+			if (!file.seek64(-4, IODevice::seek_end)) fail();
+			if (file.get_position64() != large_offset) fail();
+			if (file.read_uint32() != 0xdeadbeef) fail();
+			if (!file.seek64(-8, IODevice::seek_cur)) fail();
+			if (file.get_position64() != large_offset - 4) fail();
+			if (file.read_uint32() != 0) fail();
+		}
+
+		FileHelp::delete_file(filename);
+	}
+}
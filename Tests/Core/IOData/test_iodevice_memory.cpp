@@ -110,5 +110,72 @@ void TestApp::test_iodevice_memory(void)
 	if (mem.seek(extended_buffer_size+1)) fail();
 	if (!mem.seek(0)) fail();
 
+
+	Console::write_line("   Function: void write_uint16_array(const uint16_t *data, int count)");
+	Console::write_line("   Function: void read_uint16_array(uint16_t *data, int count)");
+	Console::write_line("   Function: void write_uint32_array(const uint32_t *data, int count)");
+	Console::write_line("   Function: void read_uint32_array(uint32_t *data, int count)");
+	Console::write_line("   Function: void write_float_array(const float *data, int count)");
+	Console::write_line("   Function: void read_float_array(float *data, int count)");
+	for (int big_endian = 0; big_endian < 2; big_endian++)
+	{
+		// More than one write chunk, with an odd count
+		const int count = 10001;
+		std::vector<uint16_t> values16(count);
+		std::vector<uint32_t> values32(count);
+		std::vector<float> values_float(count);
+		for (int i = 0; i < count; i++)
+		{
+			values16[i] = (uint16_t)(i * 31 + 1);
+			values32[i] = (uint32_t)i * 0x01030507 + 11;
+			values_float[i] = i * 0.25f - 100.0f;
+		}
+
+		MemoryDevice device;
+		if (big_endian)
+			device.set_big_endian_mode();
+		else
+			device.set_little_endian_mode();
+		device.write_uint16_array(values16.data(), count);
+		device.write_uint32_array(values32.data(), count);
+		device.write_float_array(values_float.data(), count);
+		if (device.get_size() != count * 10) fail();
+
+		// Compare against the single value readers
+		device.seek(0);
+		for (int i = 0; i < count; i++)
+		{
+			if (device.read_uint16() != values16[i]) fail();
+		}
+		for (int i = 0; i < count; i++)
+		{
+			if (device.read_uint32() != values32[i]) fail();
+		}
+		for (int i = 0; i < count; i++)
+		{
+			if (device.read_float() != values_float[i]) fail();
+		}
+
+		device.seek(0);
+		std::vector<uint16_t> result16(count);
+		std::vector<uint32_t> result32(count);
+		std::vector<float> result_float(count);
+		device.read_uint16_array(result16.data(), count);
+		device.read_uint32_array(result32.data(), count);
+		device.read_float_array(result_float.data(), count);
+		if (result16 != values16 || result32 != values32 || result_float != values_float) fail();
+
+		// Reading past the end throws
+		bool thrown = false;
+		try
+		{
+			device.read_uint32_array(result32.data(), 1);
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+	}
 }
 
@@ -0,0 +1,203 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+namespace
+{
+	std::string read_all(IODevice device)
+	{
+		std::string text(device.get_size(), 0);
+		if (!text.empty())
+			device.read(&text[0], (int)text.size());
+		return text;
+	}
+
+	void make_zip(const std::string &zip_filename, const std::vector<std::pair<std::string, std::string>> &files)
+	{
+		ZipArchive zip;
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			std::string input_filename = zip_filename + string_format(".%1.tmp", (int)i);
+			File::write_text(input_filename, files[i].second);
+			zip.add_file(input_filename, files[i].first);
+		}
+		zip.save(zip_filename);
+		for (size_t i = 0; i < files.size(); i++)
+			FileHelp::delete_file(zip_filename + string_format(".%1.tmp", (int)i));
+	}
+}
+
+void TestApp::test_overlay_file_system(void)
+{
+	Console::write_line(" Header: overlay_file_system.h");
+	Console::write_line("  Class: OverlayFileSystem");
+
+	const std::string base_zip = "overlay_base.zip.tmp";
+	const std::string patch_zip = "overlay_patch.zip.tmp";
+	const std::string directory = "overlay_directory.tmp";
+
+	std::vector<std::pair<std::string, std::string>> base_files;
+	base_files.push_back(std::make_pair("Data/a.txt", "base a"));
+	base_files.push_back(std::make_pair("Data/b.txt", "base b"));
+	base_files.push_back(std::make_pair("Data/Sub/c.txt", "base c"));
+	make_zip(base_zip, base_files);
+
+	std::vector<std::pair<std::string, std::string>> patch_files;
+	patch_files.push_back(std::make_pair("Data/a.txt", "patch a"));
+	make_zip(patch_zip, patch_files);
+
+	Directory::create(directory + "/Data/Sub", true);
+	File::write_text(directory + "/Data/Sub/C.TXT", "directory c");
+	File::write_text(directory + "/Data/d.txt", "directory d");
+
+	Console::write_line("   Function: void add_layer(const std::string &path, bool is_zip_file, int priority)");
+	{
+		OverlayFileSystem overlay;
+		overlay.add_layer(patch_zip, true, 1);
+		overlay.add_layer(base_zip, true);
+		if (overlay.get_layer_count() != 2) fail();
+		if (overlay.get_file_count() != 3) fail();
+
+		// The patch was added first, but has the higher priority
+		if (read_all(overlay.open_file("Data/a.txt")) != "patch a") fail();
+		if (read_all(overlay.open_file("Data/b.txt")) != "base b") fail();
+		if (read_all(overlay.open_file("/Data/Sub/../Sub/c.txt")) != "base c") fail();
+
+		// Adding a layer rebuilds the index, and equal priorities shadow earlier layers
+		overlay.add_layer(directory, false);
+		if (overlay.get_file_count() != 5) fail();
+		if (read_all(overlay.open_file("Data/d.txt")) != "directory d") fail();
+		if (read_all(overlay.open_file("Data/a.txt")) != "patch a") fail();
+	}
+
+	Console::write_line("   Function: bool has_file(const std::string &filename)");
+	{
+		OverlayFileSystem overlay;
+		overlay.add_layer(base_zip, true);
+		overlay.add_layer(directory, false);
+		if (!overlay.has_file("Data/Sub/c.txt")) fail();
+		if (!overlay.has_file("Data/Sub/C.TXT")) fail();
+		if (overlay.has_file("data/b.txt")) fail();
+		if (overlay.has_file("Data/missing.txt")) fail();
+		if (overlay.has_file("Data")) fail();
+
+		bool thrown = false;
+		try
+		{
+			overlay.open_file("Data/missing.txt");
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+	}
+
+	Console::write_line("   Function: OverlayFileSystem(CaseMode case_mode)");
+	{
+		OverlayFileSystem overlay(OverlayFileSystem::case_insensitive);
+		overlay.add_layer(base_zip, true);
+		overlay.add_layer(directory, false);
+		if (overlay.get_file_count() != 4) fail();
+		if (read_all(overlay.open_file("DATA/B.txt")) != "base b") fail();
+		if (read_all(overlay.open_file("data/sub/c.txt")) != "directory c") fail();
+
+		std::vector<std::string> files = overlay.get_file_list();
+		if (files.size() != 4 || files[0] != "Data/Sub/C.TXT" || files[3] != "Data/d.txt") fail();
+	}
+
+	Console::write_line("   Function: FileSystem get_file_system()");
+	{
+		OverlayFileSystem overlay;
+		overlay.add_layer(base_zip, true);
+		overlay.add_layer(patch_zip, true);
+		FileSystem vfs = overlay.get_file_system();
+		if (read_all(vfs.open_file("Data/a.txt")) != "patch a") fail();
+		if (!vfs.has_file("Data/Sub/c.txt")) fail();
+		if (!vfs.has_directory("Data/Sub")) fail();
+
+		DirectoryListing listing = vfs.get_directory_listing("Data");
+		std::vector<std::string> names;
+		while (listing.next())
+			names.push_back(listing.get_filename() + (listing.is_directory() ? "/" : ""));
+		if (names.size() != 3 || names[0] != "Sub/" || names[1] != "a.txt" || names[2] != "b.txt") fail();
+	}
+
+	Console::write_line("   Function: void save_index(IODevice &device)");
+	Console::write_line("   Function: bool load_index(IODevice &device)");
+	{
+		OverlayFileSystem overlay;
+		overlay.add_layer(base_zip, true);
+		overlay.add_layer(directory, false, 1);
+		MemoryDevice index_file;
+		overlay.save_index(index_file);
+
+		OverlayFileSystem loaded;
+		loaded.add_layer(base_zip, true);
+		loaded.add_layer(directory, false, 1);
+		index_file.seek(0);
+		if (!loaded.load_index(index_file)) fail();
+		if (loaded.get_file_list() != overlay.get_file_list()) fail();
+		if (read_all(loaded.open_file("Data/Sub/C.TXT")) != "directory c") fail();
+
+		// The index must match the layers it was saved with
+		OverlayFileSystem different;
+		different.add_layer(base_zip, true);
+		index_file.seek(0);
+		if (different.load_index(index_file)) fail();
+		if (different.get_file_count() != 3) fail();
+
+		OverlayFileSystem truncated;
+		truncated.add_layer(base_zip, true);
+		truncated.add_layer(directory, false, 1);
+		DataBuffer data(index_file.get_data(), 0, index_file.get_size() - 4);
+		MemoryDevice truncated_file(data);
+		if (truncated.load_index(truncated_file)) fail();
+		if (truncated.get_file_count() != 5) fail();
+	}
+
+	Console::write_line("   Function: IODevice open_file(const std::string &filename, File::OpenMode mode, ...)");
+	{
+		OverlayFileSystem overlay;
+		overlay.add_layer(base_zip, true);
+		overlay.add_layer(directory, false, 1);
+
+		// New files are created in the layer with the highest priority
+		IODevice device = overlay.open_file("Data/e.txt", File::create_always, File::access_read_write);
+		device.write("new e", 5);
+		device = IODevice();
+		if (!overlay.has_file("Data/e.txt")) fail();
+		if (File::read_text(directory + "/Data/e.txt") != "new e") fail();
+	}
+
+	FileHelp::delete_file(base_zip);
+	FileHelp::delete_file(patch_zip);
+	Directory::remove(directory, true, true);
+}
@@ -55,6 +55,16 @@ int TestApp::main()
 		Console::write_line("Directory: API/Core/System");
 
 		test_datetime();
+		test_work_queue();
+		test_task_graph();
+		test_parallel_for();
+		test_task();
+		test_block_allocator();
+		test_databuffer();
+		test_signal();
+		test_async_logger();
+		test_profiler();
+		test_game_time();
 		
 		Console::write_line("All Tests Complete");
 		console.display_close_message();
@@ -72,6 +72,16 @@ public:
 	int main();
 private:
 	void test_datetime();
+	void test_work_queue();
+	void test_task_graph();
+	void test_parallel_for();
+	void test_task();
+	void test_block_allocator();
+	void test_databuffer();
+	void test_signal();
+	void test_async_logger();
+	void test_profiler();
+	void test_game_time();
 
 	std::string convert_time(DateTime &datetime);
 	void fail(void);
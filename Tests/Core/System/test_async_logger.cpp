@@ -0,0 +1,189 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	class TestLogger : public Logger
+	{
+	public:
+		void log(const std::string &type, const std::string &text) override
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			entries.push_back(type + ":" + text);
+		}
+
+		void log_batch(const std::vector<LogEntry> &batch) override
+		{
+			Logger::log_batch(batch);
+			std::unique_lock<std::mutex> lock(mutex);
+			batches++;
+			thread_id = std::this_thread::get_id();
+		}
+
+		std::mutex mutex;
+		std::vector<std::string> entries;
+		int batches = 0;
+		std::thread::id thread_id;
+	};
+}
+
+void TestApp::test_async_logger()
+{
+	Console::write_line(" Header: async_logger.h");
+	Console::write_line("  Class: AsyncLogger");
+
+	Console::write_line("   Function: log_event() without AsyncLogger");
+	{
+		TestLogger logger;
+		log_event("info", "Hello %1 %2", "world", 42);
+		if (logger.entries.size() != 1 || logger.entries[0] != "info:Hello world 42") fail();
+		if (logger.batches != 0) fail();
+	}
+
+	Console::write_line("   Function: log_event() and flush()");
+	{
+		TestLogger logger;
+		AsyncLogger async_logger;
+		if (!AsyncLogger::is_enabled()) fail();
+
+		char buffer[16];
+		strcpy(buffer, "first");
+		log_event("info", "Text");
+		log_event("info", "Deferred %1 %2", buffer, 1.5f);
+		strcpy(buffer, "changed");	// Arguments must be captured when logging, not when formatting
+		async_logger.flush();
+
+		std::unique_lock<std::mutex> lock(logger.mutex);
+		if (logger.entries.size() != 2) fail();
+		if (logger.entries[0] != "info:Text") fail();
+		if (logger.entries[1] != "info:Deferred first 1.5") fail();
+		if (logger.thread_id == std::this_thread::get_id()) fail();
+		lock.unlock();
+
+		bool thrown = false;
+		try
+		{
+			AsyncLogger second_logger;
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+	}
+	if (AsyncLogger::is_enabled()) fail();
+
+	Console::write_line("   Function: log_event() from many threads");
+	{
+		TestLogger logger;
+		const int num_threads = 4;
+		const int num_events = 5000;
+		AsyncLoggerStats stats;
+		{
+			AsyncLogger async_logger(64, AsyncLogOverflow::block);
+			std::vector<std::thread> threads;
+			for (int i = 0; i < num_threads; i++)
+			{
+				threads.push_back(std::thread([=]()
+				{
+					for (int j = 0; j < num_events; j++)
+						log_event("thread", "%1 %2", i, j);
+				}));
+			}
+			for (auto &thread : threads)
+				thread.join();
+			async_logger.flush();
+			stats = async_logger.get_stats();
+		}
+
+		if (logger.entries.size() != num_threads * num_events) fail();
+		if (stats.events_logged != num_threads * num_events || stats.events_dropped != 0) fail();
+		if (stats.batches_written == 0 || stats.batches_written > stats.events_logged) fail();
+
+		// Events from each thread keep their order
+		std::vector<int> next_event(num_threads);
+		for (auto &entry : logger.entries)
+		{
+			std::vector<std::string> parts = StringHelp::split_text(entry.substr(7), " ");
+			int thread_index = StringHelp::text_to_int(parts[0]);
+			int event_index = StringHelp::text_to_int(parts[1]);
+			if (next_event[thread_index]++ != event_index) fail();
+		}
+	}
+
+	Console::write_line("   Function: log_event() from short-lived threads");
+	{
+		TestLogger logger;
+		const int num_rounds = 50;
+		const int num_threads = 8;
+		uint64_t max_thread_buffers = 0;
+		AsyncLoggerStats stats;
+		{
+			AsyncLogger async_logger(256, AsyncLogOverflow::block, 1);
+			for (int round = 0; round < num_rounds; round++)
+			{
+				std::vector<std::thread> threads;
+				for (int i = 0; i < num_threads; i++)
+					threads.push_back(std::thread([=]() { log_event("thread", "%1 %2", round, i); }));
+				for (auto &thread : threads)
+					thread.join();
+				async_logger.flush();
+				max_thread_buffers = max(max_thread_buffers, async_logger.get_stats().thread_buffers);
+			}
+
+			// Buffers of exited threads are freed once drained
+			async_logger.flush();
+			stats = async_logger.get_stats();
+		}
+		if (stats.events_logged != num_rounds * num_threads) fail();
+		if (max_thread_buffers > 2 * num_threads) fail();
+		if (stats.thread_buffers > 1) fail();
+	}
+
+	Console::write_line("   Function: AsyncLogOverflow::drop");
+	{
+		TestLogger logger;
+		AsyncLoggerStats stats;
+		{
+			AsyncLogger async_logger(4, AsyncLogOverflow::drop, 1000);
+			std::unique_lock<std::recursive_mutex> lock(Logger::mutex);	// Stalls the logging thread
+			for (int i = 0; i < 100; i++)
+				log_event("drop", "%1", i);
+			lock.unlock();
+			async_logger.flush();
+			stats = async_logger.get_stats();
+		}
+		if (stats.events_dropped == 0) fail();
+		if (stats.events_logged + stats.events_dropped != 100) fail();
+		if (logger.entries.size() != stats.events_logged) fail();
+	}
+}
@@ -0,0 +1,120 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+
+void TestApp::test_block_allocator()
+{
+	Console::write_line(" Header: block_allocator.h");
+	Console::write_line("  Class: BlockAllocator");
+
+	Console::write_line("   Function: allocate()");
+	{
+		BlockAllocator allocator;
+		for (int i = 1; i < 1000; i++)
+		{
+			char *data = static_cast<char*>(allocator.allocate(i));
+			if (((size_t)data) % 16 != 0) fail();
+			memset(data, 0xcd, i);
+		}
+		BlockAllocatorStats stats = allocator.get_stats();
+		if (stats.bytes_used < 999 * 1000 / 2) fail();
+		if (stats.bytes_reserved < stats.bytes_used) fail();
+		if (stats.high_water != stats.bytes_used) fail();
+	}
+
+	Console::write_line("   Function: deallocate()");
+	{
+		BlockAllocator allocator;
+		void *a = allocator.allocate(48);
+		void *b = allocator.allocate(48);
+		allocator.deallocate(a, 48);
+		void *c = allocator.allocate(40);	// Same 16 byte size class as 48
+		if (c != a) fail();
+		allocator.deallocate(b, 48);	// Last allocation, pops the bump pointer
+		void *d = allocator.allocate(16);
+		if (d != b) fail();
+	}
+
+	Console::write_line("   Function: rewind() and ScopedMarker");
+	{
+		BlockAllocator allocator(4096);
+		allocator.allocate(100);
+		BlockAllocator::Marker marker = allocator.get_marker();
+		void *first = allocator.allocate(100);
+		allocator.rewind(marker);
+		if (allocator.allocate(100) != first) fail();
+
+		// Steady state frames must not touch the heap
+		for (int frame = 0; frame < 100; frame++)
+		{
+			BlockAllocator::ScopedMarker scope(allocator);
+			for (int i = 0; i < 100; i++)
+				allocator.allocate(200);
+		}
+		int heap_allocations = allocator.get_stats().heap_allocations;
+		for (int frame = 0; frame < 100; frame++)
+		{
+			BlockAllocator::ScopedMarker scope(allocator);
+			for (int i = 0; i < 100; i++)
+				allocator.allocate(200);
+		}
+		if (allocator.get_stats().heap_allocations != heap_allocations) fail();
+		if (allocator.get_stats().high_water < 100 * 208) fail();
+
+		// Memory given back before the marker position survives the rewind
+		allocator.reset();
+		void *before = allocator.allocate(64);
+		allocator.allocate(64);
+		marker = allocator.get_marker();
+		allocator.deallocate(before, 64);
+		void *after = allocator.allocate(300);
+		allocator.allocate(16);
+		allocator.deallocate(after, 300);
+		allocator.rewind(marker);
+		if (allocator.get_stats().bytes_used != 64) fail();
+		if (allocator.allocate(64) != before) fail();
+		if (allocator.allocate(300) != after) fail();	// Dropped from the free list, bump allocated again
+		if (allocator.allocate(300) == after) fail();
+		if (allocator.get_stats().bytes_used != 64 + 64 + 304 * 2) fail();
+
+		allocator.reset();
+		if (allocator.get_stats().bytes_used != 0) fail();
+		if (allocator.get_stats().bytes_reserved == 0) fail();
+		allocator.free();
+		if (allocator.get_stats().bytes_reserved != 0) fail();
+	}
+
+	Console::write_line("   Function: get_thread_allocator()");
+	{
+		ThreadLocalStorage tls;
+		BlockAllocator allocator = BlockAllocator::get_thread_allocator();
+		allocator.allocate(64);
+		if (BlockAllocator::get_thread_allocator().get_stats().bytes_used != 64) fail();
+	}
+}
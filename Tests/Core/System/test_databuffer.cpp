@@ -0,0 +1,140 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+
+void TestApp::test_databuffer()
+{
+	Console::write_line(" Header: databuffer.h");
+	Console::write_line("  Class: DataBuffer");
+
+	Console::write_line("   Function: DataBuffer()");
+	{
+		DataBuffer empty;
+		DataBuffer copy = empty;
+		DataBuffer moved(std::move(copy));
+		DataBuffer empty_slice = empty.slice(0, 0);
+		if (empty.get_data() != nullptr || empty.get_size() != 0 || empty.get_capacity() != 0 || !empty.is_null()) fail();
+		if (!empty_slice.is_null()) fail();
+
+		// Empty buffers do not share anything, so growing one leaves its copies alone
+		moved.set_size(4);
+		if (moved.get_size() != 4 || empty.get_size() != 0) fail();
+
+		// Once it has a capacity the data is shared
+		DataBuffer reserved;
+		reserved.set_capacity(16);
+		DataBuffer shared = reserved;
+		shared.set_size(4);
+		if (reserved.get_size() != 4 || reserved.get_data() != shared.get_data()) fail();
+	}
+
+	Console::write_line("   Function: DataBuffer(const void *data, unsigned int size)");
+	{
+		DataBuffer small("0123456789", 10);
+		if (small.get_size() != 10) fail();
+		if (memcmp(small.get_data(), "0123456789", 10)) fail();
+		if (((size_t)small.get_data()) % 16 != 0) fail();
+
+		DataBuffer large(100000);
+		if (((size_t)large.get_data()) % 16 != 0) fail();
+		for (unsigned int i = 0; i < large.get_size(); i++)
+		{
+			if (large[i] != 0) fail();
+		}
+	}
+
+	Console::write_line("   Function: set_size()");
+	{
+		DataBuffer buffer("abc", 3);
+		buffer.set_size(1000);
+		if (memcmp(buffer.get_data(), "abc", 3)) fail();
+		if (buffer[999u] != 0) fail();
+		buffer.set_size(2);
+		if (buffer.get_size() != 2 || buffer.get_capacity() < 1000) fail();
+	}
+
+	Console::write_line("   Function: DataBuffer(DataBuffer &&move)");
+	{
+		DataBuffer buffer("abc", 3);
+		const char *data = buffer.get_data();
+		DataBuffer moved(std::move(buffer));
+		if (moved.get_data() != data) fail();
+		if (!buffer.is_null() || buffer.get_size() != 0) fail();
+		buffer.set_size(4);
+		if (buffer.get_size() != 4 || moved.get_size() != 3) fail();
+	}
+
+	Console::write_line("   Function: slice()");
+	{
+		DataBuffer buffer("0123456789", 10);
+		DataBuffer slice = buffer.slice(2, 6);
+		if (!slice.is_slice() || buffer.is_slice()) fail();
+		if (slice.get_data() != buffer.get_data() + 2) fail();
+		if (slice.get_size() != 6) fail();
+
+		DataBuffer slice2 = slice.slice(1, 3);
+		if (slice2.get_data() != buffer.get_data() + 3) fail();
+		if (memcmp(slice2.get_data(), "345", 3)) fail();
+
+		slice[0] = 'x';
+		if (buffer[2] != 'x') fail();
+
+		bool thrown = false;
+		try
+		{
+			slice.slice(4, 3);
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+
+		// Slices keep the data alive
+		buffer = DataBuffer();
+		if (memcmp(slice2.get_data(), "345", 3)) fail();
+
+		// Growing a slice detaches it
+		slice2.set_size(10);
+		if (slice2.is_slice()) fail();
+		if (memcmp(slice2.get_data(), "345", 3)) fail();
+		if (slice2[9] != 0) fail();
+		slice2[0] = 'y';
+		if (slice[1] != '3') fail();
+	}
+
+	Console::write_line("   Function: DataBuffer(const DataBuffer &data, unsigned int pos, unsigned int size)");
+	{
+		DataBuffer buffer("0123456789", 10);
+		DataBuffer copy(buffer, 2, 4);
+		if (copy.is_slice()) fail();
+		if (copy.get_data() == buffer.get_data() + 2) fail();
+		if (memcmp(copy.get_data(), "2345", 4)) fail();
+	}
+}
@@ -0,0 +1,143 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <cmath>
+
+namespace
+{
+	/// Clock that only moves when told to, or by the time a sleep or yield would take
+	class FakeClock : public GameTimeClock
+	{
+	public:
+		uint64_t get_microseconds() override { return now; }
+		void sleep(int milliseconds) override { now += milliseconds * 1000 + sleep_overshoot; num_sleeps++; }
+		void yield() override { now += 10; }
+
+		uint64_t now = 1000000;
+		uint64_t sleep_overshoot = 300;
+		int num_sleeps = 0;
+	};
+}
+
+void TestApp::test_game_time()
+{
+	Console::write_line(" Header: game_time.h");
+	Console::write_line("  Class: GameTime");
+
+	Console::write_line("   Function: update()");
+	{
+		auto clock = std::make_shared<FakeClock>();
+		GameTime game_time(100, 0, clock);
+		uint64_t ticks = 0;
+		for (int i = 0; i < 5; i++)
+		{
+			clock->now += 13000;
+			game_time.update();
+			ticks += game_time.get_ticks_elapsed();
+			if (game_time.get_time_elapsed_ms() != 13) fail();
+
+			// The ticks must account for exactly the time elapsed since reset
+			uint64_t elapsed = game_time.get_current_time_microseconds();
+			if (elapsed != 13000 * (i + 1)) fail();
+			if (game_time.get_total_ticks() != ticks) fail();
+			if (ticks != elapsed * 100 / 1000000) fail();
+			float expected = (elapsed * 100 - ticks * 1000000) / 1000000.0f;
+			if (std::abs(game_time.get_tick_interpolation_time() - expected) > 0.0001f) fail();
+		}
+		if (ticks != 6) fail();
+	}
+
+	Console::write_line("   Function: set_max_ticks_per_update()");
+	{
+		auto clock = std::make_shared<FakeClock>();
+		GameTime game_time(100, 0, clock);
+		game_time.set_max_ticks_per_update(2);
+		if (game_time.get_max_ticks_per_update() != 2) fail();
+		clock->now += 100000;
+		game_time.update();
+		if (game_time.get_ticks_elapsed() != 2 || game_time.get_total_ticks() != 2) fail();
+	}
+
+	Console::write_line("   Function: set_max_updates_per_second()");
+	{
+		auto clock = std::make_shared<FakeClock>();
+		GameTime game_time(20, 200, clock);
+		game_time.update();
+		uint64_t start_time = clock->now;
+		for (int i = 0; i < 20; i++)
+			game_time.update();
+
+		// Sleeps most of each frame and spins the rest, keeping the frame cadence
+		uint64_t duration = clock->now - start_time;
+		if (duration < 100000 || duration > 100000 + 1000) fail();
+		if (clock->num_sleeps < 20) fail();
+
+		GameTimeFrameStats stats = game_time.get_frame_time_stats();
+		if (stats.num_frames != 21) fail();
+		if (std::abs(stats.p50_ms - 5.0f) > 0.05f) fail();
+
+		game_time.set_max_updates_per_second(0);
+		start_time = clock->now;
+		for (int i = 0; i < 20; i++)
+			game_time.update();
+		if (clock->now != start_time) fail();
+
+		// One loose check against the real clock: the limit can only make the updates take longer
+		GameTime real_time(20, 200);
+		real_time.update();
+		start_time = System::get_microseconds();
+		for (int i = 0; i < 20; i++)
+			real_time.update();
+		if (System::get_microseconds() - start_time < 90000) fail();
+	}
+
+	Console::write_line("   Function: get_frame_time_stats()");
+	{
+		auto clock = std::make_shared<FakeClock>();
+		GameTime game_time(20, 0, clock);
+		GameTimeFrameStats stats = game_time.get_frame_time_stats();
+		if (stats.num_frames != 0 || game_time.get_frame_time_percentile(0.5f) != 0.0f) fail();
+
+		for (int i = 1; i <= 10; i++)
+		{
+			clock->now += i < 10 ? 1000 : 30000;
+			game_time.update();
+		}
+		stats = game_time.get_frame_time_stats();
+		if (stats.num_frames != 10) fail();
+		if (stats.min_ms != 1.0f || stats.p50_ms != 1.0f || stats.p95_ms != 30.0f || stats.p99_ms != 30.0f || stats.max_ms != 30.0f) fail();
+		if (std::abs(stats.average_ms - 3.9f) > 0.001f) fail();
+		if (game_time.get_frame_time_percentile(1.0f) != stats.max_ms) fail();
+		if (game_time.get_frame_time_percentile(0.50f) != stats.p50_ms) fail();
+		if (game_time.get_frame_time_percentile(0.90f) != 1.0f) fail();
+
+		game_time.reset();
+		if (game_time.get_frame_time_stats().num_frames != 0) fail();
+	}
+}
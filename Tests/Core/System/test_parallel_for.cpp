@@ -0,0 +1,114 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <atomic>
+#include <cmath>
+
+void TestApp::test_parallel_for()
+{
+	Console::write_line(" Header: parallel_for.h");
+	Console::write_line("  Function: parallel_for()");
+
+	Console::write_line("   Every index visited once");
+	{
+		std::vector<int> visited(100000, 0);
+		parallel_for(0, (int)visited.size(), 1000, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+				visited[i]++;
+		});
+		for (auto &count : visited)
+		{
+			if (count != 1) fail();
+		}
+	}
+
+	Console::write_line("   Serial fallback for small ranges");
+	{
+		int calls = 0;
+		parallel_for(10, 20, 100, [&](int begin, int end)
+		{
+			if (begin != 10 || end != 20) fail();
+			calls++;
+		});
+		if (calls != 1) fail();
+	}
+
+	Console::write_line("   Nested calls");
+	{
+		std::atomic_int total(0);
+		parallel_for(0, 16, 1, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+				parallel_for(0, 1000, 10, [&](int inner_begin, int inner_end) { total += inner_end - inner_begin; });
+		});
+		if (total != 16000) fail();
+	}
+
+	Console::write_line("   Exceptions are rethrown");
+	{
+		bool thrown = false;
+		try
+		{
+			parallel_for(0, 1000, 10, [&](int begin, int end) { if (begin <= 500 && 500 < end) throw Exception("chunk failed"); });
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+	}
+
+	Console::write_line("  Function: parallel_reduce()");
+	{
+		int64_t sum = parallel_reduce(0, 1000000, 0, int64_t(0),
+			[](int begin, int end) { int64_t s = 0; for (int i = begin; i < end; i++) s += i; return s; },
+			[](int64_t a, int64_t b) { return a + b; });
+		if (sum != int64_t(999999) * 1000000 / 2) fail();
+	}
+
+	Console::write_line("   Benchmark: 4M sqrt");
+	{
+		const int count = 4000000;
+		uint64_t start_time = System::get_microseconds();
+		double serial = 0.0;
+		for (int i = 0; i < count; i++)
+			serial += std::sqrt((double)i);
+		uint64_t serial_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		double parallel = parallel_reduce(0, count, 0, 0.0,
+			[](int begin, int end) { double s = 0.0; for (int i = begin; i < end; i++) s += std::sqrt((double)i); return s; },
+			[](double a, double b) { return a + b; });
+		uint64_t parallel_time = System::get_microseconds() - start_time;
+
+		if (std::abs(serial - parallel) > serial * 1e-9) fail();
+		Console::write_line("    Serial: %1 ms, parallel_reduce: %2 ms (%3 cores)", (int)(serial_time / 1000), (int)(parallel_time / 1000), System::get_num_cores());
+	}
+}
@@ -0,0 +1,122 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <thread>
+
+namespace
+{
+	std::vector<JsonValue> get_zones(const JsonValue &trace, const std::string &name)
+	{
+		std::vector<JsonValue> zones;
+		for (auto &event : trace.prop("traceEvents").items())
+		{
+			if (event.prop("ph").to_string() == "X" && event.prop("name").to_string() == name)
+				zones.push_back(event);
+		}
+		return zones;
+	}
+}
+
+void TestApp::test_profiler()
+{
+	Console::write_line(" Header: profiler.h");
+	Console::write_line("  Class: Profiler");
+
+	Console::write_line("   Function: start() and get_chrome_trace()");
+	{
+		{
+			ProfileZone zone("not recorded");
+		}
+
+		Profiler::start();
+		if (!Profiler::is_active()) fail();
+		Profiler::set_thread_name("Main");
+		{
+			ProfileZone outer("outer");
+			{
+				ProfileZone inner("inner");
+				System::sleep(2);
+			}
+		}
+
+		std::thread thread([]()
+		{
+			Profiler::set_thread_name("Worker");
+			for (int i = 0; i < 10; i++)
+			{
+				ProfileZone zone("worker");
+			}
+		});
+		thread.join();
+
+		Profiler::stop();
+		{
+			ProfileZone zone("after stop");
+		}
+
+		JsonValue trace = JsonValue::parse(Profiler::get_chrome_trace());
+		if (!get_zones(trace, "not recorded").empty()) fail();
+		if (!get_zones(trace, "after stop").empty()) fail();
+
+		std::vector<JsonValue> outer = get_zones(trace, "outer");
+		std::vector<JsonValue> inner = get_zones(trace, "inner");
+		if (outer.size() != 1 || inner.size() != 1) fail();
+		if (inner[0].prop("ts").to_number() < outer[0].prop("ts").to_number()) fail();
+		if (inner[0].prop("dur").to_number() > outer[0].prop("dur").to_number()) fail();
+		if (inner[0].prop("dur").to_number() < 1000) fail();
+		if (inner[0].prop("tid").to_int() != outer[0].prop("tid").to_int()) fail();
+
+		std::vector<JsonValue> worker = get_zones(trace, "worker");
+		if (worker.size() != 10) fail();
+		if (worker[0].prop("tid").to_int() == outer[0].prop("tid").to_int()) fail();
+
+		bool found_names = false;
+		for (auto &event : trace.prop("traceEvents").items())
+		{
+			if (event.prop("ph").to_string() == "M" && event.prop("tid").to_int() == worker[0].prop("tid").to_int())
+				found_names = event.prop("args").prop("name").to_string() == "Worker";
+		}
+		if (!found_names) fail();
+	}
+
+	Console::write_line("   Function: start(int zones_per_thread)");
+	{
+		Profiler::start(4);
+		for (int i = 0; i < 10; i++)
+		{
+			ProfileZone zone(i < 6 ? "old" : "new");
+		}
+		Profiler::stop();
+
+		JsonValue trace = JsonValue::parse(Profiler::get_chrome_trace());
+		if (!get_zones(trace, "old").empty()) fail();
+		if (get_zones(trace, "new").size() != 4) fail();
+		if (!get_zones(trace, "outer").empty()) fail();
+	}
+}
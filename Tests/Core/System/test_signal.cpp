@@ -0,0 +1,312 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <mutex>
+#include <thread>
+
+namespace
+{
+	// The previous implementation that copied the slot list on every emit, kept for comparison
+	class LegacySlotImpl
+	{
+	public:
+		LegacySlotImpl(const std::function<void(int)> &callback) : callback(callback) { }
+		std::function<void(int)> callback;
+	};
+
+	class LegacySignal
+	{
+	public:
+		void operator()(int value)
+		{
+			std::vector<std::weak_ptr<LegacySlotImpl>> copy = slots;
+			for (std::weak_ptr<LegacySlotImpl> &weak_slot : copy)
+			{
+				std::shared_ptr<LegacySlotImpl> slot = weak_slot.lock();
+				if (slot)
+					slot->callback(value);
+			}
+		}
+
+		std::shared_ptr<LegacySlotImpl> connect(const std::function<void(int)> &func)
+		{
+			auto slot = std::make_shared<LegacySlotImpl>(func);
+			slots.push_back(slot);
+			return slot;
+		}
+
+	private:
+		std::vector<std::weak_ptr<LegacySlotImpl>> slots;
+	};
+
+	template<typename SignalType, typename SlotType>
+	uint64_t benchmark_signal(int num_slots, int num_emits)
+	{
+		int sum = 0;
+		SignalType signal;
+		std::vector<SlotType> slots;
+		for (int i = 0; i < num_slots; i++)
+			slots.push_back(signal.connect([&sum](int value) { sum += value; }));
+
+		uint64_t start_time = System::get_microseconds();
+		for (int i = 0; i < num_emits; i++)
+			signal(1);
+		uint64_t end_time = System::get_microseconds();
+
+		if (sum != num_slots * num_emits) throw Exception("Signal benchmark failed");
+		return end_time - start_time;
+	}
+
+	// The previous RunLoop async work queue, kept for comparison
+	class LockedQueue
+	{
+	public:
+		void post(std::function<void()> func)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work.push_back(std::move(func));
+		}
+
+		int process()
+		{
+			std::vector<std::function<void()>> current_work;
+			std::unique_lock<std::mutex> lock(mutex);
+			current_work.swap(work);
+			lock.unlock();
+
+			for (auto &func : current_work)
+				func();
+			return (int)current_work.size();
+		}
+
+	private:
+		std::mutex mutex;
+		std::vector<std::function<void()>> work;
+	};
+
+	template<typename QueueType>
+	uint64_t benchmark_post(int num_threads, int num_posts)
+	{
+		QueueType queue;
+		int sum = 0;
+
+		uint64_t start_time = System::get_microseconds();
+		std::vector<std::thread> threads;
+		for (int i = 0; i < num_threads; i++)
+		{
+			threads.push_back(std::thread([&]()
+			{
+				for (int j = 0; j < num_posts; j++)
+					queue.post([&sum]() { sum++; });
+			}));
+		}
+		int processed = 0;
+		while (processed < num_threads * num_posts)
+			processed += queue.process();
+		for (auto &thread : threads)
+			thread.join();
+		uint64_t end_time = System::get_microseconds();
+
+		if (sum != num_threads * num_posts) throw Exception("Post benchmark failed");
+		return end_time - start_time;
+	}
+}
+
+void TestApp::test_signal()
+{
+	Console::write_line(" Header: signal.h");
+	Console::write_line("  Class: Signal");
+
+	Console::write_line("   Function: operator()");
+	{
+		Signal<void(int)> signal;
+		std::vector<int> calls;
+		Slot slot1 = signal.connect([&](int value) { calls.push_back(value); });
+		Slot slot2 = signal.connect([&](int value) { calls.push_back(value * 10); });
+		signal(2);
+		if (calls.size() != 2 || calls[0] != 2 || calls[1] != 20) fail();
+
+		slot1 = Slot();
+		signal(3);
+		if (calls.size() != 3 || calls[2] != 30) fail();
+	}
+
+	Console::write_line("   Function: connect() and disconnect during emit");
+	{
+		Signal<void()> signal;
+		int count1 = 0, count2 = 0, count3 = 0;
+		Slot slot1, slot2, slot3;
+		slot1 = signal.connect([&]()
+		{
+			count1++;
+			slot1 = Slot();	// Disconnect self
+			slot2 = Slot();	// Disconnect a slot not yet called
+			slot3 = signal.connect([&]() { count3++; });
+		});
+		slot2 = signal.connect([&]() { count2++; });
+		signal();
+		if (count1 != 1 || count2 != 0 || count3 != 0) fail();
+		signal();
+		if (count1 != 1 || count2 != 0 || count3 != 1) fail();
+	}
+
+	Console::write_line("   Function: many disconnects");
+	{
+		Signal<void()> signal;
+		int count = 0;
+		std::vector<Slot> slots;
+		for (int i = 0; i < 100; i++)
+			slots.push_back(signal.connect([&]() { count++; }));
+		for (int i = 0; i < 100; i += 2)
+			slots[i] = Slot();
+		for (int i = 1; i < 100; i += 4)
+			slots[i] = Slot();
+		signal();
+		if (count != 25) fail();
+		slots.clear();
+		signal();
+		if (count != 25) fail();
+	}
+
+	Console::write_line("   Function: slot outliving signal");
+	{
+		Slot slot;
+		{
+			Signal<void()> signal;
+			slot = signal.connect([]() {});
+		}
+		slot = Slot();
+	}
+
+	Console::write_line("   Function: signal destroyed during emit");
+	{
+		int count = 0;
+		std::unique_ptr<Signal<void()>> signal(new Signal<void()>());
+		Slot slot1 = signal->connect([&]() { count++; signal.reset(); });
+		Slot slot2 = signal->connect([&]() { count++; });
+		(*signal)();
+		if (count != 2 || signal) fail();
+	}
+
+	Console::write_line("  Class: SignalQueue");
+
+	Console::write_line("   Function: connect(const SignalQueue &queue, CallbackType func)");
+	{
+		SignalQueue queue;
+		Signal<void(const std::string &, int)> signal;
+		std::vector<std::string> calls;
+		Slot slot = signal.connect(queue, [&](const std::string &text, int value) { calls.push_back(text + StringHelp::int_to_text(value)); });
+
+		std::string text = "a";
+		signal(text, 1);
+		text = "b";
+		signal(text, 2);
+		if (!calls.empty() || queue.is_empty()) fail();
+		if (queue.process() != 2) fail();
+		if (calls.size() != 2 || calls[0] != "a1" || calls[1] != "b2") fail();
+		if (!queue.is_empty()) fail();
+
+		// Calls still queued for a destroyed slot are dropped
+		signal(text, 3);
+		slot = Slot();
+		queue.process();
+		if (calls.size() != 2) fail();
+
+		SlotContainer slots;
+		slots.connect(signal, queue, [&](const std::string &text, int value) { calls.push_back(text); });
+		signal(text, 4);
+		queue.clear();
+		if (queue.process() != 0 || calls.size() != 2) fail();
+	}
+
+	Console::write_line("   Function: emit from many threads");
+	{
+		SignalQueue queue;
+		Signal<void(int)> signal;
+		int sum = 0;
+		Slot slot = signal.connect(queue, [&](int value) { sum += value; });
+
+		const int num_threads = 4;
+		const int num_posts = 10000;
+		std::vector<std::thread> threads;
+		for (int i = 0; i < num_threads; i++)
+		{
+			threads.push_back(std::thread([&]()
+			{
+				for (int j = 0; j < num_posts; j++)
+					signal(1);
+			}));
+		}
+		int processed = 0;
+		while (processed < num_threads * num_posts)
+			processed += queue.process();
+		for (auto &thread : threads)
+			thread.join();
+		if (sum != num_threads * num_posts) fail();
+	}
+
+	Console::write_line("   Function: SignalQueue(const WorkQueue &work_queue)");
+	{
+		WorkQueue work_queue;
+		SignalQueue queue(work_queue);
+		Signal<void(int)> signal;
+		std::mutex mutex;
+		std::vector<int> values;
+		Slot slot = signal.connect(queue, [&](int value) { std::unique_lock<std::mutex> lock(mutex); values.push_back(value); });
+		for (int i = 0; i < 1000; i++)
+			signal(i);
+
+		for (int i = 0; i < 1000; i++)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (values.size() == 1000)
+				break;
+			lock.unlock();
+			System::sleep(10);
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		if (values.size() != 1000) fail();
+		for (int i = 0; i < 1000; i++)
+		{
+			if (values[i] != i) fail();
+		}
+	}
+
+	Console::write_line("   Benchmark: emit (4 slots, 1000000 emits)");
+	uint64_t time_legacy = benchmark_signal<LegacySignal, std::shared_ptr<LegacySlotImpl>>(4, 1000000);
+	uint64_t time_signal = benchmark_signal<Signal<void(int)>, Slot>(4, 1000000);
+	Console::write_line("    Copying slot list: %1 ms", (int)(time_legacy / 1000));
+	Console::write_line("    Signal: %1 ms", (int)(time_signal / 1000));
+
+	Console::write_line("   Benchmark: post from many threads (4 threads, 250000 posts each)");
+	uint64_t time_locked = benchmark_post<LockedQueue>(4, 250000);
+	uint64_t time_queue = benchmark_post<SignalQueue>(4, 250000);
+	Console::write_line("    Mutex and vector: %1 ms", (int)(time_locked / 1000));
+	Console::write_line("    SignalQueue: %1 ms", (int)(time_queue / 1000));
+}
@@ -0,0 +1,111 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <atomic>
+#include <thread>
+
+void TestApp::test_task()
+{
+	Console::write_line(" Header: task.h");
+	Console::write_line("  Class: Task");
+
+	WorkQueue queue;
+
+	// Stand-in for RunLoop::resume_on_main, which lives in clanDisplay
+	TaskExecutor main_thread([&](const std::function<void()> &work) { queue.work_completed(work); });
+	std::thread::id main_thread_id = std::this_thread::get_id();
+
+	Console::write_line("   Function: task_run() and then()");
+	{
+		std::atomic_bool ran_on_main(false);
+		Task<int> task = task_run(resume_on_worker(queue), []() { return 20; })
+			.then(resume_on_worker(queue), [](int value) { return value + 1; })
+			.then(main_thread, [&](int value) { ran_on_main = std::this_thread::get_id() == main_thread_id; return value * 2; });
+
+		while (!task.is_ready())
+		{
+			queue.process_work_completed();
+			System::sleep(1);
+		}
+		if (task.get() != 42) fail();
+		if (!ran_on_main) fail();
+	}
+
+	Console::write_line("   Function: Task<void> and exception propagation");
+	{
+		std::atomic_int calls(0);
+		Task<void> task = task_run(resume_on_worker(queue), [&]() { calls++; throw Exception("failed"); })
+			.then(resume_on_worker(queue), [&]() { calls++; });
+		task.wait();
+		bool thrown = false;
+		try
+		{
+			task.get();
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+		if (calls != 1) fail();
+	}
+
+	Console::write_line("   Function: then() between void and value tasks");
+	{
+		std::atomic_int result(0);
+		Task<void> task = task_run(resume_on_worker(queue), []() { })
+			.then(resume_on_worker(queue), []() { return std::string("abc"); })
+			.then(resume_on_worker(queue), [](const std::string &value) { return (int)value.size(); })
+			.then(resume_on_worker(queue), [&](int value) { result = value; });
+		task.get();
+		if (result != 3) fail();
+	}
+
+	Console::write_line("   Function: take() with a move-only value");
+	{
+		Task<std::unique_ptr<int>> task = task_run(resume_on_worker(queue), []() { return std::unique_ptr<int>(new int(7)); });
+		if (*task.get() != 7) fail();
+		Task<int> sum = task.then(TaskExecutor(), [](std::unique_ptr<int> &value) { return *value + 1; });
+		std::unique_ptr<int> value = task.take();
+		if (!value || *value != 7 || task.get()) fail();
+		if (sum.get() != 8) fail();
+	}
+
+	Console::write_line("   Function: File::read_bytes_async()");
+	{
+		DataBuffer data = File::read_bytes_async(queue, "test.cpp").get();
+		if (data.get_size() != File::read_bytes("test.cpp").get_size()) fail();
+	}
+
+	while (queue.get_items_queued() > 0)
+	{
+		queue.process_work_completed();
+		System::sleep(1);
+	}
+}
@@ -0,0 +1,192 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <atomic>
+#include <mutex>
+
+void TestApp::test_task_graph()
+{
+	Console::write_line(" Header: task_graph.h");
+	Console::write_line("  Class: TaskGraph");
+
+	for (int mode = 0; mode < 2; mode++)
+	{
+		WorkQueue queue(false, mode == 1);
+
+		Console::write_line("   Function: add() with predecessors (fan-out / fan-in)");
+		{
+			std::mutex mutex;
+			std::vector<std::string> order;
+			auto record = [&](const std::string &name) { std::unique_lock<std::mutex> lock(mutex); order.push_back(name); };
+
+			TaskGraph graph(queue);
+			TaskGraphTask decode = graph.add([&]() { record("decode"); });
+			std::vector<TaskGraphTask> converts;
+			for (int i = 0; i < 8; i++)
+				converts.push_back(graph.add([&]() { record("convert"); }, { decode }));
+			TaskGraphTask upload = graph.add([&]() { record("upload"); }, converts);
+			graph.run();
+			graph.wait();
+
+			if (!upload.is_finished()) fail();
+			if (order.size() != 10) fail();
+			if (order.front() != "decode") fail();
+			if (order.back() != "upload") fail();
+		}
+
+		Console::write_line("   Function: depends_on() and then()");
+		{
+			std::atomic_int value(0);
+			TaskGraph graph(queue);
+			TaskGraphTask b = graph.add([&]() { if (value != 1) value = -1000; else value = 2; });
+			TaskGraphTask a = graph.add([&]() { value = 1; });
+			b.depends_on(a);
+			b.then([&]() { if (value == 2) value = 3; });
+			graph.run();
+			graph.wait();
+			if (value != 3) fail();
+		}
+
+		Console::write_line("   Function: wait() rethrows task exceptions");
+		{
+			std::atomic_int skipped(0);
+			TaskGraph graph(queue);
+			TaskGraphTask a = graph.add([&]() { throw Exception("task failed"); });
+			a.then([&]() { skipped++; });
+			graph.run();
+			bool thrown = false;
+			try
+			{
+				graph.wait();
+			}
+			catch (const Exception &)
+			{
+				thrown = true;
+			}
+			if (!thrown) fail();
+			if (skipped != 0) fail();
+		}
+
+		Console::write_line("   Function: func_finished()");
+		{
+			bool finished = false;
+			TaskGraph graph(queue);
+			graph.func_finished() = [&]() { finished = true; };
+			for (int i = 0; i < 100; i++)
+				graph.add([]() {});
+			graph.run();
+			while (!finished)
+			{
+				queue.process_work_completed();
+				System::sleep(1);
+			}
+			if (!graph.is_finished()) fail();
+		}
+
+		Console::write_line("   Function: add() after the graph finished");
+		{
+			int finished = 0;
+			std::atomic_int ran(0);
+			TaskGraph graph(queue);
+			graph.func_finished() = [&]() { finished++; };
+			graph.add([&]() { ran++; });
+			graph.run();
+			while (finished != 1)
+			{
+				queue.process_work_completed();
+				System::sleep(1);
+			}
+
+			// func_finished is invoked again when the added tasks are done
+			graph.add([&]() { ran++; });
+			graph.wait();
+			while (finished != 2)
+			{
+				queue.process_work_completed();
+				System::sleep(1);
+			}
+			if (ran != 2 || !graph.is_finished()) fail();
+		}
+
+		while (queue.get_items_queued() > 0)
+		{
+			queue.process_work_completed();
+			System::sleep(1);
+		}
+	}
+
+	Console::write_line("   Function: ~TaskGraph() without process_work_completed()");
+	{
+		// The graph is gone once depends_on reports a null task instead of an already released one
+		auto is_graph_destroyed = [](TaskGraphTask &task)
+		{
+			try
+			{
+				task.depends_on(task);
+			}
+			catch (const Exception &e)
+			{
+				return e.message == "TaskGraphTask is null";
+			}
+			return false;
+		};
+
+		TaskGraphTask task;
+		{
+			WorkQueue local_queue;
+			TaskGraph graph(local_queue);
+			task = graph.add([]() {});
+			graph.run();
+			graph.wait();
+		}
+		bool destroyed = false;
+		for (int i = 0; i < 5000 && !destroyed; i++)
+		{
+			destroyed = is_graph_destroyed(task);
+			if (!destroyed)
+				System::sleep(1);
+		}
+		if (!destroyed) fail();
+
+		// Dropping the graph and its queue while tasks are running still runs them to the end
+		std::atomic_int ran(0);
+		std::atomic_bool blocked(true);
+		{
+			WorkQueue local_queue;
+			TaskGraph graph(local_queue);
+			task = graph.add([&]() { while (blocked) System::sleep(1); ran++; });
+			task.then([&]() { ran++; });
+			graph.run();
+		}
+		blocked = false;
+		for (int i = 0; i < 5000 && (ran != 2 || !is_graph_destroyed(task)); i++)
+			System::sleep(1);
+		if (ran != 2 || !is_graph_destroyed(task)) fail();
+	}
+}
@@ -0,0 +1,232 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include <atomic>
+#include <mutex>
+
+static void wait_for_queue(WorkQueue &queue)
+{
+	while (queue.get_items_queued() > 0)
+	{
+		queue.process_work_completed();
+		System::sleep(1);
+	}
+}
+
+static uint64_t benchmark_work_queue(bool work_stealing, int num_items, int num_children)
+{
+	std::atomic_int counter(0);
+	uint64_t start_time = System::get_microseconds();
+	{
+		WorkQueue queue(false, work_stealing);
+		for (int i = 0; i < num_items; i++)
+		{
+			queue.queue([&]()
+			{
+				// Children are queued from the worker thread (owner push in work stealing mode)
+				for (int j = 0; j < num_children; j++)
+					queue.queue([&]() { counter++; });
+				counter++;
+			});
+		}
+		wait_for_queue(queue);
+	}
+	uint64_t end_time = System::get_microseconds();
+
+	if (counter != num_items * (num_children + 1))
+		throw Exception("WorkQueue lost items");
+
+	return end_time - start_time;
+}
+
+void TestApp::test_work_queue()
+{
+	Console::write_line(" Header: work_queue.h");
+	Console::write_line("  Class: WorkQueue");
+
+	Console::write_line("   Function: queue() serial");
+	{
+		WorkQueue queue(true);
+		std::vector<int> order;
+		for (int i = 0; i < 1000; i++)
+			queue.queue([&order, i]() { order.push_back(i); });
+		wait_for_queue(queue);
+		if (order.size() != 1000) fail();
+		for (int i = 0; i < 1000; i++)
+		{
+			if (order[i] != i) fail();
+		}
+	}
+
+	Console::write_line("   Function: work_completed()");
+	for (int mode = 0; mode < 2; mode++)
+	{
+		WorkQueue queue(false, mode == 1);
+		std::atomic_int processed(0);
+		int completed = 0;
+		for (int i = 0; i < 100; i++)
+		{
+			queue.queue([&]()
+			{
+				processed++;
+				queue.work_completed([&]() { completed++; });
+			});
+		}
+		wait_for_queue(queue);
+		if (processed != 100) fail();
+		if (completed != 100) fail();
+	}
+
+	Console::write_line("   Function: queue() with priority");
+	for (int mode = 0; mode < 3; mode++)
+	{
+		WorkQueue queue(mode == 0, mode == 2);
+		std::atomic_bool blocked(true);
+		std::mutex order_mutex;
+		std::vector<std::string> order;
+		auto record = [&](const std::string &name) { std::unique_lock<std::mutex> lock(order_mutex); order.push_back(name); };
+
+		// Keep all workers busy while the prioritised work is queued
+		std::vector<WorkHandle> blockers;
+		for (int i = 0; i < System::get_num_cores(); i++)
+			blockers.push_back(queue.queue([&]() { while (blocked) System::sleep(1); }, WorkPriority::high));
+		System::sleep(50);
+
+		WorkHandle low = queue.queue([&]() { record("low"); }, WorkPriority::low);
+		WorkHandle normal = queue.queue([&]() { record("normal"); });
+		WorkHandle promoted = queue.queue([&]() { record("promoted"); }, WorkPriority::low);
+		WorkHandle cancelled = queue.queue([&]() { record("cancelled"); }, WorkPriority::high);
+		promoted.set_priority(WorkPriority::high);
+		if (promoted.get_priority() != WorkPriority::high) fail();
+		if (!cancelled.cancel()) fail();
+		if (!cancelled.is_cancelled()) fail();
+
+		blocked = false;
+		low.wait();
+		normal.wait();
+		promoted.wait();
+		cancelled.wait();
+		for (auto &blocker : blockers)
+			blocker.wait();
+		if (!low.is_finished() || !normal.is_finished() || !promoted.is_finished()) fail();
+		if (low.cancel()) fail();
+
+		if (mode != 2 || System::get_num_cores() <= 2)
+		{
+			// Ordering is only strict with a single worker
+			if (order.size() != 3) fail();
+			if (order[0] != "promoted" || order[1] != "normal" || order[2] != "low") fail();
+		}
+		else if (order.size() != 3)
+		{
+			fail();
+		}
+		wait_for_queue(queue);
+	}
+
+	Console::write_line("   Function: get_items_queued() after set_priority() and cancel()");
+	for (int mode = 0; mode < 3; mode++)
+	{
+		WorkQueue queue(mode == 0, mode == 2);
+		std::atomic_bool blocked(true);
+		std::vector<WorkHandle> blockers;
+		for (int i = 0; i < System::get_num_cores(); i++)
+			blockers.push_back(queue.queue([&]() { while (blocked) System::sleep(1); }, WorkPriority::high));
+
+		WorkHandle moved = queue.queue([]() { }, WorkPriority::low);
+		WorkHandle cancelled = queue.queue([]() { });
+		int queued = queue.get_items_queued();
+		moved.set_priority(WorkPriority::high);
+		moved.set_priority(WorkPriority::normal);
+		if (queue.get_items_queued() != queued) fail();
+		if (!cancelled.cancel()) fail();
+		if (queue.get_items_queued() != queued - 1) fail();
+
+		blocked = false;
+		wait_for_queue(queue);
+		if (queue.get_items_queued() != 0) fail();
+		if (!moved.is_finished()) fail();
+	}
+
+	Console::write_line("   Function: ~WorkQueue() cancels queued work");
+	{
+		WorkHandle probe;
+		WorkHandle pending;
+		{
+			WorkQueue queue(true);
+			std::atomic_bool ready(false);
+			queue.queue([&]()
+			{
+				while (!ready)
+					System::sleep(1);
+
+				// set_priority() does nothing once the queue is being destroyed
+				WorkPriority priority = WorkPriority::low;
+				while (true)
+				{
+					priority = priority == WorkPriority::low ? WorkPriority::high : WorkPriority::low;
+					probe.set_priority(priority);
+					if (probe.get_priority() != priority)
+						break;
+					System::sleep(1);
+				}
+				System::sleep(20);
+			});
+			pending = queue.queue([]() { });
+			probe = queue.queue([]() { }, WorkPriority::low);
+			ready = true;
+		}
+		if (!pending.is_cancelled() || !probe.is_cancelled()) fail();
+		pending.wait();
+		probe.wait();
+	}
+
+	Console::write_line("   Function: WorkHandle::wait() rethrows exceptions");
+	{
+		WorkQueue queue;
+		WorkHandle handle = queue.queue([]() { throw Exception("work failed"); });
+		bool thrown = false;
+		try
+		{
+			handle.wait();
+		}
+		catch (const Exception &)
+		{
+			thrown = true;
+		}
+		if (!thrown) fail();
+		wait_for_queue(queue);
+	}
+
+	Console::write_line("   Benchmark: contention (20000 items, 4 children each)");
+	uint64_t time_mutex = benchmark_work_queue(false, 20000, 4);
+	uint64_t time_stealing = benchmark_work_queue(true, 20000, 4);
+	Console::write_line("    Single queue: %1 ms", (int)(time_mutex / 1000));
+	Console::write_line("    Work stealing: %1 ms", (int)(time_stealing / 1000));
+}
@@ -41,6 +41,10 @@ int TestApp::main()
 	try
 	{
 		run_test();
+		test_zip_archive();
+		test_zip_crc32();
+		test_zip_seek();
+		test_zip_writer_parallel();
 		console.display_close_message();
 	}
 	catch(Exception error)
@@ -86,3 +90,366 @@ void TestApp::run_test()
 		Console::write_line("Contents: %1", StringHelp::utf8_to_text(str8));
 	}
 }
+
+void TestApp::test_zip_archive()
+{
+	const int num_pack_files = 20000;
+	File file("ZipArchive.zip", File::create_always, File::access_write);
+	ZipWriter zip_writer(file);
+	const char *filenames[] = { "Data/Sub/a.txt", "Data/b.txt", "Data/Empty/", "top.txt" };
+	for (auto filename : filenames)
+	{
+		zip_writer.begin_file(filename, false);
+		zip_writer.write_file_data(filename, strlen(filename));
+		zip_writer.end_file();
+	}
+	for (int i = 0; i < num_pack_files; i++)
+	{
+		zip_writer.begin_file(string_format("Pack/file%1.bin", i), false);
+		zip_writer.end_file();
+	}
+	zip_writer.write_toc();
+	file.close();
+
+	ZipArchive archive("ZipArchive.zip");
+
+	Console::write_line("ZipArchive::open_file");
+	IODevice device = archive.open_file("Data/Sub/a.txt");
+	std::string text(device.get_size(), 0);
+	device.read(&text[0], text.size());
+	if (text != "Data/Sub/a.txt")
+		throw Exception("ZipArchive::open_file returned the wrong entry");
+
+	bool found = true;
+	try
+	{
+		archive.open_file("data/b.txt");
+	}
+	catch (Exception &)
+	{
+		found = false;
+	}
+	if (found)
+		throw Exception("ZipArchive::open_file found a case insensitive match");
+
+	archive.set_case_insensitive(true);
+	archive.open_file("data/B.TXT");
+	archive.set_case_insensitive(false);
+
+	Console::write_line("ZipArchive::get_file_list");
+	std::vector<ZipFileEntry> list = archive.get_file_list("Data");
+	if (list.size() != 3 || list[0].get_archive_filename() != "Sub" || !list[0].is_directory() || list[1].get_archive_filename() != "b.txt" || list[1].is_directory() || list[2].get_archive_filename() != "Empty")
+		throw Exception("ZipArchive::get_file_list returned the wrong entries");
+	list = archive.get_file_list("/");
+	if (list.size() != 3 || list[0].get_archive_filename() != "Data" || list[1].get_archive_filename() != "top.txt" || list[2].get_archive_filename() != "Pack")
+		throw Exception("ZipArchive::get_file_list returned the wrong entries");
+	if (archive.get_file_list("Pack/").size() != num_pack_files || !archive.get_file_list("Missing").empty())
+		throw Exception("ZipArchive::get_file_list returned the wrong entries");
+
+	// Looking up entries by comparing every filename was how open_file used to do it
+	const int num_lookups = 1000;
+	std::vector<ZipFileEntry> all_files = archive.get_file_list();
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_lookups; i++)
+	{
+		std::string filename = string_format("Pack/file%1.bin", num_pack_files - 1 - i);
+		for (auto &entry : all_files)
+		{
+			if (entry.get_archive_filename() == filename)
+				break;
+		}
+	}
+	uint64_t time_linear = System::get_microseconds() - start_time;
+
+	start_time = System::get_microseconds();
+	for (int i = 0; i < num_lookups; i++)
+		archive.open_file(string_format("Pack/file%1.bin", num_pack_files - 1 - i));
+	uint64_t time_index = System::get_microseconds() - start_time;
+
+	Console::write_line("Benchmark: %1 lookups in %2 entries", num_lookups, (int)all_files.size());
+	Console::write_line("  Linear search: %1 us", (int)time_linear);
+	Console::write_line("  ZipArchive::open_file: %1 us", (int)time_index);
+}
+
+namespace
+{
+	// Bit at a time CRC-32, independent of the table and PCLMULQDQ code in the library
+	uint32_t reference_crc32(const char *data, size_t size)
+	{
+		uint32_t crc = 0xffffffff;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc ^= (unsigned char)data[i];
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+		}
+		return ~crc;
+	}
+
+	uint32_t read_le32(const char *data)
+	{
+		const unsigned char *d = reinterpret_cast<const unsigned char *>(data);
+		return d[0] | (d[1] << 8) | (d[2] << 16) | ((uint32_t)d[3] << 24);
+	}
+}
+
+void TestApp::test_zip_crc32()
+{
+	// Sizes around the 8 and 64 byte blocks of the CRC-32 code paths
+	const int sizes[] = { 0, 1, 7, 8, 9, 63, 64, 65, 79, 80, 127, 128, 129, 1000, 4 * 1024 * 1024 + 3 };
+	std::vector<std::string> contents;
+	unsigned int seed = 12345;
+	for (int size : sizes)
+	{
+		std::string data(size, 0);
+		for (auto &c : data)
+		{
+			seed = seed * 1103515245 + 12345;
+			c = (char)(seed >> 16);
+		}
+		contents.push_back(data);
+	}
+	const std::string marker = "CRC-32 corruption marker";
+
+	File file("ZipCrc32.zip", File::create_always, File::access_write);
+	ZipWriter zip_writer(file);
+	uint64_t start_time = System::get_microseconds();
+	for (size_t i = 0; i < contents.size(); i++)
+	{
+		zip_writer.begin_file(string_format("stored%1.bin", (int)i), false);
+		zip_writer.write_file_data(contents[i].data(), contents[i].size());
+		zip_writer.end_file();
+		zip_writer.begin_file(string_format("deflated%1.bin", (int)i), true);
+		zip_writer.write_file_data(contents[i].data(), contents[i].size());
+		zip_writer.end_file();
+	}
+	uint64_t time_write = System::get_microseconds() - start_time;
+	zip_writer.begin_file("corrupt.txt", false);
+	zip_writer.write_file_data(marker.data(), marker.size());
+	zip_writer.end_file();
+	zip_writer.write_toc();
+	file.close();
+
+	// Inputs of 64 bytes or more are folded with PCLMULQDQ when the CPU has it, shorter ones and tails use the tables
+	Console::write_line("ZipWriter CRC-32 (PCLMULQDQ: %1)", System::detect_cpu_extension(System::pclmulqdq));
+	DataBuffer zip_data = File::read_bytes("ZipCrc32.zip");
+	unsigned int header_pos = 0;
+	size_t entries_checked = 0;
+	while (header_pos + 30 <= zip_data.get_size() && read_le32(zip_data.get_data() + header_pos) == 0x04034b50)
+	{
+		const char *header = zip_data.get_data() + header_pos;
+		uint32_t crc32 = read_le32(header + 14);
+		uint32_t compressed_size = read_le32(header + 18);
+		int filename_length = (unsigned char)header[26] | ((unsigned char)header[27] << 8);
+		int extra_length = (unsigned char)header[28] | ((unsigned char)header[29] << 8);
+		std::string filename(header + 30, filename_length);
+		header_pos += 30 + filename_length + extra_length + compressed_size;
+
+		unsigned int index = 0;
+		if (sscanf(filename.c_str(), "stored%u.bin", &index) == 1 || sscanf(filename.c_str(), "deflated%u.bin", &index) == 1)
+		{
+			if (crc32 != reference_crc32(contents[index].data(), contents[index].size()))
+				throw Exception(string_format("ZipWriter wrote the wrong CRC-32 for %1", filename));
+			entries_checked++;
+		}
+	}
+	if (entries_checked != contents.size() * 2)
+		throw Exception("Could not find all entries in the zip file");
+
+	Console::write_line("ZipArchive::open_file CRC-32 check");
+	ZipArchive archive("ZipCrc32.zip");
+	start_time = System::get_microseconds();
+	for (size_t i = 0; i < contents.size(); i++)
+	{
+		for (auto name : { "stored%1.bin", "deflated%1.bin" })
+		{
+			IODevice device = archive.open_file(string_format(name, (int)i));
+			std::string data(device.get_size(), 0);
+			if (!data.empty())
+				device.read(&data[0], data.size());
+			if (data != contents[i])
+				throw Exception("ZipArchive::open_file returned the wrong data");
+		}
+	}
+	uint64_t time_read = System::get_microseconds() - start_time;
+
+	// Flip a bit inside the stored entry and make sure reading it fails
+	std::string zip_text(zip_data.get_data(), zip_data.get_size());
+	size_t marker_pos = zip_text.find(marker);
+	if (marker_pos == std::string::npos)
+		throw Exception("Could not find the stored entry in the zip file");
+	zip_data.get_data()[marker_pos + 5] ^= 1;
+	File::write_bytes("ZipCrc32.zip", zip_data);
+
+	archive = ZipArchive("ZipCrc32.zip");
+	IODevice device = archive.open_file("corrupt.txt");
+	std::string data(device.get_size(), 0);
+	bool detected = false;
+	try
+	{
+		device.read(&data[0], data.size());
+	}
+	catch (Exception &)
+	{
+		detected = true;
+	}
+	if (!detected)
+		throw Exception("ZipArchive::open_file did not detect a CRC-32 mismatch");
+
+	Console::write_line("Benchmark: %1 stored and deflated entries", (int)contents.size());
+	Console::write_line("  ZipWriter: %1 ms", (int)(time_write / 1000));
+	Console::write_line("  ZipArchive::open_file: %1 ms", (int)(time_read / 1000));
+}
+
+namespace
+{
+	unsigned char seek_test_byte(int64_t position)
+	{
+		// Compressible but not repeating within the deflate window
+		return (unsigned char)((position / 7) ^ (position >> 13) ^ (position >> 20));
+	}
+
+	uint64_t benchmark_seeks(ZipArchive &archive, int64_t seek_index_interval, const std::vector<int64_t> &positions)
+	{
+		archive.set_seek_index_interval(seek_index_interval);
+		IODevice device = archive.open_file("seek.bin");
+		uint64_t start_time = System::get_microseconds();
+		for (int64_t position : positions)
+		{
+			unsigned char value = 0;
+			device.seek(position);
+			device.read(&value, 1);
+			if (value != seek_test_byte(position))
+				throw Exception("Seeking in a deflated zip entry returned the wrong data");
+		}
+		return System::get_microseconds() - start_time;
+	}
+}
+
+void TestApp::test_zip_seek()
+{
+	const int64_t file_size = 16 * 1024 * 1024;
+	std::vector<unsigned char> contents(file_size);
+	for (int64_t i = 0; i < file_size; i++)
+		contents[i] = seek_test_byte(i);
+
+	File file("ZipSeek.zip", File::create_always, File::access_write);
+	ZipWriter zip_writer(file);
+	zip_writer.begin_file("seek.bin", true);
+	zip_writer.write_file_data(contents.data(), contents.size());
+	zip_writer.end_file();
+	zip_writer.write_toc();
+	file.close();
+
+	ZipArchive archive("ZipSeek.zip");
+
+	Console::write_line("ZipArchive::set_seek_index_interval");
+	{
+		archive.set_seek_index_interval(100000);
+		IODevice device = archive.open_file("seek.bin");
+
+		// Reads crossing checkpoints, both before and after the checkpoints exist
+		const int64_t positions[] = { 99990, 5000000, 12345, 0, 100000, 4999999, file_size - 20, 1234567, 199999, file_size - 100 };
+		for (int64_t position : positions)
+		{
+			unsigned char buffer[20];
+			device.seek(position);
+			if (device.get_position() != position)
+				throw Exception("Seeking in a deflated zip entry ended at the wrong position");
+			int received = device.read(buffer, 20, false);
+			if (received != (int)min((int64_t)20, file_size - position) || memcmp(buffer, contents.data() + position, received) != 0)
+				throw Exception("Seeking in a deflated zip entry returned the wrong data");
+		}
+
+		// Reading to the end from a checkpoint still verifies the CRC
+		device.seek(3000000);
+		std::vector<unsigned char> tail(file_size - 3000000);
+		device.read(tail.data(), tail.size());
+		if (memcmp(tail.data(), contents.data() + 3000000, tail.size()) != 0)
+			throw Exception("Reading from a checkpoint returned the wrong data");
+	}
+
+	std::vector<int64_t> positions;
+	unsigned int seed = 4321;
+	for (int i = 0; i < 50; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		positions.push_back((int64_t)(seed % (unsigned int)file_size));
+	}
+
+	Console::write_line("Benchmark: %1 random seeks in %2 MB deflated entry", (int)positions.size(), (int)(file_size / (1024 * 1024)));
+	uint64_t time_restart = benchmark_seeks(archive, 0, positions);
+	uint64_t time_index = benchmark_seeks(archive, 1024 * 1024, positions);
+	Console::write_line("  Restart from beginning: %1 ms", (int)(time_restart / 1000));
+	Console::write_line("  1 MB seek index: %1 ms", (int)(time_index / 1000));
+}
+
+namespace
+{
+	uint64_t write_test_zip(const std::string &filename, const std::vector<std::string> &contents, WorkQueue *queue)
+	{
+		uint64_t start_time = System::get_microseconds();
+		File file(filename, File::create_always, File::access_write);
+		std::unique_ptr<ZipWriter> zip_writer(queue ? new ZipWriter(file, false, *queue) : new ZipWriter(file));
+		for (size_t i = 0; i < contents.size(); i++)
+		{
+			zip_writer->begin_file(string_format("file%1.bin", (int)i), i % 4 != 3);
+
+			// Uneven pieces so writes straddle the block boundaries
+			size_t pos = 0;
+			while (pos < contents[i].size())
+			{
+				size_t piece = min(contents[i].size() - pos, (size_t)300000);
+				zip_writer->write_file_data(contents[i].data() + pos, piece);
+				pos += piece;
+			}
+			zip_writer->end_file();
+		}
+		zip_writer->write_toc();
+		file.close();
+		return System::get_microseconds() - start_time;
+	}
+}
+
+void TestApp::test_zip_writer_parallel()
+{
+	// Text-like data that compresses, in sizes around the 1 MB compression block
+	const int sizes[] = { 0, 1, 1000, 1024 * 1024 - 1, 1024 * 1024, 1024 * 1024 + 1, 5 * 1024 * 1024 + 123, 100, 3 * 1024 * 1024, 12345, 8 * 1024 * 1024 };
+	const char *words[] = { "zip ", "clanlib ", "deflate ", "block ", "worker ", "queue ", "crc ", "\n" };
+	std::vector<std::string> contents;
+	unsigned int seed = 777;
+	for (int size : sizes)
+	{
+		std::string data;
+		while ((int)data.size() < size)
+		{
+			seed = seed * 1103515245 + 12345;
+			data += words[(seed >> 16) % 8];
+		}
+		data.resize(size);
+		contents.push_back(data);
+	}
+
+	Console::write_line("ZipWriter(IODevice &output, bool storeFilenamesAsUTF8, const WorkQueue &queue)");
+	WorkQueue queue;
+	uint64_t time_parallel = write_test_zip("ZipParallel.zip", contents, &queue);
+	uint64_t time_serial = write_test_zip("ZipSerial.zip", contents, nullptr);
+
+	ZipArchive archive("ZipParallel.zip");
+	std::vector<ZipFileEntry> list = archive.get_file_list();
+	if (list.size() != contents.size())
+		throw Exception("Parallel ZipWriter wrote the wrong number of entries");
+	for (size_t i = 0; i < contents.size(); i++)
+	{
+		IODevice device = archive.open_file(string_format("file%1.bin", (int)i));
+		std::string data(device.get_size(), 0);
+		if (!data.empty())
+			device.read(&data[0], data.size());
+		if (data != contents[i])
+			throw Exception("Parallel ZipWriter wrote the wrong data");
+	}
+
+	Console::write_line("Benchmark: writing %1 entries", (int)contents.size());
+	Console::write_line("  ZipWriter: %1 ms, %2 bytes", (int)(time_serial / 1000), (int)File::read_bytes("ZipSerial.zip").get_size());
+	Console::write_line("  ZipWriter with WorkQueue: %1 ms, %2 bytes", (int)(time_parallel / 1000), (int)File::read_bytes("ZipParallel.zip").get_size());
+}
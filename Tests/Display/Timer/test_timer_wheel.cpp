@@ -0,0 +1,147 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2016 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "test.h"
+#include "../../../Sources/Display/System/timer_wheel.h"
+#include <vector>
+
+namespace
+{
+	class TestTimer : public TimerWheelNode
+	{
+	public:
+		int times_fired = 0;
+	};
+}
+
+void TestApp::test_timer_wheel()
+{
+	Console::write_line(" Header: timer_wheel.h");
+	Console::write_line("  Class: TimerWheel");
+
+	Console::write_line("   Function: advance() cascading across levels");
+	{
+		TimerWheel wheel;
+		std::vector<TestTimer> timers(2000);
+		unsigned int seed = 12345;
+		const uint64_t ranges[] = { 256, 256 * 64, 1 << 20, 1 << 30 };
+		for (size_t i = 0; i < timers.size(); i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			wheel.add(&timers[i], 1 + (seed >> 4) % ranges[i % 4], 0);
+		}
+		if (wheel.get_size() != (int)timers.size()) fail();
+
+		uint64_t last_tick = 0;
+		bool exact = true;
+		wheel.advance((uint64_t)1 << 30, [&](TimerWheelNode *node)
+		{
+			// The wheel is one past the tick being processed
+			TestTimer *timer = static_cast<TestTimer*>(node);
+			uint64_t tick = wheel.get_current_tick() - 1;
+			if (timer->get_expire_tick() != tick || tick < last_tick || timer->is_linked())
+				exact = false;
+			last_tick = tick;
+			timer->times_fired++;
+		});
+		if (!exact) fail();
+		if (!wheel.is_empty()) fail();
+		for (auto &timer : timers)
+		{
+			if (timer.times_fired != 1) fail();
+		}
+	}
+
+	Console::write_line("   Function: add() after an idle gap");
+	{
+		const uint64_t one_day = 24 * 60 * 60 * 1000;
+		TimerWheel wheel;
+		TestTimer timer;
+		wheel.add(&timer, 10, 0);
+		wheel.advance(10, [&](TimerWheelNode *node) { timer.times_fired++; });
+		if (timer.times_fired != 1) fail();
+
+		// An empty wheel skips the idle time instead of walking it when the next timer is added
+		uint64_t now = one_day + 100;
+		wheel.add(&timer, now + 5, now);
+		if (wheel.get_current_tick() != now) fail();
+		if (wheel.get_next_tick() != now + 5) fail();
+		wheel.advance(now + 4, [&](TimerWheelNode *node) { timer.times_fired++; });
+		if (timer.times_fired != 1) fail();
+		wheel.advance(now + 5, [&](TimerWheelNode *node) { timer.times_fired++; });
+		if (timer.times_fired != 2) fail();
+
+		// A timer added while others are waiting does not move the wheel
+		TestTimer far_timer;
+		wheel.add(&far_timer, 30 * one_day, 2 * one_day);
+		if (wheel.get_current_tick() != 2 * one_day) fail();
+		wheel.add(&timer, 2 * one_day + 1000, 3 * one_day);
+		if (wheel.get_current_tick() != 2 * one_day) fail();
+
+		// Timers already expired fire on the next tick processed
+		wheel.advance(3 * one_day, [&](TimerWheelNode *node) { static_cast<TestTimer*>(node)->times_fired++; });
+		if (timer.times_fired != 3 || far_timer.times_fired != 0) fail();
+		if (wheel.get_current_tick() != 3 * one_day + 1) fail();
+		wheel.advance(30 * one_day, [&](TimerWheelNode *node) { static_cast<TestTimer*>(node)->times_fired++; });
+		if (far_timer.times_fired != 1 || !wheel.is_empty()) fail();
+	}
+
+	Console::write_line("   Function: remove() and add() from the expired callback");
+	{
+		TimerWheel wheel;
+		TestTimer first, second, later, repeating;
+		wheel.add(&first, 100, 0);
+		wheel.add(&second, 100, 0);
+		wheel.add(&later, 5000, 0);
+		wheel.add(&repeating, 100, 0);
+
+		std::vector<uint64_t> repeats;
+		wheel.advance(10000, [&](TimerWheelNode *node)
+		{
+			TestTimer *timer = static_cast<TestTimer*>(node);
+			timer->times_fired++;
+			if (timer == &first || timer == &second)
+			{
+				// Remove the other timer of the same slot and a timer in an upper level
+				wheel.remove(timer == &first ? &second : &first);
+				wheel.remove(&later);
+			}
+			else if (timer == &repeating)
+			{
+				repeats.push_back(wheel.get_current_tick() - 1);
+				if (repeats.size() < 3)
+					wheel.add(&repeating, timer->get_expire_tick() + 300, wheel.get_current_tick() - 1);
+			}
+		});
+
+		if (first.times_fired + second.times_fired != 1) fail();
+		if (later.times_fired != 0 || later.is_linked()) fail();
+		if (repeats.size() != 3 || repeats[0] != 100 || repeats[1] != 400 || repeats[2] != 700) fail();
+		if (!wheel.is_empty()) fail();
+	}
+}